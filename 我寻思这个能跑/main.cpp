@@ -3,13 +3,311 @@
 #include <string>        // 字符串处理
 #include <algorithm>     // 算法库（排序、查找等）
 #include <random>        // 随机数生成
-#include <ctime>         // 时间函数，用于设置随机数种子
 #include <map>           // 映射容器，用于统计和存储键值对
 #include <limits>        // 数值限制，用于输入验证
+#include <cstdint>       // 定长整数类型，用于查找表
+#include <iterator>      // std::begin/std::end
+#include <chrono>        // 计时，用于全量校验的耗时统计
+#include <cmath>         // 数学函数，用于误差估计
+#include <thread>        // 多线程，用于并行计算胜率
+#include <atomic>        // 原子变量，用于线程间分配任务
+#include <functional>    // std::ref
+#include <cctype>        // 字符分类，用于解析牌的文本表示
+#include <cstdio>        // printf，用于性能测试的表格输出
+#include <mutex>         // 互斥锁，用于线程池的任务队列
+#include <condition_variable> // 条件变量，用于线程池的批次同步
+#include <deque>         // 双端队列，用于工作窃取
+#include <memory>        // std::unique_ptr
+#include <cstring>       // memset/memcmp，用于二进制手牌记录
+#include <cstddef>       // offsetof，用于牌桌快照的表头长度
+#include <cassert>       // assert，用于检查定长容器的容量
+#include <new>           // placement new，用于定长容器和分配计数
+#include <cstdlib>       // malloc/free，用于分配计数
+#include <charconv>      // to_chars/from_chars，用于控制台渲染器的数字格式化和命令行参数解析
+#include <sstream>       // 内存中的输入输出流，用于批量运行输入脚本
+#include <filesystem>    // 遍历脚本目录
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>   // AVX2/AVX-512 指令，用于批量评估手牌
+#define HAND_EVALUATOR_X86_SIMD 1
+#else
+#define HAND_EVALUATOR_X86_SIMD 0
+#endif
 #ifdef _WIN32
-#include <windows.h>     // Windows平台API，用于设置控制台编码
+#include <windows.h>     // Windows平台API，用于设置控制台编码和文件映射
+#else
+#include <fcntl.h>       // open
+#include <sys/mman.h>    // mmap，用于映射手牌记录文件
+#include <sys/stat.h>    // fstat
+#include <unistd.h>      // close
+#include <sys/socket.h>  // 套接字，用于牌桌服务器
+#include <netinet/in.h>  // sockaddr_in
+#include <poll.h>        // poll，服务器的 I/O 线程
+#include <csignal>       // SIGINT/SIGTERM，关闭服务器
+#include <cerrno>        // errno
+#endif
+
+// 分配计数开关：编译时加 -DHOLDEM_ALLOC_CHECK=1 才替换全局 operator new，--alloc-check 只在这样的构建中可用。
+// 计数是所有线程共享的一次原子加法，默认关闭，正常运行和多线程计算不承担这份开销
+#ifndef HOLDEM_ALLOC_CHECK
+#define HOLDEM_ALLOC_CHECK 0
+#endif
+
+// 堆内存分配计数 - 替换全局 operator new，统计程序至今的分配次数
+// 用于 --alloc-check 验证完整的一局牌（洗牌、发牌、下注、比牌、分池）不分配内存
+namespace AllocationCounter {
+    const bool ENABLED = HOLDEM_ALLOC_CHECK != 0;       // 本次构建是否统计分配
+    inline std::atomic<std::uint64_t> allocations(0);  // 分配次数
+
+    // 至今为止的分配次数（未启用时总是0）
+    inline std::uint64_t count() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+}
+
+#if HOLDEM_ALLOC_CHECK
+
+// GCC 把 malloc/free 内联进标准库的分配器后会误报 new/delete 不匹配，这里的配对是正确的
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size) {
+    AllocationCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+// 性能计数开关：编译时加 -DHOLDEM_INSTRUMENTATION=0 可以完全去掉计数和计时代码
+#ifndef HOLDEM_INSTRUMENTATION
+#define HOLDEM_INSTRUMENTATION 1
+#endif
+
+// 性能计数 - 统计评估次数、比较次数、洗牌和发牌次数、下注循环次数以及每局各阶段的耗时
+// 每个线程写自己的计数块（普通的加法，不加锁），导出快照时才汇总所有线程（包括已经退出的线程）；
+// 阶段计时使用时间戳计数器（x86 的 rdtsc），导出时再按经过的真实时间换算成纳秒。
+// 读一次时间戳在虚拟机里也要约20纳秒，而两人桌一局只有几百纳秒，所以只对每 TIMING_SAMPLE_INTERVAL 局中的一局计时，
+// 阶段次数仍然精确统计，总耗时按抽样的平均值估算
+namespace Instrumentation {
+    // 计数项
+    enum Counter {
+        EVALUATIONS,            // 牌力评估次数（批量评估按手数计）
+        COMPARISONS,            // compareHands 调用次数
+        SHUFFLES,               // 洗牌次数
+        CARDS_DEALT,            // 牌局中发出的牌数（包括烧牌），每局结束时按牌堆减少的张数一次累加
+        BETTING_ITERATIONS,     // 下注循环的迭代次数
+        HANDS,                  // 开始的牌局数
+        COUNTER_COUNT
+    };
+
+    // 牌局阶段
+    enum Phase { PREFLOP, FLOP, TURN, RIVER, SHOWDOWN, PHASE_COUNT };
+
+    const unsigned TIMING_SAMPLE_INTERVAL = 16;    // 阶段计时的抽样间隔（局数，2的幂）
+
+    // 汇总后的快照
+    struct Snapshot {
+        std::uint64_t counters[COUNTER_COUNT];  // 各计数项
+        std::uint64_t phaseCount[PHASE_COUNT];  // 各阶段进入的次数
+        std::uint64_t phaseSamples[PHASE_COUNT];// 各阶段被计时的次数
+        double phaseMeanNanos[PHASE_COUNT];     // 各阶段的平均耗时（纳秒，由抽样得到）
+        int threads;                            // 有过计数的线程数
+        double seconds;                         // 从第一次计数到导出快照经过的时间（秒）
+
+        // 导出为 JSON
+        std::string toJson() const {
+            static const char* counterNames[COUNTER_COUNT] = {
+                "evaluations", "compare_hands", "shuffles", "cards_dealt", "betting_iterations", "hands"
+            };
+            static const char* phaseNames[PHASE_COUNT] = {"preflop", "flop", "turn", "river", "showdown"};
+            std::string json = "{\n  \"enabled\": ";
+            json += HOLDEM_INSTRUMENTATION ? "true" : "false";
+            json += ",\n  \"threads\": " + std::to_string(threads);
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.6f", seconds);
+            json += ",\n  \"elapsed_seconds\": " + std::string(buffer);
+            json += ",\n  \"counters\": {";
+            for (int i = 0; i < COUNTER_COUNT; i++) {
+                json += std::string(i ? "," : "") + "\n    \"" + counterNames[i] + "\": " + std::to_string(counters[i]);
+            }
+            json += "\n  },\n  \"phases\": {";
+            for (int i = 0; i < PHASE_COUNT; i++) {
+                char mean[32], total[32];
+                std::snprintf(mean, sizeof(mean), "%.1f", phaseMeanNanos[i]);
+                std::snprintf(total, sizeof(total), "%.0f", phaseMeanNanos[i] * phaseCount[i]);
+                json += std::string(i ? "," : "") + "\n    \"" + phaseNames[i] + "\": {\"count\": " + std::to_string(phaseCount[i]) 
+                      + ", \"sampled\": " + std::to_string(phaseSamples[i]) + ", \"mean_ns\": " + mean 
+                      + ", \"total_ns\": " + total + "}";
+            }
+            json += "\n  }\n}\n";
+            return json;
+        }
+    };
+
+    namespace detail {
+        // 每个线程的计数块，只由所属线程写入；原子变量只用于让导出线程安全地读取，写入仍是普通的读-加-写
+        struct Block {
+            std::atomic<std::uint64_t> counters[COUNTER_COUNT];
+            std::atomic<std::uint64_t> phaseCount[PHASE_COUNT];
+            std::atomic<std::uint64_t> phaseSamples[PHASE_COUNT];
+            std::atomic<std::uint64_t> phaseTicks[PHASE_COUNT];
+            unsigned clocks;    // 本线程创建过的阶段计时器数，用于抽样
+            bool attached;      // 是否已登记到 registry
+        };
+
+        inline thread_local Block block;    // 零初始化，访问时不需要线程局部变量的初始化检查
+
+        // 读取时间戳
+        inline std::uint64_t ticks() {
+#if HAND_EVALUATOR_X86_SIMD
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        // 所有线程的计数块，以及已退出线程留下的计数
+        struct Registry {
+            std::mutex mutex;
+            std::vector<const Block*> live;                     // 仍在运行的线程的计数块
+            std::uint64_t retired[COUNTER_COUNT + 3 * PHASE_COUNT] = {};  // 已退出线程的累计
+            int threads = 0;                                    // 登记过的线程数
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            std::uint64_t startTicks = ticks();
+        };
+
+        inline Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        // 把一个计数块累加到数组（顺序：计数项、阶段次数、阶段计时次数、阶段时间戳）
+        inline void accumulate(std::uint64_t* totals, const Block& b) {
+            for (int i = 0; i < COUNTER_COUNT; i++) totals[i] += b.counters[i].load(std::memory_order_relaxed);
+            for (int i = 0; i < PHASE_COUNT; i++) {
+                totals[COUNTER_COUNT + i] += b.phaseCount[i].load(std::memory_order_relaxed);
+                totals[COUNTER_COUNT + PHASE_COUNT + i] += b.phaseSamples[i].load(std::memory_order_relaxed);
+                totals[COUNTER_COUNT + 2 * PHASE_COUNT + i] += b.phaseTicks[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        // 线程登记：第一次计数时登记，线程退出时把计数转入 retired
+        struct Registration {
+            Registration() {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.live.push_back(&block);
+                r.threads++;
+            }
+            ~Registration() {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                accumulate(r.retired, block);
+                r.live.erase(std::find(r.live.begin(), r.live.end(), &block));
+            }
+        };
+
+        inline void attach() {
+            thread_local Registration registration;
+            (void)registration;
+            block.attached = true;
+        }
+
+        inline void add(std::atomic<std::uint64_t>& value, std::uint64_t n) {
+            if (!block.attached) attach();
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    }
+
+    // 计数
+    // 参数:
+    //   counter - 计数项
+    //   n - 增加的数量
+    inline void count(Counter counter, std::uint64_t n = 1) {
+#if HOLDEM_INSTRUMENTATION
+        detail::add(detail::block.counters[counter], n);
+#else
+        (void)counter; (void)n;
+#endif
+    }
+
+    // 阶段计时器 - begin() 结束上一阶段并开始新的阶段，end() 或析构时结束当前阶段
+    // 每个线程每 TIMING_SAMPLE_INTERVAL 个计时器中只有一个读取时间戳，其余只计阶段次数
+    class PhaseClock {
+    private:
+#if HOLDEM_INSTRUMENTATION
+        int phase;              // 当前阶段，-1表示没有在计时
+        bool sampled;           // 本计时器是否读取时间戳
+        std::uint64_t start;    // 当前阶段开始时的时间戳
 #endif
 
+    public:
+#if HOLDEM_INSTRUMENTATION
+        PhaseClock() : phase(-1), sampled((++detail::block.clocks & (TIMING_SAMPLE_INTERVAL - 1)) == 0), start(0) {}
+#endif
+        ~PhaseClock() {
+            end();
+        }
+
+        // 开始新的阶段
+        void begin(Phase next) {
+#if HOLDEM_INSTRUMENTATION
+            detail::add(detail::block.phaseCount[next], 1);
+            if (sampled) {
+                std::uint64_t now = detail::ticks();
+                if (phase >= 0) detail::add(detail::block.phaseTicks[phase], now - start);
+                detail::add(detail::block.phaseSamples[next], 1);
+                start = now;
+            }
+            phase = next;
+#else
+            (void)next;
+#endif
+        }
+
+        // 结束当前阶段
+        void end() {
+#if HOLDEM_INSTRUMENTATION
+            if (sampled && phase >= 0) detail::add(detail::block.phaseTicks[phase], detail::ticks() - start);
+            phase = -1;
+#endif
+        }
+    };
+
+    // 汇总所有线程的计数
+    inline Snapshot snapshot() {
+        Snapshot result = {};
+        detail::Registry& r = detail::registry();
+        std::uint64_t totals[COUNTER_COUNT + 3 * PHASE_COUNT];
+        double ticksPerNano = 1.0;
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            std::copy(std::begin(r.retired), std::end(r.retired), totals);
+            for (const detail::Block* b : r.live) detail::accumulate(totals, *b);
+            result.threads = r.threads;
+            double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - r.startTime).count();
+            result.seconds = nanos * 1e-9;
+            if (nanos > 0) ticksPerNano = std::max(double(detail::ticks() - r.startTicks) / nanos, 1e-9);
+        }
+        for (int i = 0; i < COUNTER_COUNT; i++) result.counters[i] = totals[i];
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            result.phaseCount[i] = totals[COUNTER_COUNT + i];
+            result.phaseSamples[i] = totals[COUNTER_COUNT + PHASE_COUNT + i];
+            std::uint64_t ticks = totals[COUNTER_COUNT + 2 * PHASE_COUNT + i];
+            result.phaseMeanNanos[i] = result.phaseSamples[i] ? ticks / ticksPerNano / result.phaseSamples[i] : 0.0;
+        }
+        return result;
+    }
+}
+
 // 牌型枚举 - 德州扑克中的9种牌型，从低到高排列
 // 每个牌型的数值越大，表示牌型越强
 enum class HandRank { 
@@ -49,36 +347,89 @@ enum class Rank {
     ACE           // A (Ace) - 德州扑克中可以作为1或14使用
 };
 
+// 统计64位整数中为1的二进制位个数
+constexpr int popCount(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    while (x) { x &= x - 1; n++; }
+    return n;
+#endif
+}
+
+// 统计64位整数末尾连续的0的个数（即最低的1所在的位），x 不能为0
+constexpr int countTrailingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
 // 卡牌类 - 表示扑克牌中的一张牌
+// 内部只用一个字节保存牌的编号：编号 = 花色 * 13 + (点数 - 2)，取值0-51
+// 这个编号同时也是该牌在 CardSet 掩码中的位序号
 class Card {
 private:
-    Suit suit;    // 牌的花色
-    Rank rank;    // 牌的点数
+    std::uint8_t index;   // 牌的编号（0-51）
 
 public:
     // 构造函数 - 初始化一张牌的花色和点数
     // 参数:
     //   s - 牌的花色
     //   r - 牌的点数
-    Card(Suit s, Rank r) : suit(s), rank(r) {}
+    Card(Suit s, Rank r) 
+        : index(static_cast<std::uint8_t>(static_cast<int>(s) * 13 + static_cast<int>(r) - 2)) {}
+
+    // 由编号构造一张牌
+    // 参数: i - 牌的编号（0-51）
+    static Card fromIndex(int i) {
+        return Card(static_cast<Suit>(i / 13), static_cast<Rank>(i % 13 + 2));
+    }
+
+    // Getter方法 - 获取牌的编号
+    // 返回值: 牌的编号（0-51）
+    int getIndex() const {
+        return index;
+    }
 
     // Getter方法 - 获取牌的花色
     // 返回值: 牌的花色枚举值
     Suit getSuit() const { 
-        return suit; 
+        return static_cast<Suit>(index / 13); 
     }
     
     // Getter方法 - 获取牌的点数
     // 返回值: 牌的点数枚举值
     Rank getRank() const { 
-        return rank; 
+        return static_cast<Rank>(index % 13 + 2); 
+    }
+
+    // 牌面文字（如"A♥"、"10♠"等），52张牌的文字只在第一次使用时生成一次
+    // 返回值: 预先生成的牌面字符串，引用始终有效
+    const std::string& glyph() const {
+        static const std::vector<std::string> glyphs = [] {
+            std::vector<std::string> all;
+            for (int i = 0; i < 52; i++) all.push_back(fromIndex(i).format());
+            return all;
+        }();
+        return glyphs[index];
     }
 
     // 将牌转换为字符串表示（如"A♥"、"10♠"等）
     // 返回值: 格式化后的牌字符串，包含点数和花色符号
     std::string toString() const {
+        return glyph();
+    }
+
+private:
+    // 拼出牌面文字，只用于生成 glyph() 的表
+    std::string format() const {
         std::string suitStr;  // 花色的字符串表示
-        switch (suit) {
+        switch (getSuit()) {
             case Suit::HEARTS: suitStr = "♥"; break;
             case Suit::DIAMONDS: suitStr = "♦"; break;
             case Suit::CLUBS: suitStr = "♣"; break;
@@ -86,7 +437,7 @@ public:
         }
 
         std::string rankStr;  // 点数的字符串表示
-        switch (rank) {
+        switch (getRank()) {
             case Rank::TWO: rankStr = "2"; break;
             case Rank::THREE: rankStr = "3"; break;
             case Rank::FOUR: rankStr = "4"; break;
@@ -105,50 +456,483 @@ public:
         return rankStr + suitStr;  // 组合点数和花色
     }
 
+public:
+
     // 获取牌的数值表示，用于比较大小
     // 返回值: 牌的点数对应的整数值，用于牌型评估和大小比较
     int getValue() const {
-        return static_cast<int>(rank);  // 将枚举转换为整数，方便数值比较
+        return index % 13 + 2;  // 编号对13取余即为点数-2
+    }
+};
+
+// 解析命令行中的整数参数，整个字符串必须是目标类型范围内的十进制整数
+// 参数:
+//   text - 参数文本
+//   value - 解析结果，失败时不修改
+// 返回值: 解析成功返回true
+template <typename T>
+bool parseNumber(const char* text, T& value) {
+    const char* end = text + std::strlen(text);
+    T parsed = 0;
+    std::from_chars_result result = std::from_chars(text, end, parsed);
+    if (result.ec != std::errc() || result.ptr != end || end == text) return false;
+    value = parsed;
+    return true;
+}
+
+// 解析文本形式的一组牌，例如 "AhKd" 或 "Th 9s 2c"
+// 点数用 2-9、T、J、Q、K、A 表示，花色用 h(红桃)、d(方块)、c(梅花)、s(黑桃) 表示
+// 参数:
+//   text - 待解析的文本，空白字符会被忽略
+//   cards - 解析结果
+// 返回值: 解析成功返回true，有无法识别的字符时返回false
+bool parseCards(const std::string& text, std::vector<Card>& cards) {
+    static const std::string rankChars = "23456789TJQKA";
+    static const std::string suitChars = "hdcs";
+    cards.clear();
+    for (size_t i = 0; i < text.size(); i++) {
+        if (std::isspace(static_cast<unsigned char>(text[i])) || text[i] == ',') continue;
+        if (i + 1 >= text.size()) return false;
+        size_t r = rankChars.find(static_cast<char>(std::toupper(static_cast<unsigned char>(text[i]))));
+        size_t s = suitChars.find(static_cast<char>(std::tolower(static_cast<unsigned char>(text[i + 1]))));
+        if (r == std::string::npos || s == std::string::npos) return false;
+        cards.emplace_back(static_cast<Suit>(s), static_cast<Rank>(r + 2));
+        i++;
+    }
+    return true;
+}
+
+// 牌集合类 - 用一个64位掩码表示任意一组牌
+// 第 i 位表示编号为 i 的牌（见 Card），每种花色占连续的13位
+// 合并两组牌只需一次按位或，统计花色只需一次 popcount
+class CardSet {
+private:
+    std::uint64_t mask;   // 牌的掩码，只使用低52位
+
+public:
+    // 构造函数 - 默认为空集合
+    CardSet() : mask(0) {}
+
+    // 构造函数 - 由掩码直接构造
+    // 参数: m - 牌的掩码
+    explicit CardSet(std::uint64_t m) : mask(m) {}
+
+    // 构造函数 - 由一组牌构造
+    // 参数: cards - 卡牌集合
+    explicit CardSet(const std::vector<Card>& cards) : mask(0) {
+        for (const auto& card : cards) add(card);
+    }
+
+    // 完整的52张牌
+    static CardSet fullDeck() {
+        return CardSet((std::uint64_t(1) << 52) - 1);
+    }
+
+    // Getter方法 - 获取原始掩码
+    std::uint64_t bits() const {
+        return mask;
+    }
+
+    // 添加一张牌
+    void add(const Card& card) {
+        mask |= std::uint64_t(1) << card.getIndex();
+    }
+
+    // 移除一张牌
+    void remove(const Card& card) {
+        mask &= ~(std::uint64_t(1) << card.getIndex());
+    }
+
+    // 是否包含某张牌
+    bool contains(const Card& card) const {
+        return (mask >> card.getIndex()) & 1;
+    }
+
+    // 是否为空集合
+    bool empty() const {
+        return mask == 0;
+    }
+
+    // 牌的数量
+    int size() const {
+        return popCount(mask);
+    }
+
+    // 某一花色的13位点数掩码（第r位代表点数r+2）
+    unsigned suitMask(Suit s) const {
+        return static_cast<unsigned>(mask >> (static_cast<int>(s) * 13)) & 0x1FFFu;
+    }
+
+    // 某一花色的牌数
+    int suitCount(Suit s) const {
+        return popCount(suitMask(s));
+    }
+
+    // 所有出现过的点数的13位掩码（不区分花色）
+    unsigned rankMask() const {
+        return suitMask(Suit::HEARTS) | suitMask(Suit::DIAMONDS) | 
+               suitMask(Suit::CLUBS) | suitMask(Suit::SPADES);
+    }
+
+    // 转换为卡牌列表（按编号从小到大）
+    std::vector<Card> toCards() const {
+        std::vector<Card> cards;
+        for (int i = 0; i < 52; i++) {
+            if ((mask >> i) & 1) cards.push_back(Card::fromIndex(i));
+        }
+        return cards;
+    }
+
+    // 集合运算：并集、交集、差集
+    CardSet operator|(CardSet other) const { return CardSet(mask | other.mask); }
+    CardSet operator&(CardSet other) const { return CardSet(mask & other.mask); }
+    CardSet operator-(CardSet other) const { return CardSet(mask & ~other.mask); }
+    CardSet& operator|=(CardSet other) { mask |= other.mask; return *this; }
+    bool operator==(CardSet other) const { return mask == other.mask; }
+    bool operator!=(CardSet other) const { return mask != other.mask; }
+};
+
+// 随机数引擎 - xoshiro256**，满足标准库 UniformRandomBitGenerator 要求
+// 状态只有32字节，生成一个数只需几次移位和异或，比 std::mt19937 快得多
+// 同一个种子总是产生同样的序列，便于复现牌局
+class Xoshiro256 {
+private:
+    std::uint64_t state[4];   // 引擎内部状态
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    using result_type = std::uint64_t;
+
+    // 构造函数 - 用给定种子初始化
+    // 参数: seed - 64位种子
+    explicit Xoshiro256(std::uint64_t seed = 0) {
+        this->seed(seed);
+    }
+
+    // 重新设置种子（用 splitmix64 把一个64位种子扩展为完整状态）
+    // 参数: value - 64位种子
+    void seed(std::uint64_t value) {
+        for (auto& word : state) {
+            value += 0x9E3779B97F4A7C15ull;
+            std::uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    // 用真随机数生成种子，用于不需要复现的场合
+    static std::uint64_t randomSeed() {
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    }
+
+    // 读出引擎的内部状态（用于牌桌快照）
+    // 参数: out - 写入4个64位状态字
+    void getState(std::uint64_t out[4]) const {
+        std::copy(state, state + 4, out);
+    }
+
+    // 恢复引擎的内部状态，之后生成的随机数与读出状态时的引擎完全相同
+    // 参数: in - 4个64位状态字
+    void setState(const std::uint64_t in[4]) {
+        std::copy(in, in + 4, state);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    // 生成下一个64位随机数
+    result_type operator()() {
+        std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // 跳过 2^128 个数，用于从同一个种子派生出互不重叠的多个序列（例如每个线程一个）
+    void jump() {
+        static const std::uint64_t JUMP[] = {
+            0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+            0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull
+        };
+        std::uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for (std::uint64_t word : JUMP) {
+            for (int b = 0; b < 64; b++) {
+                if (word & (std::uint64_t(1) << b)) {
+                    s0 ^= state[0]; s1 ^= state[1]; s2 ^= state[2]; s3 ^= state[3];
+                }
+                (*this)();
+            }
+        }
+        state[0] = s0; state[1] = s1; state[2] = s2; state[3] = s3;
+    }
+};
+
+// 生成 [0, bound) 范围内均匀分布的随机整数（Lemire 乘法取高位 + 拒绝采样，无偏且几乎不用除法）
+// 与 std::uniform_int_distribution 不同，结果不依赖标准库实现，同一种子在任何编译器上都得到同样的牌序
+// 参数:
+//   rng - 随机数引擎
+//   bound - 上界（不含），必须大于0
+template <typename Rng>
+std::uint32_t randomBelow(Rng& rng, std::uint32_t bound) {
+    std::uint64_t m = static_cast<std::uint64_t>(static_cast<std::uint32_t>(rng())) * bound;
+    std::uint32_t low = static_cast<std::uint32_t>(m);
+    if (low < bound) {
+        std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+        while (low < threshold) {
+            m = static_cast<std::uint64_t>(static_cast<std::uint32_t>(rng())) * bound;
+            low = static_cast<std::uint32_t>(m);
+        }
+    }
+    return static_cast<std::uint32_t>(m >> 32);
+}
+
+// 定长容量的顺序容器 - 最多容纳 N 个元素，元素直接存放在对象内部，不使用堆内存
+// 提供 std::vector 的常用接口，用于每局都要清空、重新填充的牌和座位数据；
+// 元素个数超过 N 属于调用错误（由调用方保证，例如 addPlayer 的人数检查）
+template <typename T, size_t N>
+class FixedVector {
+private:
+    alignas(T) unsigned char storage[N * sizeof(T)];  // 元素的存储空间
+    size_t count;                                     // 当前元素个数
+
+    T* slot(size_t i) { return reinterpret_cast<T*>(storage) + i; }
+    const T* slot(size_t i) const { return reinterpret_cast<const T*>(storage) + i; }
+
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    FixedVector() : count(0) {}
+
+    FixedVector(const FixedVector& other) : count(0) {
+        for (const auto& value : other) push_back(value);
+    }
+
+    FixedVector& operator=(const FixedVector& other) {
+        if (this != &other) {
+            clear();
+            for (const auto& value : other) push_back(value);
+        }
+        return *this;
+    }
+
+    ~FixedVector() {
+        clear();
+    }
+
+    // 容量上限
+    static constexpr size_t capacity() { return N; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T* data() { return slot(0); }
+    const T* data() const { return slot(0); }
+    iterator begin() { return slot(0); }
+    iterator end() { return slot(count); }
+    const_iterator begin() const { return slot(0); }
+    const_iterator end() const { return slot(count); }
+
+    T& operator[](size_t i) { return *slot(i); }
+    const T& operator[](size_t i) const { return *slot(i); }
+    T& front() { return *slot(0); }
+    const T& front() const { return *slot(0); }
+    T& back() { return *slot(count - 1); }
+    const T& back() const { return *slot(count - 1); }
+
+    // 在末尾添加一个元素
+    void push_back(const T& value) {
+        assert(count < N);
+        new (slot(count)) T(value);
+        count++;
+    }
+
+    // 在末尾直接构造一个元素
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        assert(count < N);
+        T* element = new (slot(count)) T(std::forward<Args>(args)...);
+        count++;
+        return *element;
+    }
+
+    // 移除末尾的元素
+    void pop_back() {
+        count--;
+        slot(count)->~T();
+    }
+
+    // 移除一个元素，后面的元素依次前移，保持原有顺序
+    // 返回值: 指向被移除元素之后的元素
+    iterator erase(iterator position) {
+        std::move(position + 1, end(), position);
+        pop_back();
+        return position;
+    }
+
+    // 调整元素个数，新增的元素默认构造
+    void resize(size_t n) {
+        while (count > n) pop_back();
+        while (count < n) emplace_back();
+    }
+
+    // 移除全部元素
+    void clear() {
+        while (count > 0) pop_back();
     }
 };
 
+using HoleCards = FixedVector<Card, 2>;     // 一名玩家的底牌
+using BoardCards = FixedVector<Card, 5>;    // 公共牌
+
 // 牌堆类 - 表示一副完整的扑克牌
 class Deck {
 private:
-    std::vector<Card> cards;  // 存储牌堆中的所有牌
+    FixedVector<Card, 52> cards;  // 存储牌堆中的所有牌
+    CardSet remainingMask;    // 牌堆中剩余牌的掩码
+    bool lazy;                // 剩余的牌是否还没有洗（懒洗牌进行中），为false时剩余的牌序已经确定
+
+    // 从牌堆顶部（vector末尾）取出一张牌；牌堆为空时返回默认牌并输出错误信息
+    Card takeTop() {
+        if (cards.empty()) {  // 检查牌堆是否为空
+            std::cerr << "Error: No more cards in the deck!" << std::endl;
+            // 返回默认牌作为错误处理（实际应用中应该有更好的错误处理机制）
+            return Card(Suit::HEARTS, Rank::TWO);
+        }
+        // 荷官发牌：从牌堆顶部（vector末尾）取牌
+        Card card = cards.back();  // 获取牌堆顶部的牌
+        cards.pop_back();          // 从牌堆中移除该牌
+        remainingMask.remove(card);
+        return card;               // 返回这张牌
+    }
 
 public:
     // 构造函数 - 创建一副标准的52张扑克牌
-    Deck() {
+    Deck() : lazy(false) {
+        reset();
+    }
+
+    // 重置牌堆 - 原地恢复为按花色、点数排列的完整52张牌
+    // 牌直接存放在牌堆对象内部，重复调用不会分配内存
+    void reset() {
+        cards.clear();
         // 创建所有花色和点数的组合（4种花色 × 13种点数 = 52张牌）
         for (int s = 0; s < 4; s++) {  // 遍历4种花色
             for (int r = 2; r <= 14; r++) {  // 遍历点数2到A(14)
-                // 使用emplace_back直接在vector中构造Card对象，避免复制
+                // 使用emplace_back直接在容器中构造Card对象，避免复制
                 cards.emplace_back(static_cast<Suit>(s), static_cast<Rank>(r));
             }
         }
+        remainingMask = CardSet::fullDeck();
+        lazy = false;
+    }
+
+    // 按指定顺序叠牌 - 之后 dealCard() 依次发出 order 中的牌，发完后再发其余的牌（按花色、点数顺序）
+    // 用于回放：按记录的底牌、烧牌和公共牌重建同一副牌
+    // 参数: order - 要最先发出的牌，不能重复
+    void stack(const std::vector<Card>& order) {
+        CardSet used(order);
+        cards.clear();
+        for (int i = 51; i >= 0; i--) {
+            if (!used.contains(Card::fromIndex(i))) cards.push_back(Card::fromIndex(i));
+        }
+        for (auto it = order.rbegin(); it != order.rend(); ++it) cards.push_back(*it);
+        remainingMask = CardSet::fullDeck();
+        lazy = false;
+    }
+
+    // 按给定顺序恢复牌堆（用于牌桌快照）
+    // 参数:
+    //   order - 牌的编号（Card::getIndex），order[0] 在牌堆底部，最后一个是下一张发出的牌；不能重复
+    //   count - 牌数（不超过52）
+    //   unshuffled - 剩余的牌是否还没有洗（见 shuffleLazily）
+    void restore(const std::uint8_t* order, size_t count, bool unshuffled = false) {
+        cards.clear();
+        lazy = unshuffled;
+        remainingMask = CardSet();
+        for (size_t i = 0; i < count; i++) {
+            cards.push_back(Card::fromIndex(order[i]));
+            remainingMask.add(cards.back());
+        }
+    }
+
+    // 洗牌方法 - 使用给定的随机数引擎打乱牌的顺序（Fisher-Yates）
+    // 从牌堆顶部（vector末尾）开始逐张确定，同一引擎状态总是得到同样的牌序
+    // 参数: rng - 随机数引擎，可以是 Xoshiro256 或任意标准库引擎
+    template <typename Rng>
+    void shuffle(Rng& rng) {
+        Instrumentation::count(Instrumentation::SHUFFLES);
+        lazy = false;
+        for (size_t i = cards.size(); i > 1; i--) {
+            size_t j = randomBelow(rng, static_cast<std::uint32_t>(i));
+            std::swap(cards[i - 1], cards[j]);
+        }
+    }
+
+    // 懒洗牌 - 不立即洗牌，而是每次 dealCard(rng) 时才做 Fisher-Yates 的下一步：从剩余的牌中随机选一张换到顶部再发出
+    // 每一步与 shuffle() 的对应步骤相同，所以发出的牌序与用同一引擎状态完整洗牌后发牌的结果一样，
+    // 只是没发出的牌不再消耗随机数；翻牌前就结束的一局只需为发出的底牌付出洗牌的代价。
+    // 牌堆不保存引擎，每次发牌由调用者传入；reset()、stack()、shuffle() 会结束懒洗牌
+    void shuffleLazily() {
+        Instrumentation::count(Instrumentation::SHUFFLES);
+        lazy = true;
+    }
+
+    // 剩余的牌是否还没有洗（懒洗牌进行中）
+    bool isLazy() const {
+        return lazy;
     }
 
-    // 洗牌方法 - 使用随机数生成器打乱牌的顺序
+    // 洗牌方法 - 使用当前线程的默认引擎（首次使用时以真随机数设置种子）
     void shuffle() {
-        std::random_device rd;       // 真随机数生成器
-        std::mt19937 g(rd());        // Mersenne Twister随机数引擎
-        std::shuffle(cards.begin(), cards.end(), g);  // 打乱牌的顺序
+        thread_local Xoshiro256 rng(Xoshiro256::randomSeed());
+        shuffle(rng);
     }
 
-    // 发牌方法 - 从牌堆顶部取出一张牌
+    // 发牌方法 - 从牌堆顶部取出一张牌，懒洗牌时先用 rng 完成洗牌的下一步
+    // 参数: rng - 随机数引擎，懒洗牌时应与此前发这副牌使用的是同一个
     // 返回值: 从牌堆顶部取出的卡牌
     // 注意: 如果牌堆为空，会返回默认牌并输出错误信息
+    template <typename Rng>
+    Card dealCard(Rng& rng) {
+        // 懒洗牌：先从剩余的牌中随机选一张换到顶部（Fisher-Yates 的一步）
+        if (lazy && cards.size() > 1) {
+            size_t j = randomBelow(rng, static_cast<std::uint32_t>(cards.size()));
+            std::swap(cards.back(), cards[j]);
+        }
+        return takeTop();
+    }
+
+    // 发牌方法 - 从牌堆顶部取出一张牌（牌序已经确定时使用）
+    // 返回值: 从牌堆顶部取出的卡牌
+    // 注意: 懒洗牌进行中时没有引擎无法继续洗牌，会输出错误信息并直接发顶部的牌
     Card dealCard() {
-        if (cards.empty()) {  // 检查牌堆是否为空
-            std::cerr << "Error: No more cards in the deck!" << std::endl;
-            // 返回默认牌作为错误处理（实际应用中应该有更好的错误处理机制）
-            return Card(Suit::HEARTS, Rank::TWO);
+        if (lazy && cards.size() > 1) {
+            std::cerr << "Error: Lazily shuffled deck dealt without an engine!" << std::endl;
         }
-        // 荷官发牌：从牌堆顶部（vector末尾）取牌
-        Card card = cards.back();  // 获取牌堆顶部的牌
-        cards.pop_back();          // 从牌堆中移除该牌
-        return card;               // 返回这张牌
+        return takeTop();
+    }
+
+    // 获取牌堆中剩余的牌
+    // 返回值: 剩余牌的掩码，用于胜率计算等需要知道"还有哪些牌没发"的场合
+    CardSet remaining() const {
+        return remainingMask;
+    }
+
+    // 获取牌堆中的第 i 张牌（0为底部，size() - 1 为下一张发出的牌）
+    Card at(size_t i) const {
+        return cards[i];
     }
 
     // 获取牌堆中剩余牌的数量
@@ -156,13 +940,53 @@ public:
     size_t size() const {
         return cards.size();
     }
+
+    // 校验懒洗牌与完整洗牌等价：对每个种子和每个发牌数（0到52张），
+    // 懒洗牌发出的牌和剩余的牌必须与同一引擎状态完整洗牌后的结果一致；
+    // 发到一半时按快照的方式 restore() 到另一副牌上继续发，结果也必须一致；
+    // 发完整副牌后两个引擎消耗的随机数也必须一样多
+    // 参数: seeds - 校验的种子数
+    // 返回值: 0表示校验通过，1表示发现不一致
+    static int certifyLazyShuffle(int seeds = 1000) {
+        long long deals = 0, mismatches = 0;
+        for (int seed = 1; seed <= seeds; seed++) {
+            for (int count = 0; count <= 52; count++) {
+                Xoshiro256 eagerRng(static_cast<std::uint64_t>(seed)), lazyRng(static_cast<std::uint64_t>(seed));
+                Deck eagerDeck, lazyDeck;
+                eagerDeck.shuffle(eagerRng);
+                lazyDeck.shuffleLazily();
+
+                // 先发一半，把牌堆像快照那样原样搬到另一副牌上，再发剩下的
+                std::uint8_t order[52];
+                int half = count / 2;
+                bool same = true;
+                for (int c = 0; c < half; c++) same = same && lazyDeck.dealCard(lazyRng).getIndex() == eagerDeck.dealCard().getIndex();
+                for (size_t i = 0; i < lazyDeck.size(); i++) order[i] = static_cast<std::uint8_t>(lazyDeck.at(i).getIndex());
+                Deck resumed;
+                resumed.restore(order, lazyDeck.size(), lazyDeck.isLazy());
+                for (int c = half; c < count; c++) same = same && resumed.dealCard(lazyRng).getIndex() == eagerDeck.dealCard().getIndex();
+                same = same && resumed.remaining() == eagerDeck.remaining() && resumed.size() == eagerDeck.size();
+                if (count == 52) same = same && lazyRng() == eagerRng();
+
+                deals++;
+                if (!same && mismatches++ < 10) {
+                    std::cout << "不一致: 种子 " << seed << " 发牌数 " << count << "\n";
+                }
+            }
+        }
+        std::cout << "校验的发牌: " << deals << "（" << seeds << " 个种子 × 0-52 张）\n"
+                  << "不一致: " << mismatches << "\n"
+                  << (mismatches == 0 ? "校验通过" : "校验失败") << std::endl;
+        return mismatches == 0 ? 0 : 1;
+    }
 };
 
 // 玩家类 - 表示参与德州扑克游戏的玩家
 class Player {
 private:
     std::string name;          // 玩家名称
-    std::vector<Card> hand;    // 玩家的手牌（两张）
+    HoleCards hand;            // 玩家的手牌（两张）
+    CardSet handMask;          // 手牌的掩码，与公共牌掩码按位或即得全部可用牌
     int chips;                 // 玩家的筹码数量
     int currentBet;            // 当前下注金额
     bool isInGame;             // 是否仍在本局游戏中
@@ -187,9 +1011,15 @@ public:
     
     // Getter方法 - 获取玩家手牌
     // 返回值: 玩家的两张手牌
-    const std::vector<Card>& getHand() const { 
+    const HoleCards& getHand() const { 
         return hand; 
     }
+
+    // Getter方法 - 获取玩家手牌的掩码
+    // 返回值: 玩家两张手牌组成的牌集合
+    CardSet getHandMask() const { 
+        return handMask; 
+    }
     
     // Getter方法 - 获取玩家筹码数量
     // 返回值: 玩家当前拥有的筹码数量
@@ -227,6 +1057,12 @@ public:
         return hasFolded; 
     }
 
+    // 是否已全下（仍在本局中、未弃牌且筹码已全部投入）
+    // 返回值: true表示玩家已全下，本局不能再行动，但仍可参与比牌
+    bool getIsAllIn() const { 
+        return isInGame && !hasFolded && chips == 0; 
+    }
+
     // Setter方法 - 设置玩家是否在游戏中
     // 参数: value - 设置玩家是否在游戏中的布尔值
     void setIsInGame(bool value) { 
@@ -251,10 +1087,17 @@ public:
         hasFolded = value; 
     }
 
+    // Setter方法 - 设置筹码数量（用于回放时恢复开局前的筹码）
+    // 参数: value - 筹码数量
+    void setChips(int value) { 
+        chips = value; 
+    }
+
     // 为玩家添加一张牌（用于发牌）
     // 参数: card - 要添加给玩家的卡牌
     void addCard(const Card& card) {
         hand.push_back(card);
+        handMask.add(card);
     }
 
     // 下注方法 - 减少筹码并增加当前下注金额
@@ -279,6 +1122,7 @@ public:
     // 保留玩家筹码数量，仅重置与当前手牌相关的状态
     void resetHand() {
         hand.clear();         // 清除手牌
+        handMask = CardSet(); // 清除手牌掩码
         currentBet = 0;       // 重置当前下注
         hasFolded = false;    // 重置弃牌状态
         isSmallBlind = false; // 重置小盲注状态
@@ -294,75 +1138,149 @@ public:
 
     // 显示玩家手牌和筹码
     // 将玩家的手牌和剩余筹码输出到控制台
-    void displayHand() const {
-        std::cout << name << "的手牌: ";
+    // 参数: out - 输出流或控制台渲染器（不刷新，由调用者决定何时刷新）
+    template <typename Output>
+    void displayHand(Output& out) const {
+        out << name << "的手牌: ";
         for (const auto& card : hand) {
-            std::cout << card.toString() << " ";
+            out << card.glyph() << " ";
         }
-        std::cout << "(筹码: " << chips << ")" << std::endl;
+        out << "(筹码: " << chips << ")" << '\n';
+    }
+
+    // 显示玩家手牌和筹码到标准输出
+    void displayHand() const {
+        displayHand(std::cout);
+        std::cout.flush();
     }
 
     // 获取玩家手牌和公共牌的组合，用于评估牌型
     // 参数: communityCards - 游戏中的公共牌
     // 返回值: 组合了玩家手牌和公共牌的卡牌集合
     std::vector<Card> getCombinedCards(const std::vector<Card>& communityCards) const {
-        std::vector<Card> combined = hand; // 先复制玩家手牌
+        std::vector<Card> combined(hand.begin(), hand.end()); // 先复制玩家手牌
         // 添加所有公共牌
         combined.insert(combined.end(), communityCards.begin(), communityCards.end());
         return combined; // 返回组合后的所有牌
     }
-};
 
-// 牌型评估命名空间 - 包含评估和比较扑克牌型的辅助函数
-// 提供德州扑克中判断牌型、比较手牌大小的核心逻辑
-namespace HandEvaluator {
-    // 按点数排序（从大到小）
-    // 参数: cards - 需要排序的卡牌集合
-    void sortByRank(std::vector<Card>& cards) {
-        std::sort(cards.begin(), cards.end(), [](const Card& a, const Card& b) {
-            return a.getValue() > b.getValue();  // 按点数降序排列
-        });
+    // 获取玩家手牌和公共牌组合后的掩码，只需一次按位或，不分配内存
+    // 参数: communityMask - 公共牌的掩码
+    // 返回值: 玩家全部可用牌的掩码
+    CardSet getCombinedMask(CardSet communityMask) const {
+        return handMask | communityMask;
     }
+};
 
-    // 检查是否是顺子
-    // 参数: cards - 需要检查的卡牌集合
-    // 返回值: true表示卡牌中存在连续的5个不同点数，即顺子
-    bool isStraight(const std::vector<Card>& cards) {
-        if (cards.size() < 5) return false;  // 至少需要5张牌才能组成顺子
-        
-        std::vector<int> ranks;  // 存储所有牌的点数
-        for (const auto& card : cards) {
-            ranks.push_back(card.getValue());
+const int MAX_PLAYERS = 22;                             // 每桌玩家上限
+using PlayerList = FixedVector<Player, MAX_PLAYERS>;    // 一桌的全部座位
+
+// 牌力键 - 用一个32位整数完整表示一手牌（最好的5张）的强弱
+// 牌型占第20-23位，其后是最多5个4位的关键点数（2-14），按重要性从高到低排列：
+//   四条: 四条点数、踢脚          葫芦: 三条点数、对子点数
+//   三条: 三条点数、两个踢脚      两对: 大对、小对、踢脚
+//   一对: 对子点数、三个踢脚      顺子/同花顺: 顶张点数（A-2-3-4-5为5）
+//   同花/高牌: 五张牌的点数
+// 比较两手牌只需一次整数比较，可以直接放进数组、排序或作为哈希表的键
+class HandStrength {
+private:
+    std::uint32_t key;  // 打包后的牌力键
+
+public:
+    // 构造函数 - 默认为最弱的无效值（0）
+    HandStrength() : key(0) {}
+
+    // 构造函数 - 由打包的键构造
+    explicit HandStrength(std::uint32_t k) : key(k) {}
+
+    // 获取打包的键
+    std::uint32_t raw() const {
+        return key;
+    }
+
+    // 获取牌型
+    HandRank rank() const {
+        return static_cast<HandRank>(key >> 20);
+    }
+
+    // 获取第i个关键点数（0-4），没有的字段为0
+    int kicker(int i) const {
+        return (key >> (16 - 4 * i)) & 0xF;
+    }
+
+    bool operator==(HandStrength other) const { return key == other.key; }
+    bool operator!=(HandStrength other) const { return key != other.key; }
+    bool operator<(HandStrength other) const { return key < other.key; }
+    bool operator>(HandStrength other) const { return key > other.key; }
+    bool operator<=(HandStrength other) const { return key <= other.key; }
+    bool operator>=(HandStrength other) const { return key >= other.key; }
+};
+
+namespace std {
+    // 让 HandStrength 可以直接作为 unordered_map/unordered_set 的键
+    template <>
+    struct hash<HandStrength> {
+        size_t operator()(HandStrength strength) const noexcept {
+            return std::hash<std::uint32_t>()(strength.raw());
         }
-        std::sort(ranks.begin(), ranks.end());  // 按点数升序排列
-        
-        // 去重，避免重复的点数影响判断
-        auto last = std::unique(ranks.begin(), ranks.end());
-        ranks.erase(last, ranks.end());
-        
-        // 检查是否有连续的5个点数
-        for (size_t i = 0; i <= ranks.size() - 5; i++) {
-            bool straight = true;
-            for (size_t j = 0; j < 4; j++) {
-                // 检查相邻点数是否连续
-                if (ranks[i + j + 1] != ranks[i + j] + 1) {
-                    straight = false;
-                    break;
-                }
+    };
+}
+
+// 牌型评估命名空间 - 包含评估和比较扑克牌型的辅助函数
+// 提供德州扑克中判断牌型、比较手牌大小的核心逻辑
+namespace HandEvaluator {
+    // 按点数排序（从大到小）
+    // 参数: cards - 需要排序的卡牌集合
+    void sortByRank(std::vector<Card>& cards) {
+        std::sort(cards.begin(), cards.end(), [](const Card& a, const Card& b) {
+            return a.getValue() > b.getValue();  // 按点数降序排列
+        });
+    }
+
+    namespace detail {
+        // 计算点数掩码中最大顺子的顶张点数（仅用于在编译期生成 STRAIGHT_TOP 表）
+        constexpr int computeStraightTop(unsigned mask) {
+            for (int top = 12; top >= 4; top--) {
+                unsigned need = 0x1Fu << (top - 4);
+                if ((mask & need) == need) return top + 2;
             }
-            if (straight) return true;  // 找到连续的5个点数
+            if ((mask & 0x100Fu) == 0x100Fu) return 5;  // A-2-3-4-5
+            return 0;
         }
-        
-        // 特殊情况：A-2-3-4-5的顺子（最小的顺子，也称为"小顺子"或"轮盘顺子"）
-        if (std::find(ranks.begin(), ranks.end(), 14) != ranks.end() && // A
-            std::find(ranks.begin(), ranks.end(), 2) != ranks.end() &&  // 2
-            std::find(ranks.begin(), ranks.end(), 3) != ranks.end() &&  // 3
-            std::find(ranks.begin(), ranks.end(), 4) != ranks.end() &&  // 4
-            std::find(ranks.begin(), ranks.end(), 5) != ranks.end()) {   // 5
-            return true;
+
+        // 顺子表：13位点数掩码（第r位代表点数r+2） -> 最大顺子的顶张点数，没有顺子为0
+        struct StraightTable {
+            std::uint8_t top[8192];
+        };
+
+        constexpr StraightTable buildStraightTable() {
+            StraightTable t{};
+            for (unsigned mask = 0; mask < 8192; mask++) {
+                t.top[mask] = static_cast<std::uint8_t>(computeStraightTop(mask));
+            }
+            return t;
+        }
+
+        constexpr StraightTable STRAIGHT_TOP = buildStraightTable();
+
+        // 返回点数掩码中最大顺子的顶张点数，没有顺子返回0（A-2-3-4-5返回5）
+        constexpr int straightTop(unsigned mask) {
+            return STRAIGHT_TOP.top[mask & 0x1FFFu];
         }
+    }
+
+    // 检查是否是顺子
+    // 参数: cards - 需要检查的卡牌集合
+    // 返回值: true表示卡牌中存在连续的5个不同点数（包括A-2-3-4-5），即顺子
+    bool isStraight(const std::vector<Card>& cards) {
+        if (cards.size() < 5) return false;  // 至少需要5张牌才能组成顺子
         
-        return false;  // 不是顺子
+        // 把所有点数合并为13位掩码，重复的点数自然去重，再查编译期生成的顺子表
+        unsigned mask = 0;
+        for (const auto& card : cards) {
+            mask |= 1u << (card.getValue() - 2);
+        }
+        return detail::straightTop(mask) != 0;
     }
 
     // 检查是否是同花（至少5张同花色的牌）
@@ -415,11 +1333,11 @@ namespace HandEvaluator {
         return result;
     }
 
-    // 评估手牌，返回牌型和排序后的点数列表
-    // 这是德州扑克中最核心的函数，用于判断玩家手牌的类型和强度
+    // 原始的逐步判断实现（顺子/同花/点数统计）
+    // 已由下面的查表评估器取代，保留下来作为 certify() 全量校验时的对照基准
     // 参数: cards - 需要评估的卡牌集合（通常是玩家手牌+公共牌）
     // 返回值: 包含牌型枚举和排序后点数列表的pair
-    std::pair<HandRank, std::vector<int>> evaluateHand(const std::vector<Card>& cards) {
+    std::pair<HandRank, std::vector<int>> legacyEvaluateHand(const std::vector<Card>& cards) {
         if (cards.size() < 5) {
             return {HandRank::HIGH_CARD, {}};  // 牌不足5张，返回高牌
         }
@@ -477,597 +1395,7300 @@ namespace HandEvaluator {
         return {HandRank::HIGH_CARD, rankCounts};
     }
 
-    // 获取牌型的中文名称
-    // 参数: rank - 牌型枚举值
-    // 返回值: 牌型的中文描述
-    std::string getHandRankName(HandRank rank) {
-        switch (rank) {
-            case HandRank::STRAIGHT_FLUSH: return "同花顺";
-            case HandRank::FOUR_OF_A_KIND: return "四条";
-            case HandRank::FULL_HOUSE: return "葫芦";
-            case HandRank::FLUSH: return "同花";
-            case HandRank::STRAIGHT: return "顺子";
-            case HandRank::THREE_OF_A_KIND: return "三条";
-            case HandRank::TWO_PAIR: return "两对";
-            case HandRank::ONE_PAIR: return "一对";
-            case HandRank::HIGH_CARD: return "高牌";
-            default: return "未知牌型";
-        }
-    }
+    // ===== 查表评估器 =====
+    // 7张牌的牌型只取决于两件事：
+    //   1. 某一花色是否不少于5张：若是，牌型只可能是同花或同花顺（此时不可能凑出四条或葫芦），
+    //      直接用该花色的13位点数掩码查 flush 表
+    //   2. 否则只与13个点数各自出现的次数（0-4）有关：把次数序列看作一个五进制数，
+    //      用完美哈希映射到连续下标后查 noFlush 表
+    // 两张表中存放的都是16位牌力值 HandValue，整手牌的比较只需一次整数比较
 
-    // 比较两个玩家的手牌大小
-    // 返回值：正数表示player1赢，负数表示player2赢，0表示平局
-    int compareHands(const Player& player1, const Player& player2, const std::vector<Card>& communityCards) {
-        // 获取玩家手牌和公共牌的组合
-        auto hand1 = player1.getCombinedCards(communityCards);
-        auto hand2 = player2.getCombinedCards(communityCards);
-        
-        // 评估两个玩家的牌型
-        auto eval1 = evaluateHand(hand1);
-        auto eval2 = evaluateHand(hand2);
-        
-        // 先比较牌型等级（牌型大的赢）
-        if (static_cast<int>(eval1.first) != static_cast<int>(eval2.first)) {
-            return static_cast<int>(eval1.first) - static_cast<int>(eval2.first);
+    // 16位牌力值：1最弱（7-5-4-3-2高牌），7462最强（皇家同花顺），0表示牌数不足5张
+    using HandValue = std::uint16_t;
+
+    namespace detail {
+        // 牌型键，格式与 HandStrength 相同
+        // 参数:
+        //   rank - 牌型
+        //   kickers - 关键点数（2-14）
+        //   n - 关键点数的个数
+        constexpr std::uint32_t makeKey(HandRank rank, const int* kickers, int n) {
+            std::uint32_t key = static_cast<std::uint32_t>(rank) << 20;
+            for (int i = 0; i < n; i++) {
+                key |= static_cast<std::uint32_t>(kickers[i]) << (16 - 4 * i);
+            }
+            return key;
         }
-        
-        // 牌型相同，比较点数（从大到小依次比较）
-        for (size_t i = 0; i < std::min(eval1.second.size(), eval2.second.size()); i++) {
-            if (eval1.second[i] != eval2.second[i]) {
-                return eval1.second[i] - eval2.second[i];
+
+        // 从13位点数掩码中取出最大的n个点数（第r位代表点数r+2）
+        constexpr int topRanks(unsigned mask, int n, int* out) {
+            int found = 0;
+            for (int r = 12; r >= 0 && found < n; r--) {
+                if (mask & (1u << r)) out[found++] = r + 2;
             }
+            return found;
         }
-        
-        return 0; // 平局
-    }
-}
 
-// 德州扑克游戏类 - 管理整个德州扑克游戏的流程和规则
-// 这是游戏的核心类，负责协调整个游戏过程，包括发牌、下注、比牌和筹码分配
-class TexasHoldem {
-private:
-    Deck deck;                  // 游戏使用的牌堆
-    std::vector<Player> players; // 游戏中的玩家列表
-    std::vector<Card> communityCards; // 公共牌（最多5张）
-    int pot;                    // 底池金额，所有玩家下注的筹码总和
-    int currentRound;           // 当前轮次（0:pre-flop, 1:flop, 2:turn, 3:river）
-    int dealerPosition;         // 庄家位置索引
-    int smallBlindAmount;       // 小盲注金额（大盲注的一半）
-    int bigBlindAmount;         // 大盲注金额
-    int currentBetAmount;       // 当前最高下注金额
-    int lastAggressorIndex;     // 最后一个加注的玩家索引
+        // 同花（某一花色不少于5张）时的牌型键
+        // 参数: mask - 该花色的13位点数掩码
+        constexpr std::uint32_t flushKey(unsigned mask) {
+            int top = straightTop(mask);
+            if (top) return makeKey(HandRank::STRAIGHT_FLUSH, &top, 1);
+            int k[5] = {};
+            topRanks(mask, 5, k);
+            return makeKey(HandRank::FLUSH, k, 5);
+        }
 
-    // 获取活跃玩家数量（在游戏中且未弃牌的玩家）
-    // 返回值: 当前仍在参与游戏且未弃牌的玩家数量
-    int getActivePlayerCount() const {
-        int count = 0;
-        for (const auto& player : players) {
-            if (player.getIsInGame() && !player.getHasFolded()) {
-                count++;
+        // 非同花时根据各点数出现次数计算牌型键（从中选出最好的5张）
+        // 参数: counts - 13个点数各自出现的次数，总数为5-7
+        constexpr std::uint32_t rankKey(const int* counts) {
+            unsigned mask = 0;
+            int quad = -1, trip = -1, trip2 = -1, pair1 = -1, pair2 = -1;
+            for (int r = 12; r >= 0; r--) {
+                if (counts[r] > 0) mask |= 1u << r;
+                if (counts[r] == 4) {
+                    quad = r;
+                } else if (counts[r] == 3) {
+                    if (trip < 0) trip = r; else if (trip2 < 0) trip2 = r;
+                } else if (counts[r] == 2) {
+                    if (pair1 < 0) pair1 = r; else if (pair2 < 0) pair2 = r;
+                }
             }
-        }
-        return count;
-    }
 
-    // 获取下一个活跃玩家的索引
-    // 参数: currentIndex - 当前玩家索引
-    // 返回值: 下一个活跃玩家的索引，如果没有活跃玩家则返回-1
-    int getNextActivePlayerIndex(int currentIndex) const {
-        int startIndex = currentIndex;
-        do {
-            currentIndex = (currentIndex + 1) % players.size(); // 循环遍历玩家
-            if (players[currentIndex].getIsInGame() && !players[currentIndex].getHasFolded()) {
-                return currentIndex; // 找到活跃玩家
+            int k[5] = {};
+            if (quad >= 0) {
+                k[0] = quad + 2;
+                topRanks(mask & ~(1u << quad), 1, k + 1);
+                return makeKey(HandRank::FOUR_OF_A_KIND, k, 2);
             }
-        } while (currentIndex != startIndex); // 如果绕了一圈又回到起点，则没有活跃玩家
-        return -1; // 没有活跃玩家
-    }
+            if (trip >= 0 && (trip2 >= 0 || pair1 >= 0)) {
+                k[0] = trip + 2;
+                k[1] = (trip2 > pair1 ? trip2 : pair1) + 2;  // 第二组三条也可以当对子用
+                return makeKey(HandRank::FULL_HOUSE, k, 2);
+            }
+            int top = straightTop(mask);
+            if (top) {
+                return makeKey(HandRank::STRAIGHT, &top, 1);
+            }
+            if (trip >= 0) {
+                k[0] = trip + 2;
+                topRanks(mask & ~(1u << trip), 2, k + 1);
+                return makeKey(HandRank::THREE_OF_A_KIND, k, 3);
+            }
+            if (pair2 >= 0) {
+                k[0] = pair1 + 2;
+                k[1] = pair2 + 2;
+                topRanks(mask & ~(1u << pair1) & ~(1u << pair2), 1, k + 2);  // 第三对也可以作为踢脚
+                return makeKey(HandRank::TWO_PAIR, k, 3);
+            }
+            if (pair1 >= 0) {
+                k[0] = pair1 + 2;
+                topRanks(mask & ~(1u << pair1), 3, k + 1);
+                return makeKey(HandRank::ONE_PAIR, k, 4);
+            }
+            topRanks(mask, 5, k);
+            return makeKey(HandRank::HIGH_CARD, k, 5);
+        }
 
-    // 处理玩家操作（弃牌/跟注/加注）
-    // 这是游戏中玩家交互的核心方法
-    // 参数:
-    //   playerIndex - 当前玩家的索引
-    //   maxBet - 当前最高下注金额的引用，用于更新
-    void handlePlayerAction(int playerIndex, int& maxBet) {
-        Player& player = players[playerIndex];
-        if (!player.getIsInGame() || player.getHasFolded()) return; // 跳过不在游戏或已弃牌的玩家
+        // 13个点数、每个点数出现0-4次、总数恰好为5/6/7的次数序列个数
+        const int NO_FLUSH_SIZE_5 = 6175;
+        const int NO_FLUSH_SIZE_6 = 18395;
+        const int NO_FLUSH_SIZE_7 = 49205;
+        const int DISTINCT_HANDS = 7462;   // 5张牌共有7462种强弱不同的组合
 
-        // 显示玩家信息，让玩家了解当前状态
-        std::cout << "\n" << player.getName() << " 的回合（筹码: " << player.getChips() 
-                  << ", 当前下注: " << player.getCurrentBet() << "）" << std::endl;
-        std::cout << "请选择操作：" << std::endl;
-        std::cout << "1. 弃牌" << std::endl;
-        
-        // 计算需要跟注的金额
-        int toCall = maxBet - player.getCurrentBet();
-        if (toCall > 0) {
-            std::cout << "2. 跟注 (" << toCall << ")" << std::endl;
-        }
-        
-        std::cout << "3. 加注" << std::endl;
-        
-        int choice;
-        // 获取并验证用户输入
-        while (true) {
-            std::cout << "请输入选择 (1-3): ";
-            if (!(std::cin >> choice)) { // 处理非数字输入
-                std::cin.clear();
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                std::cout << "无效输入，请重新输入数字。" << std::endl;
-                continue;
-            }
-            
-            // 验证选择是否有效，避免当toCall<=0时选择跟注
-            if (choice >= 1 && choice <= 3 && !(choice == 2 && toCall <= 0)) {
-                // 清理输入缓冲区中的剩余字符
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                break;
+        // 牌力值 -> 牌型键，按从弱到强的顺序排列（下标0不用）
+        struct KeyTable {
+            std::uint32_t keys[DISTINCT_HANDS + 1];
+        };
+
+        // 追加所有5个不同点数且不成顺子的组合（高牌和同花），按从弱到强的顺序
+        // 点数掩码按数值递增时，降序排列的点数序列也按字典序递增
+        constexpr void appendDistinct(KeyTable& t, int& n, HandRank rank) {
+            for (unsigned mask = 0; mask < 8192; mask++) {
+                if (popCount(mask) == 5 && !straightTop(mask)) {
+                    int k[5] = {};
+                    topRanks(mask, 5, k);
+                    t.keys[++n] = makeKey(rank, k, 5);
+                }
             }
-            
-            std::cout << "无效选择，请重新输入。" << std::endl;
-            // 清理输入缓冲区
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         }
 
-        // 根据玩家选择执行相应操作
-        switch (choice) {
-            case 1: // 弃牌
-                std::cout << player.getName() << " 选择弃牌。" << std::endl;
-                player.setHasFolded(true);
-                break;
-                
-            case 2: // 跟注
-                if (player.placeBet(toCall)) { // 检查筹码是否足够
-                    pot += toCall; // 增加底池
-                    std::cout << player.getName() << " 选择跟注 " << toCall << "。" << std::endl;
-                } else {
-                    std::cout << "筹码不足，自动弃牌。" << std::endl;
-                    player.setHasFolded(true);
+        // 追加一组“主点数 + 若干个不同踢脚”的牌型（一对、三条），按从弱到强的顺序
+        // 参数: kickers - 踢脚个数
+        constexpr void appendWithKickers(KeyTable& t, int& n, HandRank rank, int kickers) {
+            for (int primary = 0; primary < 13; primary++) {
+                for (unsigned mask = 0; mask < 8192; mask++) {
+                    if (popCount(mask) != kickers || (mask & (1u << primary))) continue;
+                    int k[4] = {primary + 2};
+                    topRanks(mask, kickers, k + 1);
+                    t.keys[++n] = makeKey(rank, k, kickers + 1);
                 }
-                break;
-                
-            case 3: // 加注
-                int raiseAmount;
-                // 计算最小加注金额（需要跟注的金额 + 大盲注）
-                int minRaise = (toCall > 0 ? toCall : 0) + bigBlindAmount;
-                
-                // 获取并验证加注金额
-                while (true) {
-                    std::cout << "请输入加注金额（最小 " << minRaise << "，筹码: " << player.getChips() << "）: ";
-                    if (!(std::cin >> raiseAmount)) {
-                        std::cin.clear();
-                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                        std::cout << "无效的加注金额，请重新输入。" << std::endl;
-                        continue;
-                    }
-                    
-                    if (raiseAmount < minRaise || raiseAmount > player.getChips()) {
-                        std::cout << "无效的加注金额，请重新输入。" << std::endl;
-                        // 清理输入缓冲区
-                        std::cin.clear();
-                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                        continue;
+            }
+        }
+
+        // 直接按从弱到强的顺序生成全部7462个牌型键，免去排序
+        constexpr KeyTable buildKeyTable() {
+            KeyTable t{};
+            int n = 0;
+            appendDistinct(t, n, HandRank::HIGH_CARD);
+            appendWithKickers(t, n, HandRank::ONE_PAIR, 3);
+            for (int high = 1; high < 13; high++) {
+                for (int low = 0; low < high; low++) {
+                    for (int kicker = 0; kicker < 13; kicker++) {
+                        if (kicker == high || kicker == low) continue;
+                        int k[3] = {high + 2, low + 2, kicker + 2};
+                        t.keys[++n] = makeKey(HandRank::TWO_PAIR, k, 3);
                     }
-                    
-                    // 清理输入缓冲区中的剩余字符
-                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                    break;
                 }
-                
-                // 执行加注
-                if (player.placeBet(toCall + raiseAmount)) { // 检查筹码是否足够
-                    pot += (toCall + raiseAmount); // 增加底池
-                    maxBet = player.getCurrentBet(); // 更新最高下注金额
-                    lastAggressorIndex = playerIndex; // 更新最后加注者
-                    std::cout << player.getName() << " 选择加注到 " << player.getCurrentBet() << "。" << std::endl;
-                } else {
-                    std::cout << "筹码不足，自动弃牌。" << std::endl;
-                    player.setHasFolded(true);
+            }
+            appendWithKickers(t, n, HandRank::THREE_OF_A_KIND, 2);
+            for (int top = 5; top <= 14; top++) t.keys[++n] = makeKey(HandRank::STRAIGHT, &top, 1);
+            appendDistinct(t, n, HandRank::FLUSH);
+            for (HandRank rank : {HandRank::FULL_HOUSE, HandRank::FOUR_OF_A_KIND}) {
+                for (int primary = 0; primary < 13; primary++) {
+                    for (int side = 0; side < 13; side++) {
+                        if (side == primary) continue;
+                        int k[2] = {primary + 2, side + 2};
+                        t.keys[++n] = makeKey(rank, k, 2);
+                    }
                 }
-                break;
+            }
+            for (int top = 5; top <= 14; top++) t.keys[++n] = makeKey(HandRank::STRAIGHT_FLUSH, &top, 1);
+            return t;
         }
-    }
 
-    // 进行一轮下注
-    // 这是德州扑克游戏的核心环节，处理玩家之间的下注交互
-    // 实现了标准的德州扑克下注规则，包括跟注、加注和弃牌
-    // 参数:
-    //   startPlayerIndex - 本轮下注开始的玩家索引
-    void bettingRound(int startPlayerIndex) {
-        // 如果只有一个或没有活跃玩家，无需下注
-        if (getActivePlayerCount() <= 1) return;
-        
-        // 重置当前最高下注金额和最后加注者索引
-        currentBetAmount = 0;
-        lastAggressorIndex = -1;
-        
-        // 重置当前下注金额，考虑盲注或之前下注
-        for (auto& player : players) {
-            if (player.getIsInGame() && !player.getHasFolded()) {
-                currentBetAmount = std::max(currentBetAmount, player.getCurrentBet());
+        constexpr KeyTable KEYS = buildKeyTable();
+        static_assert(KEYS.keys[DISTINCT_HANDS] == (static_cast<std::uint32_t>(HandRank::STRAIGHT_FLUSH) << 20 | 14u << 16),
+                      "hand classes must end with the royal flush");
+
+        // 牌型键 -> 牌力值（在 KEYS 中二分查找）
+        constexpr HandValue valueOf(std::uint32_t key) {
+            int low = 1, high = DISTINCT_HANDS;
+            while (low < high) {
+                int mid = (low + high) / 2;
+                if (KEYS.keys[mid] < key) low = mid + 1; else high = mid;
             }
+            return static_cast<HandValue>(low);
         }
-        
-        // 设置当前玩家和第一个玩家索引
-        int currentPlayerIndex = startPlayerIndex;
-        int firstPlayerIndex = startPlayerIndex;
-        bool allCalled = false;
-        
-        // 下注主循环，直到所有玩家都完成了跟注或只剩一个玩家
-        while (!allCalled) {
-            // 处理当前玩家的操作
-            handlePlayerAction(currentPlayerIndex, currentBetAmount);
-            
-            // 检查是否只有一个玩家剩余
-            if (getActivePlayerCount() <= 1) break;
-            
-            // 检查是否所有玩家都已跟注到当前最高金额
-            allCalled = true;
-            for (const auto& player : players) {
-                if (player.getIsInGame() && !player.getHasFolded() && player.getCurrentBet() < currentBetAmount) {
-                    allCalled = false;
-                    break;
+
+        // 完美哈希累加项：[点数][该点数的次数][剩余牌数]
+        // 同样总数的所有次数序列按字典序（低点数在前）编号为 0..N-1
+        struct HashTable {
+            std::uint32_t step[13][5][8];
+        };
+
+        constexpr HashTable buildHashTable() {
+            // ways[n][s]：长度为n、每项0-4、总和为s的序列个数
+            int ways[14][8] = {};
+            ways[0][0] = 1;
+            for (int n = 1; n <= 13; n++) {
+                for (int s = 0; s < 8; s++) {
+                    for (int v = 0; v <= 4 && v <= s; v++) ways[n][s] += ways[n - 1][s - v];
                 }
             }
-            
-            if (allCalled) break;
-            
-            // 获取下一个活跃玩家
-            currentPlayerIndex = getNextActivePlayerIndex(currentPlayerIndex);
-            
-            // 如果回到第一个玩家且有玩家加注过，则从最后加注者的下一位继续下注轮
-            // 这是德州扑克规则中的必要环节，确保每位玩家都有机会对新的加注做出反应
-            if (currentPlayerIndex == firstPlayerIndex && lastAggressorIndex != -1) {
-                firstPlayerIndex = getNextActivePlayerIndex(lastAggressorIndex);
-                currentPlayerIndex = firstPlayerIndex;
+            HashTable t{};
+            for (int r = 0; r < 13; r++) {
+                for (int c = 0; c < 5; c++) {
+                    for (int k = 0; k < 8; k++) {
+                        std::uint32_t sum = 0;
+                        for (int v = 0; v < c && v <= k; v++) sum += ways[12 - r][k - v];
+                        t.step[r][c][k] = sum;
+                    }
+                }
             }
+            return t;
         }
-    }
 
-    // 进行比牌并分配筹码
-    // 在游戏的最后阶段，所有未弃牌的玩家展示手牌进行比较
-    // 实现了牌型评估、比较和筹码分配的完整逻辑
-    void showdown() {
-        // 获取所有活跃玩家（未弃牌）
-        std::vector<int> remainingPlayers;
-        for (size_t i = 0; i < players.size(); i++) {
-            if (players[i].getIsInGame() && !players[i].getHasFolded()) {
-                remainingPlayers.push_back(i);
+        constexpr HashTable HASH = buildHashTable();
+
+        // 同花表：同花色的13位点数掩码 -> 牌力值（不足5张为0）
+        struct FlushTable {
+            HandValue values[8192];
+            HandValue padding;      // 批量评估用32位收集指令读取16位表项，末尾多留2字节
+        };
+
+        constexpr FlushTable buildFlushTable() {
+            FlushTable t{};
+            for (unsigned mask = 0; mask < 8192; mask++) {
+                t.values[mask] = popCount(mask) >= 5 ? valueOf(flushKey(mask)) : 0;
             }
+            return t;
         }
-        
-        // 如果没有剩余玩家，输出提示
-        if (remainingPlayers.empty()) {
-            std::cout << "没有剩余玩家进行比牌。" << std::endl;
-            return;
-        }
-        
-        // 如果只有一个玩家剩余，直接赢取底池（没有对手）
-        if (remainingPlayers.size() == 1) {
-            // 只有一个玩家剩余，直接赢取底池
-            int winnerIndex = remainingPlayers[0];
-            players[winnerIndex].winChips(pot);
-            std::cout << "\n" << players[winnerIndex].getName() << " 赢得了底池 " << pot << "！" << std::endl;
-            return;
+
+        constexpr FlushTable FLUSH = buildFlushTable();
+
+        // 非同花表：次数序列的完美哈希 -> 牌力值
+        template <int N>
+        struct NoFlushTable {
+            HandValue values[N];
+        };
+
+        // 枚举所有总数为 remaining 的次数序列（递归到第 pos 个点数），index 为已累加的哈希值
+        constexpr void fillUnique5(NoFlushTable<NO_FLUSH_SIZE_5>& t, int* counts, int pos, int remaining, int index) {
+            if (pos == 13 || remaining == 0) {
+                t.values[index] = valueOf(rankKey(counts));
+                return;
+            }
+            for (int c = 0; c <= 4 && c <= remaining; c++) {
+                counts[pos] = c;
+                fillUnique5(t, counts, pos + 1, remaining - c, index + HASH.step[pos][c][remaining]);
+            }
+            counts[pos] = 0;
         }
-        
-        // 显示所有剩余玩家的手牌和牌型
-        std::cout << "\n===== 比牌阶段 =====" << std::endl;
-        for (int playerIndex : remainingPlayers) {
-            players[playerIndex].displayHand();
-            auto combinedCards = players[playerIndex].getCombinedCards(communityCards);
-            auto eval = HandEvaluator::evaluateHand(combinedCards);
-            std::cout << "牌型: " << HandEvaluator::getHandRankName(eval.first) << std::endl;
+
+        constexpr NoFlushTable<NO_FLUSH_SIZE_5> buildUnique5() {
+            NoFlushTable<NO_FLUSH_SIZE_5> t{};
+            int counts[13] = {};
+            fillUnique5(t, counts, 0, 5, 0);
+            return t;
         }
-        
-        // 找出获胜者，使用冒泡排序的思路比较每个玩家的手牌
-        int winnerIndex = remainingPlayers[0];
-        bool tie = false;
-        std::vector<int> winners = {winnerIndex};
-        
-        for (size_t i = 1; i < remainingPlayers.size(); i++) {
-            // 比较当前玩家与已知最佳玩家的手牌
-            int compareResult = HandEvaluator::compareHands(
-                players[winnerIndex], 
-                players[remainingPlayers[i]], 
-                communityCards
-            );
-            
-            if (compareResult < 0) {
-                // 新的获胜者
-                winnerIndex = remainingPlayers[i];
-                winners = {winnerIndex};
-                tie = false;
-            } else if (compareResult == 0) {
-                // 平局，添加到获胜者列表
-                winners.push_back(remainingPlayers[i]);
-                tie = true;
+
+        // 5张非同花牌的表在编译期生成
+        constexpr NoFlushTable<NO_FLUSH_SIZE_5> UNIQUE_5 = buildUnique5();
+
+        // 由 total-1 张的表推出 total 张的表：total 张牌的牌力等于去掉其中任意一张后的最好牌力
+        // 6张和7张的表共约6.8万项，超出编译器默认的常量求值步数限制，因此首次使用时由 UNIQUE_5 推出
+        template <int N, int M>
+        void extendNoFlush(NoFlushTable<N>& t, const NoFlushTable<M>& prev, int* counts, int pos, int remaining, int total) {
+            if (pos < 13 && remaining > 0) {
+                for (int c = 0; c <= 4 && c <= remaining; c++) {
+                    counts[pos] = c;
+                    extendNoFlush(t, prev, counts, pos + 1, remaining - c, total);
+                }
+                counts[pos] = 0;
+                return;
             }
-        }
-        
-        // 分配底池，处理单人和多人获胜的情况
-        if (tie) {
-            // 平局情况下，平分底池
-            int splitPot = pot / winners.size();
-            std::cout << "\n平局！底池将平分给以下玩家：" << std::endl;
-            for (int winIdx : winners) {
-                players[winIdx].winChips(splitPot);
-                std::cout << "- " << players[winIdx].getName() << " 获得 " << splitPot << std::endl;
-            }
-            // 处理余数（可能由于除法取整），将余数分配给第一个玩家
-            int remainder = pot % winners.size();
-            if (remainder > 0) {
-                std::cout << "余数 " << remainder << " 归第一个玩家。" << std::endl;
-                players[winners[0]].winChips(remainder);
+            // rem[r]：第r个点数之前剩余的牌数；suffix[r]：从第r个点数起的哈希累加值
+            int rem[14] = {total};
+            for (int r = 0; r < 13; r++) rem[r + 1] = rem[r] - counts[r];
+            std::uint32_t suffix[14] = {};
+            for (int r = 12; r >= 0; r--) suffix[r] = suffix[r + 1] + HASH.step[r][counts[r]][rem[r]];
+            // 去掉点数r的一张后，r之前的各项按少一张牌累加，r之后的各项不变
+            std::uint32_t prefix = 0;
+            HandValue best = 0;
+            for (int r = 0; r < 13 && rem[r] > 0; r++) {
+                if (counts[r] > 0) {
+                    best = std::max(best, prev.values[prefix + HASH.step[r][counts[r] - 1][rem[r] - 1] + suffix[r + 1]]);
+                }
+                prefix += HASH.step[r][counts[r]][rem[r] - 1];
             }
-        } else {
-            // 单人获胜情况
-            players[winnerIndex].winChips(pot);
-            std::cout << "\n" << players[winnerIndex].getName() << " 赢得了底池 " << pot << "！" << std::endl;
+            t.values[suffix[0]] = best;
         }
-    }
 
-public:
-    // 构造函数 - 初始化德州扑克游戏实例
-    // 设置游戏的初始状态，包括底池、轮次、庄家位置和盲注金额
-    // 同时设置随机数种子以确保随机性
-    TexasHoldem() : pot(0), currentRound(0), dealerPosition(0), 
-                   smallBlindAmount(50), bigBlindAmount(100), 
-                   currentBetAmount(0), lastAggressorIndex(-1) {
-        // 设置随机数种子
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
+        // 6张和7张非同花牌的表，前面附一份5张的表，三张表首尾相连供批量评估按偏移统一查找
+        struct ExtendedTables {
+            NoFlushTable<NO_FLUSH_SIZE_5> five;
+            NoFlushTable<NO_FLUSH_SIZE_6> six;
+            NoFlushTable<NO_FLUSH_SIZE_7> seven;
+            HandValue padding;      // 批量评估用32位收集指令读取16位表项，末尾多留2字节
+        };
+
+        static_assert(sizeof(NoFlushTable<NO_FLUSH_SIZE_5>) == NO_FLUSH_SIZE_5 * sizeof(HandValue) &&
+                      sizeof(NoFlushTable<NO_FLUSH_SIZE_6>) == NO_FLUSH_SIZE_6 * sizeof(HandValue),
+                      "sub-tables must be contiguous");
+
+        // 获取6张和7张的表（首次调用时生成，之后只读）
+        inline const ExtendedTables& extendedTables() {
+            static const std::unique_ptr<ExtendedTables> tables = [] {
+                std::unique_ptr<ExtendedTables> t(new ExtendedTables());
+                t->five = UNIQUE_5;
+                t->padding = 0;
+                int counts[13] = {};
+                extendNoFlush(t->six, UNIQUE_5, counts, 0, 6, 6);
+                extendNoFlush(t->seven, t->six, counts, 0, 7, 7);
+                return t;
+            }();
+            return *tables;
+        }
+
+        // 查非同花表
+        // 参数:
+        //   total - 总牌数（5-7）
+        //   index - 次数序列的完美哈希
+        inline HandValue noFlushValue(int total, int index) {
+            if (total == 5) return UNIQUE_5.values[index];
+            const ExtendedTables& t = extendedTables();
+            return total == 6 ? t.six.values[index] : t.seven.values[index];
+        }
+    }
+
+    // 查表评估手牌，返回16位牌力值
+    // 参数: cards - 需要评估的牌集合（5-7张）
+    // 返回值: 牌力值（越大越强），牌数不在5-7张之间时返回0
+    HandValue evaluateValue(CardSet cards) {
+        Instrumentation::count(Instrumentation::EVALUATIONS);
+        int total = cards.size();
+        if (total < 5 || total > 7) return 0;
+
+        unsigned suits[4];
+        for (int s = 0; s < 4; s++) {
+            suits[s] = cards.suitMask(static_cast<Suit>(s));
+            if (popCount(suits[s]) >= 5) return detail::FLUSH.values[suits[s]];
+        }
+
+        // 逐个点数累加完美哈希，某点数的张数就是它在四个花色掩码中出现的次数
+        int index = 0;
+        int remaining = total;
+        for (int r = 0; r < 13 && remaining > 0; r++) {
+            int count = ((suits[0] >> r) & 1) + ((suits[1] >> r) & 1) + 
+                        ((suits[2] >> r) & 1) + ((suits[3] >> r) & 1);
+            index += detail::HASH.step[r][count][remaining];
+            remaining -= count;
+        }
+        return detail::noFlushValue(total, index);
+    }
+
+    // 查表评估手牌，返回16位牌力值
+    // 参数: cards - 需要评估的卡牌集合（5-7张）
+    // 返回值: 牌力值（越大越强），牌数不在5-7张之间时返回0
+    HandValue evaluateValue(const std::vector<Card>& cards) {
+        return evaluateValue(CardSet(cards));
+    }
+
+    // 把16位牌力值转换为牌力键
+    HandStrength toStrength(HandValue value) {
+        return HandStrength(detail::KEYS.keys[value]);
+    }
+
+    // 增量评估状态 - 一名玩家目前可用的牌（底牌和已发出的公共牌）的点数计数和花色计数
+    // 每发一张牌只更新两个计数；查询牌力时直接由计数查表，同一条街上重复查询只计算一次
+    class IncrementalHand {
+    private:
+        CardSet cards;                  // 已加入的牌
+        std::uint8_t rankCounts[13];    // 每个点数的张数（下标0为2）
+        std::uint8_t suitCounts[4];     // 每个花色的张数
+        int total;                      // 总张数
+        mutable HandValue cached;       // 最近一次计算的牌力值
+        mutable bool dirty;             // 加入新牌后 cached 需要重新计算
+
+        HandValue compute() const {
+            Instrumentation::count(Instrumentation::EVALUATIONS);
+            if (total < 5 || total > 7) return 0;
+            for (int s = 0; s < 4; s++) {
+                if (suitCounts[s] >= 5) return detail::FLUSH.values[cards.suitMask(static_cast<Suit>(s))];
+            }
+            int index = 0;
+            int remaining = total;
+            for (int r = 0; r < 13 && remaining > 0; r++) {
+                index += detail::HASH.step[r][rankCounts[r]][remaining];
+                remaining -= rankCounts[r];
+            }
+            return detail::noFlushValue(total, index);
+        }
+
+    public:
+        IncrementalHand() {
+            clear();
+        }
+
+        // 清空，准备新的一局
+        void clear() {
+            cards = CardSet();
+            std::fill(std::begin(rankCounts), std::end(rankCounts), 0);
+            std::fill(std::begin(suitCounts), std::end(suitCounts), 0);
+            total = 0;
+            cached = 0;
+            dirty = false;
+        }
+
+        // 加入一张牌（底牌或新发出的公共牌）
+        void add(const Card& card) {
+            cards.add(card);
+            rankCounts[card.getValue() - 2]++;
+            suitCounts[static_cast<int>(card.getSuit())]++;
+            total++;
+            dirty = true;
+        }
+
+        // 已加入的牌
+        CardSet getCards() const {
+            return cards;
+        }
+
+        // 已加入的张数
+        int size() const {
+            return total;
+        }
+
+        // 目前的最好牌力值，与 evaluateValue(getCards()) 相同（不足5张为0）
+        HandValue value() const {
+            if (dirty) {
+                cached = compute();
+                dirty = false;
+            }
+            return cached;
+        }
+
+        // 目前的最好牌力键
+        HandStrength strength() const {
+            return toStrength(value());
+        }
+    };
+
+    // 查表评估手牌，返回牌力键
+    // 与 evaluateValue 的大小关系完全一致，但键本身就带有牌型和关键点数，无需再查表还原
+    // 参数: cards - 需要评估的牌集合（5-7张）
+    // 返回值: 牌力键，牌数不在5-7张之间时返回0
+    HandStrength evaluateStrength(CardSet cards) {
+        return toStrength(evaluateValue(cards));
+    }
+
+    namespace detail {
+        // 批量评估的单组实现：每次处理 LANES 手牌，处理不了的余数交给逐手评估
+        // 所有实现的结果与 evaluateStrength 完全一致
+        using BatchKernel = size_t (*)(const CardSet* hands, HandStrength* out, size_t n);
+
+        // 第r个点数在四个花色中的位：r、r+13、r+26、r+39
+        constexpr std::uint64_t rankColumn(int r) {
+            return (1ULL << r) | (1ULL << (r + 13)) | (1ULL << (r + 26)) | (1ULL << (r + 39));
+        }
+
+#if HAND_EVALUATOR_X86_SIMD
+        // AVX2：每组4手，用半字节查表（pshufb）做64位popcount，用收集指令（gather）查表
+        __attribute__((target("avx2")))
+        inline __m256i popCount4(__m256i v) {
+            const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low = _mm256_set1_epi8(0x0F);
+            __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+                                             _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi64(v, 4), low)));
+            return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t evaluateBatchAvx2(const CardSet* hands, HandStrength* out, size_t n) {
+            const ExtendedTables& extended = extendedTables();
+            const int* steps = reinterpret_cast<const int*>(&HASH.step[0][0][0]);
+            const int* noFlush = reinterpret_cast<const int*>(extended.five.values);
+            const int* flush = reinterpret_cast<const int*>(FLUSH.values);
+            const int* keys = reinterpret_cast<const int*>(KEYS.keys);
+            const __m256i suitBits = _mm256_set1_epi64x(0x1FFF);
+            const __m256i four = _mm256_set1_epi64x(4), eight = _mm256_set1_epi64x(8);
+            const __m256i halfWord = _mm256_set1_epi32(0xFFFF);
+
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hands + i));
+                __m256i total = popCount4(m);
+
+                // 同花：某一花色不少于5张时取该花色的点数掩码
+                __m256i flushMask = _mm256_setzero_si256();
+                for (int s = 0; s < 4; s++) {
+                    __m256i suit = _mm256_and_si256(_mm256_srli_epi64(m, 13 * s), suitBits);
+                    __m256i isFlush = _mm256_cmpgt_epi64(popCount4(suit), four);
+                    flushMask = _mm256_or_si256(flushMask, _mm256_and_si256(suit, isFlush));
+                }
+
+                // 非同花：逐个点数累加完美哈希，index += step[r][count][remaining]
+                __m256i index = _mm256_setzero_si256();
+                __m256i remaining = total;
+                for (int r = 0; r < 13; r++) {
+                    __m256i count = popCount4(_mm256_and_si256(m, _mm256_set1_epi64x(static_cast<long long>(rankColumn(r)))));
+                    __m256i flat = _mm256_add_epi64(_mm256_set1_epi64x(r * 40),
+                                   _mm256_add_epi64(_mm256_mul_epu32(count, eight), remaining));
+                    index = _mm256_add_epi64(index, _mm256_cvtepu32_epi64(_mm256_i64gather_epi32(steps, flat, 4)));
+                    remaining = _mm256_sub_epi64(remaining, count);
+                }
+
+                // 按牌数选择5/6/7张的子表，牌数不在范围内的手牌结果为0
+                __m256i atLeast6 = _mm256_cmpgt_epi64(total, _mm256_set1_epi64x(5));
+                __m256i atLeast7 = _mm256_cmpgt_epi64(total, _mm256_set1_epi64x(6));
+                __m256i valid = _mm256_and_si256(_mm256_cmpgt_epi64(total, four), 
+                                                 _mm256_cmpgt_epi64(_mm256_set1_epi64x(8), total));
+                index = _mm256_add_epi64(index, _mm256_and_si256(atLeast6, _mm256_set1_epi64x(NO_FLUSH_SIZE_5)));
+                index = _mm256_add_epi64(index, _mm256_and_si256(atLeast7, _mm256_set1_epi64x(NO_FLUSH_SIZE_6)));
+                index = _mm256_and_si256(index, valid);
+
+                __m128i plain = _mm256_i64gather_epi32(noFlush, index, 2);
+                __m128i flushed = _mm256_i64gather_epi32(flush, _mm256_and_si256(flushMask, valid), 2);
+                __m128i isFlush = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+                    _mm256_cmpgt_epi64(flushMask, _mm256_setzero_si256()), _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)));
+                __m128i value = _mm_and_si128(_mm_blendv_epi8(plain, flushed, isFlush), _mm256_castsi256_si128(halfWord));
+                __m128i validWords = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(valid, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)));
+                value = _mm_and_si128(value, validWords);
+
+                __m128i key = _mm_i32gather_epi32(keys, value, 4);
+                alignas(16) std::uint32_t result[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(result), key);
+                for (int k = 0; k < 4; k++) out[i + k] = HandStrength(result[k]);
+            }
+            return i;
+        }
+
+        // AVX-512：每组8手，使用原生64位popcount（VPOPCNTDQ）
+        // 部分GCC版本的头文件中 _mm512_undefined_* 会误报未初始化警告，这里将其关闭
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+        __attribute__((target("avx512f,avx512vpopcntdq")))
+        inline size_t evaluateBatchAvx512(const CardSet* hands, HandStrength* out, size_t n) {
+            const ExtendedTables& extended = extendedTables();
+            const int* steps = reinterpret_cast<const int*>(&HASH.step[0][0][0]);
+            const int* noFlush = reinterpret_cast<const int*>(extended.five.values);
+            const int* flush = reinterpret_cast<const int*>(FLUSH.values);
+            const int* keys = reinterpret_cast<const int*>(KEYS.keys);
+            const __m512i suitBits = _mm512_set1_epi64(0x1FFF);
+
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m512i m = _mm512_loadu_si512(hands + i);
+                __m512i total = _mm512_popcnt_epi64(m);
+
+                __m512i flushMask = _mm512_setzero_si512();
+                for (int s = 0; s < 4; s++) {
+                    __m512i suit = _mm512_and_si512(_mm512_maskz_srli_epi64(0xFF, m, 13 * s), suitBits);
+                    __mmask8 isFlush = _mm512_cmpgt_epi64_mask(_mm512_popcnt_epi64(suit), _mm512_set1_epi64(4));
+                    flushMask = _mm512_mask_mov_epi64(flushMask, isFlush, suit);
+                }
+
+                __m512i index = _mm512_setzero_si512();
+                __m512i remaining = total;
+                for (int r = 0; r < 13; r++) {
+                    __m512i count = _mm512_popcnt_epi64(_mm512_and_si512(m, _mm512_set1_epi64(static_cast<long long>(rankColumn(r)))));
+                    __m512i flat = _mm512_add_epi64(_mm512_set1_epi64(r * 40),
+                                   _mm512_add_epi64(_mm512_maskz_slli_epi64(0xFF, count, 3), remaining));
+                    index = _mm512_add_epi64(index, _mm512_cvtepu32_epi64(_mm512_i64gather_epi32(flat, steps, 4)));
+                    remaining = _mm512_sub_epi64(remaining, count);
+                }
+
+                __mmask8 valid = _mm512_cmpgt_epi64_mask(total, _mm512_set1_epi64(4)) & 
+                                 _mm512_cmplt_epi64_mask(total, _mm512_set1_epi64(8));
+                index = _mm512_mask_add_epi64(index, _mm512_cmpgt_epi64_mask(total, _mm512_set1_epi64(5)), 
+                                              index, _mm512_set1_epi64(NO_FLUSH_SIZE_5));
+                index = _mm512_mask_add_epi64(index, _mm512_cmpgt_epi64_mask(total, _mm512_set1_epi64(6)), 
+                                              index, _mm512_set1_epi64(NO_FLUSH_SIZE_6));
+                __mmask8 isFlush = _mm512_test_epi64_mask(flushMask, flushMask) & valid;
+                __mmask8 plainLanes = valid & static_cast<__mmask8>(~isFlush);
+
+                __m256i value = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), plainLanes, index, noFlush, 2);
+                value = _mm512_mask_i64gather_epi32(value, isFlush, flushMask, flush, 2);
+                value = _mm256_and_si256(value, _mm256_set1_epi32(0xFFFF));
+
+                __m256i key = _mm256_i32gather_epi32(keys, value, 4);
+                alignas(32) std::uint32_t result[8];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(result), key);
+                for (int k = 0; k < 8; k++) out[i + k] = HandStrength(result[k]);
+            }
+            return i;
+        }
+#pragma GCC diagnostic pop
+#endif
+
+        // 逐手评估（没有可用的SIMD指令集时使用）
+        inline size_t evaluateBatchScalar(const CardSet*, HandStrength*, size_t) {
+            return 0;
+        }
+
+        // 运行时按CPU支持的指令集选出最快的实现
+        inline BatchKernel selectBatchKernel(const char*& name) {
+#if HAND_EVALUATOR_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+                name = "AVX-512";
+                return evaluateBatchAvx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                name = "AVX2";
+                return evaluateBatchAvx2;
+            }
+#endif
+            name = "标量";
+            return evaluateBatchScalar;
+        }
+
+        struct BatchDispatch {
+            const char* name;
+            BatchKernel kernel;
+            BatchDispatch() : name(""), kernel(selectBatchKernel(name)) {}
+        };
+
+        inline const BatchDispatch& batchDispatch() {
+            static const BatchDispatch dispatch;
+            return dispatch;
+        }
+    }
+
+    // 批量评估手牌，结果与对每手调用 evaluateStrength 完全相同
+    // 运行时按CPU选择AVX-512（每次8手）、AVX2（每次4手）或逐手评估
+    // 参数:
+    //   hands - 手牌数组（每手5-7张）
+    //   out - 输出的牌力键数组，长度不少于 n
+    //   n - 手牌数量
+    void evaluateBatch(const CardSet* hands, HandStrength* out, size_t n) {
+        size_t done = detail::batchDispatch().kernel(hands, out, n);
+        Instrumentation::count(Instrumentation::EVALUATIONS, done);
+        for (size_t i = done; i < n; i++) out[i] = evaluateStrength(hands[i]);
+    }
+
+    // 批量评估所使用的指令集名称
+    const char* batchInstructionSet() {
+        return detail::batchDispatch().name;
+    }
+
+    // 获取牌力值对应的牌型
+    HandRank getHandRank(HandValue value) {
+        return toStrength(value).rank();
+    }
+
+    // 把牌力键还原为牌型和最好5张牌的点数列表
+    // 点数按重要性排列，例如葫芦为 {三条, 三条, 三条, 对子, 对子}，A-2-3-4-5顺子为 {5, 4, 3, 2, 14}
+    // 参数: strength - 牌力键
+    // 返回值: 与 evaluateHand 相同格式的pair
+    std::pair<HandRank, std::vector<int>> describeStrength(HandStrength strength) {
+        if (strength.raw() == 0) return {HandRank::HIGH_CARD, {}};
+        HandRank rank = strength.rank();
+        int field[5];
+        for (int i = 0; i < 5; i++) field[i] = strength.kicker(i);
+
+        // 每个关键点数在最好5张牌中重复的次数
+        std::vector<int> repeats;
+        switch (rank) {
+            case HandRank::FOUR_OF_A_KIND: repeats = {4, 1}; break;
+            case HandRank::FULL_HOUSE: repeats = {3, 2}; break;
+            case HandRank::THREE_OF_A_KIND: repeats = {3, 1, 1}; break;
+            case HandRank::TWO_PAIR: repeats = {2, 2, 1}; break;
+            case HandRank::ONE_PAIR: repeats = {2, 1, 1, 1}; break;
+            case HandRank::STRAIGHT:
+            case HandRank::STRAIGHT_FLUSH: {
+                std::vector<int> ranks;
+                for (int i = 0; i < 5; i++) ranks.push_back(field[0] - i);
+                if (field[0] == 5) ranks[4] = 14;  // A-2-3-4-5中A作为1使用
+                return {rank, ranks};
+            }
+            default: repeats = {1, 1, 1, 1, 1}; break;
+        }
+
+        std::vector<int> ranks;
+        for (size_t i = 0; i < repeats.size(); i++) {
+            ranks.insert(ranks.end(), repeats[i], field[i]);
+        }
+        return {rank, ranks};
+    }
+
+    // 把16位牌力值还原为牌型和最好5张牌的点数列表
+    std::pair<HandRank, std::vector<int>> describeValue(HandValue value) {
+        return describeStrength(toStrength(value));
+    }
+
+    // 评估手牌，返回牌型和最好5张牌的点数列表
+    // 这是德州扑克中最核心的函数，用于判断玩家手牌的类型和强度
+    // 内部通过 evaluateValue 查表完成，点数列表只包含决定胜负的5张牌
+    // 参数: cards - 需要评估的卡牌集合（通常是玩家手牌+公共牌）
+    // 返回值: 包含牌型枚举和排序后点数列表的pair
+    std::pair<HandRank, std::vector<int>> evaluateHand(const std::vector<Card>& cards) {
+        if (cards.size() < 5) {
+            return {HandRank::HIGH_CARD, {}};  // 牌不足5张，返回高牌
+        }
+        if (cards.size() > 7) {
+            return legacyEvaluateHand(cards);  // 查找表只覆盖到7张牌
+        }
+        return describeValue(evaluateValue(cards));
+    }
+
+    // 获取牌型的中文名称
+    // 参数: rank - 牌型枚举值
+    // 返回值: 牌型的中文描述
+    std::string getHandRankName(HandRank rank) {
+        switch (rank) {
+            case HandRank::STRAIGHT_FLUSH: return "同花顺";
+            case HandRank::FOUR_OF_A_KIND: return "四条";
+            case HandRank::FULL_HOUSE: return "葫芦";
+            case HandRank::FLUSH: return "同花";
+            case HandRank::STRAIGHT: return "顺子";
+            case HandRank::THREE_OF_A_KIND: return "三条";
+            case HandRank::TWO_PAIR: return "两对";
+            case HandRank::ONE_PAIR: return "一对";
+            case HandRank::HIGH_CARD: return "高牌";
+            default: return "未知牌型";
+        }
+    }
+
+    // 比较两个玩家的手牌大小
+    // 返回值：正数表示player1赢，负数表示player2赢，0表示平局
+    int compareHands(const Player& player1, const Player& player2, const std::vector<Card>& communityCards) {
+        Instrumentation::count(Instrumentation::COMPARISONS);
+        // 获取玩家手牌和公共牌的组合
+        auto hand1 = player1.getCombinedCards(communityCards);
+        auto hand2 = player2.getCombinedCards(communityCards);
+        
+        // 牌力值已经包含了牌型和踢脚的全部信息，直接比较整数即可
+        return static_cast<int>(evaluateValue(hand1)) - static_cast<int>(evaluateValue(hand2));
+    }
+
+    // 比较两个玩家的手牌大小（公共牌以掩码给出，不复制任何卡牌）
+    // 返回值：正数表示player1赢，负数表示player2赢，0表示平局
+    int compareHands(const Player& player1, const Player& player2, CardSet communityMask) {
+        Instrumentation::count(Instrumentation::COMPARISONS);
+        return static_cast<int>(evaluateValue(player1.getCombinedMask(communityMask))) - 
+               static_cast<int>(evaluateValue(player2.getCombinedMask(communityMask)));
+    }
+
+    // 批量评估：一次算出所有玩家的牌力值，之后的比较都只是整数比较
+    // 参数:
+    //   players - 玩家列表
+    //   communityMask - 公共牌的掩码
+    //   values - 输出，values[i] 为第i位玩家的牌力值；已弃牌或不在游戏中的玩家为0
+    //            传入同一个 vector 反复调用不会重新分配内存
+    void evaluateAll(const PlayerList& players, CardSet communityMask, std::vector<HandValue>& values) {
+        values.resize(players.size());
+        for (size_t i = 0; i < players.size(); i++) {
+            const Player& player = players[i];
+            values[i] = (player.getIsInGame() && !player.getHasFolded()) 
+                        ? evaluateValue(player.getCombinedMask(communityMask)) : 0;
+        }
+    }
+
+    // 全量校验查表评估器：枚举全部 C(52,7) = 133784560 手牌，与原始实现逐一对照牌型
+    // 原始实现只要同时存在顺子和同花就判为同花顺（即使两者不是同一组牌），
+    // 这类手牌查表评估器判为同花，单独计数而不算作错误
+    // 同时核对各牌型出现次数和7张牌可达到的不同牌力数（4824）这些公认数据
+    // 返回值: 0表示校验通过，1表示发现不一致
+    int certify() {
+        // 7张牌各牌型出现次数的公认值（按 HandRank 顺序）
+        const long long expected[9] = {
+            23294460, 58627800, 31433400, 6461620, 6180020,
+            4047644, 3473184, 224848, 41584
+        };
+
+        std::vector<Card> all;
+        for (int s = 0; s < 4; s++) {
+            for (int r = 2; r <= 14; r++) {
+                all.emplace_back(static_cast<Suit>(s), static_cast<Rank>(r));
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        long long frequency[9] = {};
+        long long total = 0, fakeStraightFlush = 0, mismatches = 0;
+        std::vector<bool> seen(detail::DISTINCT_HANDS + 1, false);
+        std::vector<Card> hand(7, all[0]);
+
+        for (int a = 0; a < 52; a++) { hand[0] = all[a];
+        for (int b = a + 1; b < 52; b++) { hand[1] = all[b];
+        for (int c = b + 1; c < 52; c++) { hand[2] = all[c];
+        for (int d = c + 1; d < 52; d++) { hand[3] = all[d];
+        for (int e = d + 1; e < 52; e++) { hand[4] = all[e];
+        for (int f = e + 1; f < 52; f++) { hand[5] = all[f];
+        for (int g = f + 1; g < 52; g++) { hand[6] = all[g];
+            HandValue value = evaluateValue(hand);
+            HandRank rank = getHandRank(value);
+            HandRank legacy = legacyEvaluateHand(hand).first;
+            total++;
+            frequency[static_cast<int>(rank)]++;
+            seen[value] = true;
+            if (rank != legacy) {
+                if (legacy == HandRank::STRAIGHT_FLUSH && rank == HandRank::FLUSH) {
+                    fakeStraightFlush++;
+                } else if (mismatches++ < 10) {
+                    std::cout << "不一致: ";
+                    for (const auto& card : hand) std::cout << card.toString() << " ";
+                    std::cout << "原始=" << getHandRankName(legacy)
+                              << " 查表=" << getHandRankName(rank) << "\n";
+                }
+            }
+        }}}}}}}
+
+        bool ok = mismatches == 0;
+        std::cout << "手牌总数: " << total << "\n";
+        for (int i = 8; i >= 0; i--) {
+            std::cout << getHandRankName(static_cast<HandRank>(i)) << ": " << frequency[i]
+                      << (frequency[i] == expected[i] ? "" : "（与公认值不符）") << "\n";
+            ok = ok && frequency[i] == expected[i];
+        }
+        int distinct = static_cast<int>(std::count(seen.begin() + 1, seen.end(), true));
+        ok = ok && distinct == 4824;
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "不同牌力数: " << distinct << "\n"
+                  << "原始实现误判的同花顺: " << fakeStraightFlush << "\n"
+                  << "其他不一致: " << mismatches << "\n"
+                  << "耗时: " << seconds << " 秒\n"
+                  << (ok ? "校验通过" : "校验失败") << std::endl;
+        return ok ? 0 : 1;
+    }
+}
+
+// 胜率计算命名空间 - 计算给定手牌和公共牌在若干随机对手面前的胜率
+namespace Equity {
+    // 胜率计算结果
+    struct EquityResult {
+        double win = 0;         // 独赢的比例
+        double tie = 0;         // 与人平分底池的比例
+        double loss = 0;        // 输掉的比例
+        double equity = 0;      // 期望分得的底池比例（平局按人数平分计入）
+        double stdError = 0;    // equity 的标准误差（精确枚举时为0）
+        long long samples = 0;  // 样本数（精确枚举时为枚举的牌面数），0表示输入无效
+    };
+
+    // 蒙特卡洛模拟的参数
+    struct MonteCarloOptions {
+        double targetError = 0.002;         // 目标标准误差，达到后即停止
+        long long minSamples = 20000;       // 最少样本数，避免小样本下误差估计不可靠
+        long long maxSamples = 20000000;    // 最多样本数
+        int threads = 0;                    // 线程数，0表示使用全部核心
+        std::uint64_t seed = 0;             // 随机数种子，0表示使用真随机数
+    };
+
+    namespace detail {
+        // 单个线程的计数器，按缓存行对齐避免多线程伪共享
+        struct alignas(64) Counters {
+            long long wins = 0, ties = 0, losses = 0, samples = 0;
+            double equitySum = 0, equitySquareSum = 0;
+
+            void merge(const Counters& other) {
+                wins += other.wins; ties += other.ties; losses += other.losses; samples += other.samples;
+                equitySum += other.equitySum; equitySquareSum += other.equitySquareSum;
+            }
+        };
+
+        // 检查输入：手牌2张、公共牌不超过5张且互不重复、对手1-21人
+        inline bool validInput(CardSet hole, CardSet board, int opponents) {
+            return hole.size() == 2 && board.size() <= 5 && (hole & board).empty() &&
+                   opponents >= 1 && opponents <= 21;
+        }
+
+        // 记录一次结果
+        // 参数:
+        //   c - 计数器
+        //   hero - 自己的牌力值
+        //   best - 所有对手中最大的牌力值
+        //   bestCount - 拿到 best 的对手人数
+        inline void record(Counters& c, HandEvaluator::HandValue hero, 
+                           HandEvaluator::HandValue best, int bestCount) {
+            double share;
+            if (hero > best) {
+                c.wins++;
+                share = 1.0;
+            } else if (hero == best) {
+                c.ties++;
+                share = 1.0 / (bestCount + 1);
+            } else {
+                c.losses++;
+                share = 0.0;
+            }
+            c.samples++;
+            c.equitySum += share;
+            c.equitySquareSum += share * share;
+        }
+
+        // 一个线程的模拟：每个样本随机补全公共牌并为每个对手随机发两张牌
+        // 参数:
+        //   hole, board, opponents - 同 monteCarlo
+        //   samples - 本线程要模拟的样本数
+        //   engine - 本线程独立的随机数引擎，模拟时使用局部副本，结束时写回
+        //         （各线程的引擎在 vector 中紧挨着存放，直接更新会让相邻线程反复争用同一缓存行）
+        //   out - 本线程的计数器
+        inline void simulate(CardSet hole, CardSet board, int opponents, long long samples, 
+                             Xoshiro256& engine, Counters& out) {
+            Xoshiro256 rng = engine;
+            int deck[52];
+            int deckSize = 0;
+            std::uint64_t live = (CardSet::fullDeck() - hole - board).bits();
+            for (int i = 0; i < 52; i++) {
+                if ((live >> i) & 1) deck[deckSize++] = i;
+            }
+            int missing = 5 - board.size();
+            int needed = missing + 2 * opponents;
+
+            for (long long n = 0; n < samples; n++) {
+                // 部分 Fisher-Yates：只打乱需要用到的前 needed 张
+                for (int i = 0; i < needed; i++) {
+                    int j = i + static_cast<int>(randomBelow(rng, static_cast<std::uint32_t>(deckSize - i)));
+                    std::swap(deck[i], deck[j]);
+                }
+                std::uint64_t full = board.bits();
+                for (int i = 0; i < missing; i++) full |= std::uint64_t(1) << deck[i];
+
+                HandEvaluator::HandValue hero = HandEvaluator::evaluateValue(CardSet(full) | hole);
+                HandEvaluator::HandValue best = 0;
+                int bestCount = 0;
+                for (int o = 0; o < opponents; o++) {
+                    std::uint64_t cards = full | (std::uint64_t(1) << deck[missing + 2 * o]) | 
+                                          (std::uint64_t(1) << deck[missing + 2 * o + 1]);
+                    HandEvaluator::HandValue value = HandEvaluator::evaluateValue(CardSet(cards));
+                    if (value > best) {
+                        best = value;
+                        bestCount = 1;
+                    } else if (value == best) {
+                        bestCount++;
+                    }
+                }
+                record(out, hero, best, bestCount);
+            }
+            engine = rng;
+        }
+
+        // 由计数器得到最终结果
+        inline EquityResult finish(const Counters& c) {
+            EquityResult result;
+            if (c.samples == 0) return result;
+            double n = static_cast<double>(c.samples);
+            result.win = c.wins / n;
+            result.tie = c.ties / n;
+            result.loss = c.losses / n;
+            result.equity = c.equitySum / n;
+            double variance = std::max(0.0, c.equitySquareSum / n - result.equity * result.equity);
+            result.stdError = std::sqrt(variance / n);
+            result.samples = c.samples;
+            return result;
+        }
+
+        // 实际使用的线程数
+        inline int threadCount(int requested) {
+            if (requested > 0) return requested;
+            return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+    }
+
+    // 蒙特卡洛胜率计算
+    // 分批进行：每批由所有线程并行模拟，每个线程使用独立的随机数序列和计数器，
+    // 一批结束后合并计数器，标准误差达到目标或样本数达到上限即停止
+    // 参数:
+    //   hole - 自己的两张手牌
+    //   board - 已知的公共牌（0-5张）
+    //   opponents - 随机对手人数（1-21）
+    //   options - 模拟参数
+    // 返回值: 胜率结果，输入无效时 samples 为0
+    EquityResult monteCarlo(CardSet hole, CardSet board, int opponents, 
+                            const MonteCarloOptions& options = MonteCarloOptions()) {
+        if (!detail::validInput(hole, board, opponents)) return EquityResult();
+
+        int threads = detail::threadCount(options.threads);
+        Xoshiro256 seeder(options.seed ? options.seed : Xoshiro256::randomSeed());
+        std::vector<Xoshiro256> rngs;
+        for (int t = 0; t < threads; t++) {
+            rngs.push_back(seeder);
+            seeder.jump();  // 每个线程相隔 2^128 个数，序列互不重叠
+        }
+
+        detail::Counters total;
+        long long batch = std::max(options.minSamples, 1LL);
+        while (true) {
+            batch = std::min(batch, options.maxSamples - total.samples);
+            if (batch <= 0) break;
+
+            std::vector<detail::Counters> counters(threads);
+            std::vector<std::thread> workers;
+            long long perThread = (batch + threads - 1) / threads;
+            for (int t = 0; t < threads; t++) {
+                long long count = std::min(perThread, batch - perThread * t);
+                if (count <= 0) break;
+                workers.emplace_back(detail::simulate, hole, board, opponents, count, 
+                                     std::ref(rngs[t]), std::ref(counters[t]));
+            }
+            for (auto& worker : workers) worker.join();
+            for (const auto& c : counters) total.merge(c);
+
+            EquityResult current = detail::finish(total);
+            if (current.stdError <= options.targetError) break;
+
+            // 误差与样本数的平方根成反比，据此估计还差多少样本
+            double ratio = current.stdError / std::max(options.targetError, 1e-12);
+            long long needed = static_cast<long long>(total.samples * (ratio * ratio - 1.0)) + 1;
+            batch = std::max(needed, options.minSamples);
+        }
+        return detail::finish(total);
+    }
+
+    // 蒙特卡洛胜率计算（以卡牌列表给出手牌和公共牌）
+    EquityResult monteCarlo(const std::vector<Card>& hole, const std::vector<Card>& board, int opponents,
+                            const MonteCarloOptions& options = MonteCarloOptions()) {
+        if (CardSet(hole).size() != static_cast<int>(hole.size()) ||
+            CardSet(board).size() != static_cast<int>(board.size())) {
+            return EquityResult();  // 有重复的牌
+        }
+        return monteCarlo(CardSet(hole), CardSet(board), opponents, options);
+    }
+
+    // 精确枚举的参数
+    struct ExactOptions {
+        int threads = 0;        // 线程数，0表示使用全部核心
+        CardSet dead;           // 额外排除的牌（例如已知被烧掉或被弃掉的牌）
+    };
+
+    namespace detail {
+        // 精确枚举的共享输入
+        struct ExactJob {
+            CardSet hole;                       // 自己的手牌
+            CardSet board;                      // 已知公共牌
+            std::vector<CardSet> villains;      // 已知对手手牌
+            bool randomOpponent;                // 是否还有一个手牌未知的对手
+            int live[52];                       // 可供发出的牌（按编号升序，即组合枚举的顺序）
+            int liveCount;
+            int missing;                        // 还要发出的公共牌张数
+        };
+
+        // 对一个完整牌面计算结果（牌面上的牌已确定）
+        // 参数:
+        //   job - 共享输入
+        //   full - 完整的5张公共牌
+        //   used - 本牌面已经用掉的牌（不能再发给未知对手）
+        //   out - 计数器
+        inline void scoreRunout(const ExactJob& job, CardSet full, CardSet used, Counters& out) {
+            // 同一牌面下自己和已知对手的牌力只计算一次
+            HandEvaluator::HandValue hero = HandEvaluator::evaluateValue(job.hole | full);
+            HandEvaluator::HandValue best = 0;
+            int bestCount = 0;
+            for (CardSet villain : job.villains) {
+                HandEvaluator::HandValue value = HandEvaluator::evaluateValue(villain | full);
+                if (value > best) { best = value; bestCount = 1; }
+                else if (value == best) bestCount++;
+            }
+            if (!job.randomOpponent) {
+                record(out, hero, best, bestCount);
+                return;
+            }
+            // 枚举未知对手所有可能的两张底牌
+            for (int a = 0; a < job.liveCount; a++) {
+                if (used.contains(Card::fromIndex(job.live[a]))) continue;
+                for (int b = a + 1; b < job.liveCount; b++) {
+                    if (used.contains(Card::fromIndex(job.live[b]))) continue;
+                    CardSet cards = full;
+                    cards.add(Card::fromIndex(job.live[a]));
+                    cards.add(Card::fromIndex(job.live[b]));
+                    HandEvaluator::HandValue value = HandEvaluator::evaluateValue(cards);
+                    if (value > best) record(out, hero, value, 1);
+                    else if (value == best) record(out, hero, best, bestCount + 1);
+                    else record(out, hero, best, bestCount);
+                }
+            }
+        }
+
+        // 从 live[start..] 中按组合顺序选出 k 张补全牌面，逐层把已选的牌并入掩码
+        inline void enumerateRunouts(const ExactJob& job, int start, int k, CardSet partial, Counters& out) {
+            if (k == 0) {
+                scoreRunout(job, partial, partial, out);
+                return;
+            }
+            for (int i = start; i <= job.liveCount - k; i++) {
+                CardSet next = partial;
+                next.add(Card::fromIndex(job.live[i]));
+                enumerateRunouts(job, i + 1, k - 1, next, out);
+            }
+        }
+
+        // 一个线程的工作：不断领取"第一张补牌"的下标，枚举以它开头的所有牌面
+        inline void exactWorker(const ExactJob& job, std::atomic<int>& next, Counters& out) {
+            if (job.missing == 0) {
+                if (next.fetch_add(1) == 0) scoreRunout(job, job.board, job.board, out);
+                return;
+            }
+            for (int first = next.fetch_add(1); first <= job.liveCount - job.missing; first = next.fetch_add(1)) {
+                CardSet partial = job.board;
+                partial.add(Card::fromIndex(job.live[first]));
+                enumerateRunouts(job, first + 1, job.missing - 1, partial, out);
+            }
+        }
+    }
+
+    // 精确胜率计算 - 枚举所有尚未发出的公共牌组合（以及一个未知对手的所有底牌）
+    // 适用于转牌、河牌等剩余组合很少的局面，可作为蒙特卡洛结果的基准
+    // 工作按"第一张补牌"切分，多个线程动态领取，各线程的计数器最后合并
+    // 参数:
+    //   hole - 自己的两张手牌
+    //   board - 已知的公共牌（0-5张）
+    //   villains - 已知的对手手牌（每个两张），可以为空
+    //   randomOpponent - 是否还有一个底牌未知的对手（至少需要一个对手）
+    //   options - 枚举参数
+    // 返回值: 精确的胜率结果，samples 为枚举的结果总数；输入无效时 samples 为0
+    EquityResult exact(CardSet hole, CardSet board, const std::vector<CardSet>& villains, 
+                       bool randomOpponent, const ExactOptions& options = ExactOptions()) {
+        int opponents = static_cast<int>(villains.size()) + (randomOpponent ? 1 : 0);
+        if (!detail::validInput(hole, board, opponents)) return EquityResult();
+
+        detail::ExactJob job;
+        job.hole = hole;
+        job.board = board;
+        job.villains = villains;
+        job.randomOpponent = randomOpponent;
+        job.missing = 5 - board.size();
+
+        CardSet known = hole | board | options.dead;
+        for (CardSet villain : villains) {
+            if (villain.size() != 2 || !(known & villain).empty()) return EquityResult();
+            known |= villain;
+        }
+        std::uint64_t live = (CardSet::fullDeck() - known).bits();
+        job.liveCount = 0;
+        for (int i = 0; i < 52; i++) {
+            if ((live >> i) & 1) job.live[job.liveCount++] = i;
+        }
+
+        int threads = detail::threadCount(options.threads);
+        std::vector<detail::Counters> counters(threads);
+        std::vector<std::thread> workers;
+        std::atomic<int> next(0);
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back(detail::exactWorker, std::cref(job), std::ref(next), std::ref(counters[t]));
+        }
+        for (auto& worker : workers) worker.join();
+
+        detail::Counters total;
+        for (const auto& c : counters) total.merge(c);
+        EquityResult result = detail::finish(total);
+        result.stdError = 0;
+        return result;
+    }
+
+    // 精确胜率计算（以卡牌列表给出）
+    EquityResult exact(const std::vector<Card>& hole, const std::vector<Card>& board, 
+                       const std::vector<std::vector<Card>>& villains, bool randomOpponent,
+                       const ExactOptions& options = ExactOptions()) {
+        std::vector<CardSet> villainSets;
+        for (const auto& villain : villains) villainSets.emplace_back(villain);
+        return exact(CardSet(hole), CardSet(board), villainSets, randomOpponent, options);
+    }
+
+    // 花色同构的规范键 - 只重新标记花色而得到的局面（例如 A♥K♥ 配某个牌面与 A♠K♠ 配交换花色后的牌面）胜率相同，键也相同
+    // 每种花色取（公共牌的点数掩码，手牌的点数掩码）组成26位的元组，四个元组降序排列后拼起来；
+    // 交换花色只会交换元组的顺序，排序后的结果不变，而不同构的局面至少有一个元组不同
+    struct CanonicalKey {
+        std::uint64_t low;          // 排序后的第0、1个元组
+        std::uint64_t high;         // 排序后的第2、3个元组
+        std::uint32_t query;        // 查询参数：对手人数，第8位表示精确枚举
+
+        bool operator==(const CanonicalKey& other) const {
+            return low == other.low && high == other.high && query == other.query;
+        }
+    };
+
+    // 计算规范键
+    // 参数:
+    //   hole - 手牌
+    //   board - 公共牌
+    //   opponents - 对手人数
+    //   exact - 是否为精确枚举
+    inline CanonicalKey canonicalKey(CardSet hole, CardSet board, int opponents, bool exact) {
+        std::uint32_t t[4];
+        for (int s = 0; s < 4; s++) {
+            t[s] = (board.suitMask(static_cast<Suit>(s)) << 13) | hole.suitMask(static_cast<Suit>(s));
+        }
+        // 4个元素的排序网络（降序）
+        auto order = [&t](int a, int b) {
+            if (t[a] < t[b]) std::swap(t[a], t[b]);
+        };
+        order(0, 1); order(2, 3); order(0, 2); order(1, 3); order(1, 2);
+        return CanonicalKey{t[0] | (static_cast<std::uint64_t>(t[1]) << 32),
+                            t[2] | (static_cast<std::uint64_t>(t[3]) << 32),
+                            static_cast<std::uint32_t>(opponents) | (exact ? 0x100u : 0u)};
+    }
+
+    // 胜率结果缓存 - 以规范键为键的分片 LRU 缓存，可以被多个线程同时使用
+    // 每个分片有自己的互斥锁、定长的条目池、哈希桶链和按使用先后排列的双向链表（都用下标连接），
+    // 构造之后不再分配内存；分片按缓存行对齐，不同分片的查询互不争用。
+    // 未命中时在锁外计算，两个线程同时查询同一个局面可能各算一次，结果相同
+    class ResultCache {
+    public:
+        // 命中统计
+        struct Stats {
+            std::uint64_t hits = 0;         // 命中次数
+            std::uint64_t misses = 0;       // 未命中次数
+            std::uint64_t evictions = 0;    // 淘汰的条目数
+            size_t size = 0;                // 当前条目数
+        };
+
+    private:
+        struct Entry {
+            CanonicalKey key;
+            EquityResult result;
+            std::int32_t newer;             // 更近使用的条目，-1表示没有
+            std::int32_t older;             // 更早使用的条目，-1表示没有
+            std::int32_t chain;             // 同一个哈希桶的下一个条目，-1表示没有
+        };
+
+        struct alignas(64) Shard {
+            std::mutex mutex;
+            std::vector<Entry> entries;         // 条目池
+            std::vector<std::int32_t> buckets;  // 哈希桶的第一个条目，-1表示空
+            std::int32_t newest = -1;           // 最近使用的条目
+            std::int32_t oldest = -1;           // 最早使用的条目（下一个被淘汰）
+            std::int32_t used = 0;              // 条目池中已用的条目数
+            std::uint64_t hits = 0, misses = 0, evictions = 0;
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        int shardBits;                      // 分片数 = 2^shardBits
+        MonteCarloOptions monteCarloOptions;
+        ExactOptions exactOptions;
+
+        static std::uint64_t hash(const CanonicalKey& key) {
+            std::uint64_t h = key.low * 0x9E3779B97F4A7C15ull;
+            h = (h ^ (h >> 29) ^ key.high) * 0xBF58476D1CE4E5B9ull;
+            h = (h ^ (h >> 32) ^ key.query) * 0x94D049BB133111EBull;
+            return h ^ (h >> 31);
+        }
+
+        Shard& shardFor(std::uint64_t h) {
+            return *shards[shardBits == 0 ? 0 : h >> (64 - shardBits)];
+        }
+
+        // 从使用链表中摘下一个条目
+        static void unlink(Shard& shard, std::int32_t i) {
+            Entry& e = shard.entries[i];
+            if (e.newer >= 0) shard.entries[e.newer].older = e.older; else shard.newest = e.older;
+            if (e.older >= 0) shard.entries[e.older].newer = e.newer; else shard.oldest = e.newer;
+        }
+
+        // 把一个条目放到使用链表的最前面
+        static void pushNewest(Shard& shard, std::int32_t i) {
+            Entry& e = shard.entries[i];
+            e.newer = -1;
+            e.older = shard.newest;
+            if (shard.newest >= 0) shard.entries[shard.newest].newer = i;
+            shard.newest = i;
+            if (shard.oldest < 0) shard.oldest = i;
+        }
+
+        // 在哈希桶链中查找，返回条目下标，没有时返回-1
+        static std::int32_t locate(const Shard& shard, std::uint64_t h, const CanonicalKey& key) {
+            std::int32_t i = shard.buckets[h & (shard.buckets.size() - 1)];
+            while (i >= 0 && !(shard.entries[i].key == key)) i = shard.entries[i].chain;
+            return i;
+        }
+
+    public:
+        // 构造函数
+        // 参数:
+        //   capacity - 最多缓存的结果数（按分片平均分配）
+        //   shardCount - 分片数，取不小于它的2的幂
+        //   mcOptions - 未命中时蒙特卡洛计算使用的参数（同一个缓存里的结果都按这组参数计算）
+        explicit ResultCache(size_t capacity = 1 << 16, int shardCount = 16,
+                             const MonteCarloOptions& mcOptions = MonteCarloOptions())
+            : shardBits(0), monteCarloOptions(mcOptions) {
+            while ((1 << shardBits) < shardCount) shardBits++;
+            size_t perShard = std::max<size_t>((capacity + (size_t(1) << shardBits) - 1) >> shardBits, 1);
+            size_t bucketCount = 1;
+            while (bucketCount < 2 * perShard) bucketCount <<= 1;
+            for (int s = 0; s < (1 << shardBits); s++) {
+                shards.push_back(std::unique_ptr<Shard>(new Shard()));
+                shards.back()->entries.resize(perShard);
+                shards.back()->buckets.assign(bucketCount, -1);
+            }
+        }
+
+        // 查找结果
+        // 参数:
+        //   key - 规范键
+        //   out - 命中时写入结果
+        // 返回值: 是否命中
+        bool find(const CanonicalKey& key, EquityResult& out) {
+            std::uint64_t h = hash(key);
+            Shard& shard = shardFor(h);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            std::int32_t i = locate(shard, h, key);
+            if (i < 0) {
+                shard.misses++;
+                return false;
+            }
+            shard.hits++;
+            if (shard.newest != i) {
+                unlink(shard, i);
+                pushNewest(shard, i);
+            }
+            out = shard.entries[i].result;
+            return true;
+        }
+
+        // 放入结果，分片已满时淘汰最早使用的条目
+        // 参数:
+        //   key - 规范键
+        //   result - 胜率结果
+        void insert(const CanonicalKey& key, const EquityResult& result) {
+            std::uint64_t h = hash(key);
+            Shard& shard = shardFor(h);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            std::int32_t i = locate(shard, h, key);
+            if (i >= 0) {
+                unlink(shard, i);
+            } else {
+                if (shard.used < static_cast<std::int32_t>(shard.entries.size())) {
+                    i = shard.used++;
+                } else {
+                    // 淘汰最早使用的条目：从使用链表和它的哈希桶链中摘下
+                    i = shard.oldest;
+                    unlink(shard, i);
+                    std::int32_t* link = &shard.buckets[hash(shard.entries[i].key) & (shard.buckets.size() - 1)];
+                    while (*link != i) link = &shard.entries[*link].chain;
+                    *link = shard.entries[i].chain;
+                    shard.evictions++;
+                }
+                std::int32_t& head = shard.buckets[h & (shard.buckets.size() - 1)];
+                shard.entries[i].key = key;
+                shard.entries[i].chain = head;
+                head = i;
+            }
+            shard.entries[i].result = result;
+            pushNewest(shard, i);
+        }
+
+        // 带缓存的蒙特卡洛胜率计算，参数同 Equity::monteCarlo（计算参数使用构造时给出的那一组）
+        EquityResult monteCarlo(CardSet hole, CardSet board, int opponents) {
+            if (!detail::validInput(hole, board, opponents)) return EquityResult();
+            CanonicalKey key = canonicalKey(hole, board, opponents, false);
+            EquityResult result;
+            if (find(key, result)) return result;
+            result = Equity::monteCarlo(hole, board, opponents, monteCarloOptions);
+            insert(key, result);
+            return result;
+        }
+
+        // 带缓存的精确胜率计算，对手为一个底牌未知的玩家
+        EquityResult exact(CardSet hole, CardSet board) {
+            if (!detail::validInput(hole, board, 1)) return EquityResult();
+            CanonicalKey key = canonicalKey(hole, board, 1, true);
+            EquityResult result;
+            if (find(key, result)) return result;
+            result = Equity::exact(hole, board, std::vector<CardSet>(), true, exactOptions);
+            insert(key, result);
+            return result;
+        }
+
+        // 汇总各分片的统计
+        Stats stats() {
+            Stats total;
+            for (auto& shard : shards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                total.hits += shard->hits;
+                total.misses += shard->misses;
+                total.evictions += shard->evictions;
+                total.size += static_cast<size_t>(shard->used);
+            }
+            return total;
+        }
+    };
+}
+
+// 翻牌前牌力表 - 169种起手牌分别面对1-21名随机对手时的胜率
+// 数据由 --gen-preflop 离线生成（蒙特卡洛，标准误差不超过0.05%），以万分比编译进程序，查询只需读一次表
+namespace Preflop {
+    const int CLASS_COUNT = 169;    // 起手牌类别数：13种对子 + 78种同花 + 78种不同花
+    const int MAX_OPPONENTS = 21;   // 对手人数上限
+
+    // 起手牌类别索引：13×13网格，行和列为点数（0为2，12为A）
+    // 对子在对角线上；同花为（大点数行，小点数列），不同花为（小点数行，大点数列）
+    // 参数:
+    //   first, second - 两张点数（2-14）
+    //   suited - 是否同花
+    constexpr int classIndex(int first, int second, bool suited) {
+        return first == second ? (first - 2) * 14 
+             : (first > second) == suited ? (first - 2) * 13 + (second - 2) 
+                                          : (second - 2) * 13 + (first - 2);
+    }
+
+    // 两张底牌所属的起手牌类别
+    inline int classIndex(const Card& a, const Card& b) {
+        return classIndex(a.getValue(), b.getValue(), a.getSuit() == b.getSuit());
+    }
+
+    // 类别名称，例如 "AA"、"AKs"、"72o"
+    inline std::string className(int index) {
+        const char* ranks = "23456789TJQKA";
+        int row = index / 13, column = index % 13;
+        if (row == column) return std::string(2, ranks[row]);
+        int high = std::max(row, column), low = std::min(row, column);
+        return std::string(1, ranks[high]) + ranks[low] + (row > column ? 's' : 'o');
+    }
+
+    namespace detail {
+        // 胜率表（万分比），EQUITY[对手人数-1][类别索引]
+        // 以下数据由 --gen-preflop 生成，请勿手工修改
+        constexpr std::uint16_t EQUITY[MAX_OPPONENTS][CLASS_COUNT] = {
+            { // 1名对手
+                5033, 3233, 3311, 3428, 3410, 3455, 3676, 3917, 4161, 4423, 4733, 5047, 5486,
+                3594, 5363, 3521, 3634, 3609, 3657, 3748, 4003, 4261, 4520, 4818, 5155, 5585,
+                3688, 3864, 5705, 3813, 3799, 3858, 3949, 4064, 4346, 4615, 4917, 5228, 5668,
+                3790, 3976, 4145, 6035, 3996, 4045, 4131, 4269, 4418, 4712, 5019, 5336, 5769,
+                3772, 3952, 4127, 4324, 6326, 4233, 4323, 4448, 4605, 4789, 5100, 5432, 5779,
+                3813, 4001, 4188, 4368, 4541, 6630, 4496, 4626, 4787, 4964, 5185, 5512, 5871,
+                4018, 4084, 4265, 4452, 4619, 4790, 6924, 4809, 4974, 5147, 5357, 5608, 5981,
+                4242, 4322, 4384, 4576, 4747, 4912, 5086, 7196, 5154, 5314, 5531, 5780, 6078,
+                4487, 4582, 4656, 4720, 4899, 5068, 5230, 5410, 7498, 5525, 5732, 5979, 6264,
+                4735, 4818, 4907, 4993, 5064, 5230, 5402, 5566, 5746, 7749, 5810, 6059, 6358,
+                5016, 5100, 5188, 5292, 5361, 5436, 5597, 5768, 5948, 6024, 7988, 6150, 6439,
+                5317, 5413, 5490, 5570, 5663, 5752, 5826, 5998, 6180, 6263, 6335, 8236, 6537,
+                5735, 5815, 5906, 5988, 5997, 6099, 6188, 6285, 6455, 6535, 6624, 6703, 8522,
+            },
+            { // 2名对手
+                3067, 1970, 2063, 2148, 2078, 2053, 2176, 2314, 2477, 2650, 2867, 3120, 3519,
+                2388, 3358, 2246, 2342, 2278, 2244, 2236, 2389, 2568, 2734, 2954, 3205, 3624,
+                2468, 2643, 3677, 2538, 2471, 2459, 2442, 2456, 2648, 2821, 3045, 3296, 3729,
+                2546, 2727, 2909, 4000, 2669, 2646, 2655, 2648, 2707, 2912, 3130, 3393, 3818,
+                2479, 2669, 2843, 3019, 4323, 2838, 2843, 2855, 2905, 2967, 3227, 3484, 3788,
+                2458, 2636, 2830, 3012, 3184, 4651, 3035, 3065, 3130, 3191, 3303, 3603, 3922,
+                2582, 2639, 2822, 3012, 3205, 3379, 4996, 3277, 3341, 3410, 3526, 3692, 4050,
+                2701, 2783, 2834, 3026, 3224, 3408, 3594, 5360, 3567, 3630, 3755, 3925, 4157,
+                2865, 2942, 3029, 3083, 3269, 3469, 3674, 3883, 5761, 3905, 4014, 4185, 4426,
+                3037, 3111, 3182, 3270, 3336, 3541, 3742, 3948, 4188, 6118, 4134, 4317, 4550,
+                3243, 3323, 3405, 3482, 3568, 3648, 3857, 4060, 4315, 4413, 6495, 4444, 4684,
+                3494, 3574, 3652, 3744, 3822, 3922, 4018, 4235, 4478, 4578, 4706, 6888, 4822,
+                3875, 3966, 4046, 4146, 4113, 4236, 4350, 4452, 4705, 4823, 4933, 5072, 7337,
+            },
+            { // 3名对手
+                2189, 1401, 1480, 1545, 1457, 1424, 1523, 1605, 1733, 1858, 2017, 2213, 2543,
+                1822, 2398, 1649, 1713, 1640, 1593, 1566, 1672, 1807, 1929, 2078, 2278, 2632,
+                1887, 2040, 2622, 1886, 1827, 1781, 1747, 1734, 1876, 1992, 2157, 2353, 2708,
+                1954, 2116, 2267, 2891, 1997, 1959, 1932, 1907, 1933, 2079, 2234, 2442, 2794,
+                1887, 2049, 2211, 2378, 3155, 2139, 2126, 2106, 2117, 2131, 2307, 2526, 2744,
+                1849, 2015, 2175, 2347, 2512, 3430, 2304, 2300, 2312, 2335, 2406, 2617, 2879,
+                1940, 1985, 2143, 2327, 2483, 2670, 3767, 2499, 2541, 2560, 2611, 2717, 2999,
+                2026, 2088, 2134, 2301, 2484, 2664, 2844, 4118, 2764, 2788, 2841, 2948, 3107,
+                2145, 2218, 2277, 2319, 2506, 2688, 2894, 3086, 4518, 3065, 3132, 3236, 3408,
+                2270, 2339, 2396, 2468, 2524, 2704, 2914, 3127, 3384, 4920, 3247, 3370, 3534,
+                2425, 2485, 2554, 2627, 2704, 2772, 2977, 3178, 3455, 3567, 5346, 3517, 3682,
+                2615, 2680, 2753, 2820, 2907, 2994, 3076, 3291, 3564, 3679, 3820, 5821, 3858,
+                2944, 3024, 3103, 3169, 3128, 3243, 3352, 3452, 3717, 3852, 3979, 4140, 6380,
+            },
+            { // 4名对手
+                1771, 1087, 1150, 1207, 1132, 1067, 1146, 1214, 1329, 1423, 1540, 1702, 1989,
+                1506, 1904, 1286, 1361, 1291, 1224, 1189, 1271, 1372, 1474, 1594, 1758, 2063,
+                1563, 1688, 2055, 1502, 1438, 1394, 1342, 1318, 1445, 1531, 1657, 1821, 2132,
+                1618, 1760, 1893, 2247, 1592, 1553, 1501, 1475, 1485, 1589, 1721, 1887, 2199,
+                1534, 1694, 1836, 1971, 2447, 1700, 1676, 1644, 1643, 1642, 1789, 1956, 2147,
+                1506, 1630, 1782, 1930, 2071, 2677, 1843, 1826, 1839, 1825, 1851, 2048, 2251,
+                1559, 1604, 1748, 1905, 2056, 2217, 2949, 2008, 2038, 2029, 2057, 2129, 2349,
+                1646, 1689, 1729, 1878, 2042, 2204, 2357, 3262, 2249, 2243, 2285, 2351, 2462,
+                1747, 1797, 1841, 1887, 2048, 2205, 2404, 2585, 3631, 2532, 2573, 2639, 2750,
+                1848, 1893, 1940, 1995, 2049, 2217, 2399, 2600, 2866, 4016, 2701, 2773, 2883,
+                1974, 2023, 2071, 2116, 2189, 2258, 2436, 2639, 2901, 3018, 4476, 2923, 3055,
+                2139, 2187, 2235, 2294, 2355, 2433, 2520, 2729, 2979, 3114, 3245, 4975, 3229,
+                2409, 2469, 2537, 2601, 2543, 2635, 2729, 2824, 3099, 3227, 3371, 3541, 5591,
+            },
+            { // 5名对手
+                1547, 896, 960, 1008, 909, 858, 924, 975, 1057, 1136, 1250, 1380, 1629,
+                1310, 1620, 1076, 1139, 1056, 996, 948, 1013, 1107, 1183, 1289, 1432, 1696,
+                1366, 1474, 1733, 1262, 1198, 1139, 1087, 1050, 1148, 1228, 1340, 1482, 1747,
+                1406, 1532, 1647, 1850, 1319, 1291, 1239, 1190, 1190, 1281, 1391, 1526, 1799,
+                1328, 1463, 1590, 1693, 2008, 1412, 1385, 1344, 1341, 1323, 1439, 1585, 1745,
+                1279, 1398, 1532, 1665, 1780, 2187, 1531, 1511, 1512, 1476, 1504, 1657, 1835,
+                1328, 1363, 1486, 1629, 1762, 1904, 2411, 1672, 1705, 1674, 1690, 1740, 1924,
+                1383, 1425, 1465, 1600, 1736, 1875, 2022, 2665, 1886, 1874, 1888, 1938, 2026,
+                1483, 1524, 1559, 1590, 1735, 1893, 2064, 2238, 2999, 2150, 2170, 2231, 2318,
+                1571, 1598, 1648, 1696, 1741, 1873, 2044, 2238, 2477, 3361, 2293, 2348, 2429,
+                1677, 1718, 1763, 1800, 1846, 1902, 2068, 2254, 2525, 2621, 3784, 2507, 2594,
+                1815, 1857, 1904, 1948, 2000, 2072, 2138, 2317, 2579, 2693, 2827, 4295, 2795,
+                2064, 2117, 2169, 2209, 2170, 2249, 2329, 2416, 2665, 2796, 2931, 3118, 4922,
+            },
+            { // 6名对手
+                1406, 773, 827, 855, 780, 714, 753, 801, 872, 951, 1051, 1156, 1377,
+                1174, 1459, 928, 988, 907, 841, 795, 833, 915, 989, 1076, 1202, 1430,
+                1217, 1319, 1519, 1096, 1040, 969, 908, 868, 947, 1026, 1113, 1234, 1477,
+                1247, 1372, 1483, 1614, 1144, 1097, 1043, 992, 988, 1056, 1152, 1274, 1528,
+                1169, 1299, 1422, 1521, 1727, 1215, 1172, 1134, 1119, 1092, 1196, 1323, 1450,
+                1126, 1240, 1359, 1481, 1582, 1858, 1301, 1288, 1263, 1249, 1259, 1381, 1536,
+                1173, 1193, 1304, 1436, 1558, 1666, 2028, 1418, 1436, 1413, 1406, 1462, 1619,
+                1221, 1241, 1264, 1390, 1521, 1668, 1779, 2251, 1614, 1593, 1605, 1639, 1705,
+                1304, 1337, 1359, 1390, 1515, 1652, 1804, 1974, 2519, 1859, 1866, 1919, 1970,
+                1375, 1411, 1438, 1474, 1504, 1647, 1792, 1963, 2191, 2868, 1980, 2038, 2102,
+                1475, 1504, 1538, 1570, 1616, 1658, 1815, 1977, 2227, 2318, 3255, 2168, 2243,
+                1606, 1627, 1671, 1706, 1746, 1803, 1861, 2029, 2282, 2381, 2515, 3752, 2443,
+                1817, 1869, 1897, 1949, 1887, 1955, 2028, 2099, 2342, 2454, 2602, 2775, 4355,
+            },
+            { // 7名对手
+                1328, 685, 735, 755, 677, 617, 641, 677, 751, 812, 892, 997, 1188,
+                1069, 1357, 819, 889, 792, 731, 666, 711, 775, 833, 917, 1022, 1227,
+                1111, 1209, 1382, 980, 914, 842, 782, 730, 808, 860, 944, 1054, 1274,
+                1144, 1265, 1346, 1445, 1015, 968, 907, 847, 835, 895, 968, 1083, 1302,
+                1061, 1180, 1294, 1389, 1544, 1070, 1028, 977, 959, 929, 1023, 1132, 1251,
+                1013, 1118, 1236, 1346, 1443, 1640, 1140, 1113, 1094, 1060, 1069, 1180, 1314,
+                1052, 1075, 1170, 1290, 1408, 1506, 1765, 1234, 1256, 1213, 1208, 1244, 1376,
+                1088, 1112, 1143, 1242, 1363, 1488, 1592, 1934, 1416, 1387, 1375, 1415, 1463,
+                1161, 1188, 1212, 1234, 1353, 1476, 1622, 1763, 2180, 1625, 1632, 1675, 1705,
+                1231, 1259, 1280, 1302, 1334, 1458, 1608, 1742, 1972, 2461, 1726, 1772, 1829,
+                1311, 1338, 1368, 1397, 1422, 1464, 1612, 1765, 1990, 2075, 2826, 1912, 1969,
+                1435, 1455, 1487, 1507, 1548, 1601, 1657, 1811, 2040, 2139, 2258, 3296, 2152,
+                1632, 1677, 1711, 1740, 1680, 1736, 1790, 1873, 2092, 2197, 2329, 2488, 3868,
+            },
+            { // 8名对手
+                1246, 615, 652, 691, 609, 542, 559, 579, 651, 702, 774, 872, 1032,
+                988, 1267, 754, 795, 704, 639, 574, 618, 675, 724, 790, 890, 1089,
+                1025, 1115, 1290, 895, 825, 755, 682, 644, 698, 747, 817, 914, 1114,
+                1060, 1160, 1242, 1321, 913, 878, 798, 738, 730, 774, 842, 949, 1150,
+                971, 1086, 1188, 1279, 1401, 964, 918, 866, 831, 801, 867, 970, 1080,
+                926, 1021, 1125, 1235, 1318, 1479, 1022, 981, 955, 924, 914, 1018, 1136,
+                950, 972, 1065, 1177, 1285, 1380, 1593, 1099, 1111, 1062, 1055, 1074, 1193,
+                985, 1000, 1030, 1128, 1233, 1353, 1452, 1716, 1257, 1218, 1205, 1224, 1275,
+                1061, 1078, 1094, 1130, 1228, 1349, 1476, 1616, 1911, 1450, 1447, 1471, 1513,
+                1118, 1137, 1156, 1176, 1204, 1318, 1450, 1585, 1809, 2165, 1531, 1569, 1618,
+                1201, 1218, 1228, 1257, 1298, 1326, 1442, 1594, 1800, 1884, 2494, 1690, 1744,
+                1303, 1321, 1350, 1366, 1388, 1440, 1483, 1630, 1852, 1933, 2047, 2922, 1921,
+                1483, 1523, 1538, 1578, 1525, 1563, 1621, 1685, 1907, 1999, 2104, 2263, 3469,
+            },
+            { // 9名对手
+                1194, 557, 600, 631, 543, 479, 497, 514, 570, 620, 684, 769, 915,
+                915, 1215, 686, 730, 648, 570, 520, 534, 589, 645, 693, 790, 964,
+                953, 1044, 1216, 816, 755, 676, 608, 559, 607, 658, 709, 800, 988,
+                991, 1083, 1165, 1236, 844, 795, 725, 657, 636, 672, 738, 814, 1008,
+                904, 1008, 1115, 1191, 1305, 866, 837, 781, 733, 700, 768, 853, 965,
+                858, 943, 1045, 1154, 1236, 1369, 920, 877, 850, 814, 801, 902, 991,
+                879, 891, 989, 1087, 1201, 1275, 1453, 976, 991, 944, 926, 950, 1047,
+                916, 920, 944, 1033, 1137, 1250, 1346, 1559, 1140, 1099, 1070, 1090, 1114,
+                977, 994, 1006, 1028, 1113, 1235, 1350, 1484, 1708, 1308, 1292, 1306, 1338,
+                1027, 1040, 1053, 1079, 1099, 1203, 1319, 1459, 1656, 1928, 1369, 1399, 1429,
+                1099, 1121, 1129, 1153, 1167, 1210, 1318, 1457, 1661, 1719, 2228, 1509, 1559,
+                1193, 1216, 1229, 1252, 1278, 1317, 1351, 1483, 1688, 1762, 1861, 2607, 1724,
+                1352, 1396, 1425, 1450, 1395, 1432, 1475, 1533, 1732, 1811, 1920, 2073, 3104,
+            },
+            { // 10名对手
+                1146, 515, 561, 578, 481, 435, 437, 476, 518, 554, 606, 685, 827,
+                856, 1151, 638, 687, 595, 519, 464, 476, 524, 569, 614, 699, 862,
+                897, 973, 1154, 755, 700, 625, 552, 498, 545, 578, 629, 699, 880,
+                922, 1017, 1093, 1165, 776, 729, 657, 587, 572, 603, 651, 724, 910,
+                845, 936, 1039, 1115, 1227, 814, 756, 687, 656, 626, 673, 748, 856,
+                800, 876, 970, 1076, 1137, 1276, 845, 804, 782, 720, 703, 783, 882,
+                809, 822, 906, 1010, 1107, 1189, 1343, 900, 891, 839, 812, 831, 918,
+                851, 851, 866, 955, 1059, 1155, 1250, 1436, 1028, 981, 955, 967, 994,
+                911, 907, 932, 950, 1033, 1139, 1249, 1387, 1558, 1182, 1165, 1171, 1196,
+                950, 964, 978, 992, 1010, 1108, 1227, 1348, 1532, 1750, 1231, 1252, 1274,
+                1020, 1033, 1045, 1059, 1079, 1115, 1204, 1343, 1538, 1585, 2007, 1363, 1395,
+                1108, 1122, 1131, 1159, 1180, 1208, 1250, 1366, 1555, 1622, 1711, 2349, 1555,
+                1262, 1291, 1311, 1331, 1287, 1318, 1358, 1416, 1602, 1673, 1767, 1890, 2802,
+            },
+            { // 11名对手
+                1108, 472, 517, 536, 445, 391, 394, 414, 465, 501, 545, 616, 739,
+                793, 1093, 592, 638, 554, 466, 410, 429, 475, 513, 560, 620, 775,
+                844, 914, 1103, 709, 645, 570, 503, 451, 488, 519, 569, 640, 787,
+                867, 955, 1026, 1108, 724, 677, 603, 546, 505, 533, 584, 646, 816,
+                785, 885, 973, 1051, 1154, 745, 708, 629, 602, 556, 601, 672, 763,
+                741, 816, 913, 1009, 1082, 1200, 790, 738, 707, 649, 635, 708, 791,
+                754, 777, 851, 943, 1030, 1117, 1257, 825, 824, 767, 738, 748, 832,
+                794, 802, 809, 890, 993, 1086, 1169, 1341, 947, 893, 864, 865, 883,
+                844, 847, 869, 879, 958, 1068, 1187, 1297, 1443, 1094, 1067, 1065, 1074,
+                892, 904, 907, 922, 949, 1030, 1147, 1256, 1440, 1594, 1116, 1134, 1148,
+                950, 961, 966, 989, 1002, 1030, 1127, 1255, 1428, 1474, 1834, 1224, 1258,
+                1038, 1046, 1063, 1074, 1094, 1126, 1159, 1274, 1449, 1507, 1582, 2130, 1400,
+                1183, 1208, 1230, 1247, 1197, 1229, 1261, 1312, 1484, 1543, 1632, 1755, 2541,
+            },
+            { // 12名对手
+                1053, 434, 479, 499, 416, 349, 364, 373, 417, 457, 495, 561, 679,
+                755, 1056, 547, 586, 518, 435, 385, 387, 426, 463, 500, 565, 699,
+                789, 867, 1061, 671, 604, 534, 465, 410, 441, 467, 512, 577, 737,
+                814, 910, 971, 1061, 674, 625, 556, 484, 458, 486, 529, 595, 743,
+                739, 837, 932, 992, 1112, 703, 656, 591, 547, 504, 550, 613, 688,
+                687, 770, 863, 957, 1021, 1146, 724, 689, 647, 595, 569, 639, 717,
+                707, 717, 800, 893, 980, 1049, 1198, 769, 762, 699, 664, 680, 747,
+                734, 747, 757, 837, 925, 1024, 1099, 1258, 876, 834, 790, 786, 796,
+                793, 793, 801, 817, 899, 1002, 1103, 1211, 1340, 1017, 980, 972, 990,
+                829, 852, 854, 859, 885, 968, 1066, 1172, 1359, 1475, 1030, 1028, 1045,
+                893, 893, 914, 924, 937, 957, 1057, 1168, 1336, 1392, 1682, 1106, 1138,
+                974, 979, 991, 1010, 1022, 1045, 1081, 1180, 1360, 1408, 1479, 1964, 1266,
+                1106, 1137, 1159, 1172, 1129, 1141, 1174, 1220, 1385, 1442, 1516, 1632, 2324,
+            },
+            { // 13名对手
+                1018, 405, 446, 466, 376, 327, 327, 343, 382, 415, 451, 502, 615,
+                719, 1015, 512, 552, 468, 403, 349, 348, 390, 418, 451, 518, 643,
+                747, 800, 1024, 623, 553, 496, 427, 371, 402, 426, 459, 533, 663,
+                768, 868, 918, 1016, 640, 594, 525, 451, 413, 438, 472, 542, 681,
+                697, 788, 880, 943, 1059, 665, 611, 541, 494, 459, 497, 553, 630,
+                644, 729, 804, 899, 968, 1104, 680, 636, 597, 544, 526, 576, 654,
+                655, 674, 739, 840, 927, 998, 1143, 717, 713, 652, 607, 611, 676,
+                694, 700, 716, 780, 877, 980, 1042, 1193, 819, 763, 717, 709, 729,
+                733, 750, 752, 769, 854, 948, 1051, 1150, 1266, 937, 904, 893, 893,
+                787, 794, 806, 815, 832, 914, 1011, 1123, 1274, 1390, 952, 943, 949,
+                836, 843, 860, 872, 886, 903, 980, 1095, 1266, 1299, 1560, 1028, 1039,
+                917, 923, 935, 944, 963, 990, 1015, 1113, 1271, 1322, 1383, 1811, 1158,
+                1050, 1072, 1099, 1116, 1063, 1075, 1115, 1148, 1295, 1357, 1422, 1513, 2133,
+            },
+            { // 14名对手
+                982, 367, 404, 432, 347, 294, 301, 315, 346, 380, 412, 461, 566,
+                657, 973, 482, 526, 435, 371, 312, 324, 359, 378, 425, 472, 606,
+                704, 773, 980, 585, 528, 471, 395, 337, 368, 397, 430, 478, 612,
+                732, 813, 876, 977, 603, 554, 477, 413, 378, 402, 432, 487, 619,
+                651, 742, 823, 898, 1030, 617, 576, 500, 459, 416, 447, 511, 587,
+                610, 677, 765, 866, 909, 1064, 646, 598, 558, 498, 465, 533, 589,
+                626, 633, 711, 792, 889, 941, 1091, 672, 667, 593, 559, 566, 624,
+                652, 655, 666, 742, 830, 923, 992, 1138, 774, 709, 666, 654, 661,
+                698, 711, 712, 725, 808, 899, 1001, 1097, 1192, 880, 839, 835, 817,
+                736, 743, 765, 773, 784, 856, 958, 1058, 1217, 1314, 875, 869, 872,
+                793, 805, 810, 821, 830, 855, 935, 1045, 1199, 1234, 1470, 945, 947,
+                876, 880, 888, 900, 902, 928, 967, 1056, 1196, 1239, 1289, 1675, 1046,
+                998, 1011, 1029, 1059, 1014, 1020, 1039, 1088, 1232, 1275, 1341, 1417, 1964,
+            },
+            { // 15名对手
+                941, 341, 386, 402, 319, 275, 274, 292, 322, 349, 380, 434, 527,
+                623, 938, 442, 495, 420, 343, 287, 296, 335, 348, 383, 428, 542,
+                665, 726, 932, 553, 504, 442, 350, 312, 336, 353, 389, 448, 568,
+                688, 770, 837, 945, 564, 527, 438, 380, 344, 367, 399, 448, 579,
+                610, 706, 793, 851, 994, 578, 539, 479, 424, 380, 417, 472, 540,
+                581, 649, 732, 809, 876, 1018, 609, 559, 523, 449, 429, 482, 545,
+                580, 599, 669, 757, 848, 907, 1057, 637, 619, 559, 520, 516, 576,
+                615, 615, 635, 704, 793, 874, 942, 1092, 726, 664, 626, 604, 615,
+                663, 663, 675, 694, 763, 858, 957, 1050, 1136, 842, 781, 768, 762,
+                700, 715, 722, 717, 744, 824, 908, 1006, 1160, 1241, 824, 801, 814,
+                764, 768, 768, 777, 789, 820, 889, 987, 1140, 1169, 1372, 865, 869,
+                829, 832, 837, 857, 860, 884, 910, 991, 1156, 1184, 1224, 1580, 971,
+                945, 977, 988, 1001, 960, 971, 997, 1033, 1173, 1200, 1257, 1337, 1816,
+            },
+            { // 16名对手
+                911, 313, 365, 380, 296, 247, 262, 266, 297, 321, 345, 405, 494,
+                590, 908, 426, 459, 389, 324, 263, 270, 305, 320, 353, 401, 522,
+                634, 688, 907, 525, 476, 410, 342, 280, 303, 329, 363, 408, 534,
+                642, 734, 797, 907, 543, 488, 424, 355, 322, 339, 370, 411, 543,
+                575, 666, 755, 812, 962, 551, 515, 450, 398, 347, 374, 427, 491,
+                536, 610, 688, 778, 835, 986, 572, 542, 486, 426, 406, 450, 518,
+                553, 568, 627, 716, 800, 866, 1021, 592, 591, 527, 478, 471, 527,
+                582, 589, 602, 662, 747, 849, 908, 1045, 687, 623, 583, 558, 560,
+                625, 629, 640, 641, 726, 811, 908, 999, 1096, 795, 750, 722, 703,
+                668, 669, 684, 690, 704, 775, 860, 968, 1123, 1184, 773, 759, 741,
+                722, 728, 733, 743, 752, 761, 847, 942, 1093, 1110, 1302, 804, 804,
+                789, 793, 809, 811, 832, 842, 870, 956, 1090, 1129, 1167, 1479, 898,
+                915, 931, 954, 957, 923, 937, 942, 984, 1105, 1157, 1189, 1261, 1693,
+            },
+            { // 17名对手
+                883, 301, 336, 354, 286, 234, 229, 241, 274, 292, 327, 369, 466,
+                560, 869, 396, 442, 370, 296, 249, 255, 274, 298, 325, 371, 480,
+                594, 652, 879, 498, 451, 380, 313, 260, 295, 295, 339, 381, 498,
+                612, 687, 750, 883, 524, 467, 396, 335, 298, 306, 346, 384, 516,
+                542, 638, 716, 769, 933, 527, 487, 422, 376, 331, 362, 396, 471,
+                503, 571, 652, 732, 799, 955, 551, 501, 457, 404, 369, 417, 471,
+                519, 524, 608, 682, 771, 829, 992, 566, 550, 491, 449, 437, 504,
+                539, 552, 559, 633, 712, 797, 858, 1014, 653, 595, 537, 520, 534,
+                600, 595, 607, 619, 681, 775, 871, 963, 1056, 752, 699, 675, 661,
+                635, 643, 653, 654, 669, 746, 834, 920, 1070, 1128, 729, 705, 699,
+                692, 697, 692, 704, 720, 737, 807, 894, 1051, 1067, 1250, 754, 754,
+                763, 772, 769, 778, 795, 811, 841, 910, 1044, 1077, 1104, 1400, 826,
+                873, 900, 919, 922, 887, 890, 915, 943, 1057, 1105, 1137, 1201, 1598,
+            },
+            { // 18名对手
+                849, 275, 315, 337, 262, 214, 211, 233, 252, 267, 304, 346, 436,
+                527, 856, 379, 411, 349, 275, 222, 229, 257, 279, 301, 351, 451,
+                553, 627, 852, 476, 429, 361, 297, 243, 266, 276, 313, 353, 471,
+                584, 663, 723, 848, 488, 437, 374, 306, 268, 285, 316, 355, 476,
+                522, 607, 684, 741, 899, 509, 464, 398, 341, 307, 328, 370, 439,
+                472, 544, 628, 707, 755, 920, 516, 470, 430, 371, 351, 390, 446,
+                499, 497, 571, 650, 736, 786, 962, 534, 535, 465, 421, 409, 458,
+                518, 532, 519, 600, 687, 760, 826, 987, 626, 571, 503, 483, 489,
+                565, 565, 578, 579, 653, 744, 827, 927, 1013, 726, 662, 637, 622,
+                603, 612, 618, 635, 633, 704, 793, 882, 1040, 1086, 690, 669, 649,
+                664, 671, 673, 680, 689, 706, 785, 861, 1004, 1019, 1185, 703, 699,
+                732, 743, 739, 753, 765, 775, 797, 864, 1010, 1030, 1068, 1329, 770,
+                853, 871, 887, 884, 856, 859, 875, 909, 1020, 1056, 1094, 1136, 1507,
+            },
+            { // 19名对手
+                815, 264, 303, 317, 250, 186, 204, 213, 232, 249, 290, 326, 411,
+                494, 820, 352, 399, 324, 269, 209, 215, 242, 256, 291, 331, 431,
+                527, 591, 822, 456, 411, 348, 277, 229, 236, 268, 297, 330, 441,
+                566, 630, 681, 828, 458, 420, 351, 290, 262, 262, 294, 343, 446,
+                498, 567, 645, 713, 871, 471, 439, 374, 318, 282, 311, 344, 413,
+                455, 521, 590, 678, 723, 904, 502, 450, 405, 352, 330, 367, 420,
+                474, 475, 551, 623, 695, 760, 924, 513, 506, 443, 393, 379, 434,
+                492, 497, 512, 578, 650, 723, 789, 959, 596, 529, 482, 452, 466,
+                535, 538, 547, 560, 628, 712, 795, 894, 978, 683, 631, 591, 580,
+                586, 581, 584, 591, 613, 679, 765, 843, 992, 1043, 659, 621, 619,
+                635, 644, 640, 646, 655, 681, 751, 833, 978, 988, 1141, 663, 659,
+                704, 714, 715, 715, 729, 747, 762, 843, 976, 987, 1016, 1275, 721,
+                822, 845, 855, 855, 823, 840, 859, 875, 981, 1009, 1043, 1088, 1420,
+            },
+            { // 20名对手
+                796, 246, 275, 294, 225, 181, 189, 197, 218, 232, 268, 300, 387,
+                470, 797, 329, 374, 299, 243, 199, 200, 225, 246, 262, 304, 413,
+                511, 565, 795, 433, 386, 330, 269, 212, 235, 244, 281, 307, 426,
+                522, 606, 664, 785, 441, 405, 335, 270, 241, 253, 267, 315, 435,
+                462, 539, 614, 673, 850, 459, 415, 356, 311, 261, 287, 327, 390,
+                433, 499, 571, 647, 696, 884, 472, 436, 391, 336, 303, 337, 395,
+                441, 454, 519, 598, 671, 728, 899, 496, 480, 425, 373, 361, 415,
+                472, 473, 481, 542, 624, 702, 764, 928, 572, 509, 454, 434, 436,
+                523, 522, 530, 530, 600, 676, 765, 854, 951, 662, 604, 581, 559,
+                557, 557, 553, 565, 576, 647, 731, 819, 959, 1010, 624, 597, 585,
+                606, 617, 613, 626, 639, 654, 716, 806, 941, 949, 1104, 628, 626,
+                677, 679, 690, 692, 696, 721, 734, 796, 933, 944, 983, 1223, 684,
+                796, 810, 832, 833, 800, 799, 826, 842, 950, 979, 1009, 1043, 1364,
+            },
+            { // 21名对手
+                776, 233, 271, 288, 218, 168, 177, 185, 202, 224, 246, 286, 370,
+                440, 767, 317, 358, 293, 222, 181, 179, 208, 219, 247, 293, 396,
+                483, 542, 778, 413, 370, 312, 241, 201, 208, 225, 245, 297, 411,
+                497, 575, 628, 766, 421, 378, 318, 266, 222, 238, 254, 295, 403,
+                439, 522, 587, 647, 824, 432, 389, 333, 293, 252, 263, 301, 370,
+                403, 464, 533, 610, 670, 839, 451, 412, 367, 317, 282, 325, 385,
+                412, 425, 483, 568, 630, 702, 877, 472, 456, 393, 352, 340, 394,
+                444, 452, 454, 518, 601, 671, 742, 897, 545, 482, 440, 405, 419,
+                490, 493, 496, 505, 568, 650, 734, 825, 926, 630, 588, 540, 531,
+                530, 538, 545, 537, 553, 632, 700, 798, 927, 988, 598, 572, 553,
+                584, 594, 592, 606, 613, 618, 691, 772, 906, 924, 1062, 594, 589,
+                665, 666, 661, 666, 677, 691, 712, 774, 901, 929, 948, 1175, 644,
+                771, 793, 796, 803, 771, 787, 797, 818, 923, 947, 976, 1000, 1319,
+            },
+        };
+    }
+
+    // 查询翻牌前胜率（万分比）
+    // 参数:
+    //   index - 起手牌类别索引
+    //   opponents - 对手人数，超出1-21时取最近的边界
+    constexpr int equityBasisPoints(int index, int opponents) {
+        return detail::EQUITY[(opponents < 1 ? 1 : opponents > MAX_OPPONENTS ? MAX_OPPONENTS : opponents) - 1][index];
+    }
+
+    // 查询两张底牌面对若干随机对手的翻牌前胜率
+    // 参数:
+    //   a, b - 两张底牌
+    //   opponents - 对手人数
+    // 返回值: 期望分得的底池比例（0-1）
+    inline double equity(const Card& a, const Card& b, int opponents) {
+        return equityBasisPoints(classIndex(a, b), opponents) / 10000.0;
+    }
+}
+
+// 工作窃取线程池 - 每个线程有自己的任务队列，自己的队列空了就从其他队列尾部窃取
+// run() 把一批任务分散到各队列，调用线程也参与执行，全部完成后返回；
+// 队列各自加锁，线程之间只在一批任务开始和结束时同步一次
+class WorkStealingPool {
+private:
+    // 单个线程的任务队列，按缓存行对齐避免伪共享
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;   // 每个线程一个队列（0号属于调用线程）
+    std::vector<std::thread> workers;              // 后台线程
+    std::mutex controlMutex;                       // 保护下面的批次状态
+    std::condition_variable startSignal;           // 新批次开始
+    std::condition_variable doneSignal;            // 后台线程完成当前批次
+    const std::function<void(size_t)>* task;       // 当前批次的任务函数
+    std::uint64_t generation;                      // 批次编号
+    int busyWorkers;                               // 尚未完成当前批次的后台线程数
+    bool stopping;                                 // 线程池正在销毁
+
+    // 取出一个任务：先取自己队列的头部，再依次窃取其他队列的尾部
+    bool pop(size_t self, size_t& item) {
+        for (size_t k = 0; k < queues.size(); k++) {
+            Queue& queue = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.items.empty()) continue;
+            if (k == 0) {
+                item = queue.items.front();
+                queue.items.pop_front();
+            } else {
+                item = queue.items.back();
+                queue.items.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // 当前线程在线程池中的编号
+    static size_t& currentIndex() {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    // 执行任务直到所有队列都为空
+    void drain(size_t self) {
+        currentIndex() = self;
+        size_t item;
+        while (pop(self, item)) (*task)(item);
+    }
+
+    void workerLoop(size_t self) {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(controlMutex);
+                startSignal.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            drain(self);
+            std::lock_guard<std::mutex> lock(controlMutex);
+            if (--busyWorkers == 0) doneSignal.notify_one();
+        }
+    }
+
+public:
+    // 构造函数
+    // 参数: threads - 线程总数（包括调用线程），0表示使用硬件线程数
+    explicit WorkStealingPool(int threads) 
+        : task(nullptr), generation(0), busyWorkers(0), stopping(false) {
+        int count = Equity::detail::threadCount(threads);
+        for (int i = 0; i < count; i++) queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        for (int i = 1; i < count; i++) workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(controlMutex);
+            stopping = true;
+        }
+        startSignal.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // 线程总数
+    int size() const {
+        return static_cast<int>(queues.size());
+    }
+
+    // 正在执行任务的线程的编号（0 到 size() - 1，调用线程为0），可用来访问按线程划分的数据
+    static size_t threadIndex() {
+        return currentIndex();
+    }
+
+    // 并行执行 fn(0) ... fn(count-1)，全部完成后返回
+    // 参数:
+    //   count - 任务数量
+    //   fn - 任务函数，不同任务可能同时在不同线程上执行
+    void run(size_t count, const std::function<void(size_t)>& fn) {
+        for (size_t i = 0; i < count; i++) {
+            Queue& queue = *queues[i % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.items.push_back(i);
+        }
+        {
+            std::lock_guard<std::mutex> lock(controlMutex);
+            task = &fn;
+            busyWorkers = static_cast<int>(workers.size());
+            generation++;
+        }
+        startSignal.notify_all();
+        drain(0);
+        std::unique_lock<std::mutex> lock(controlMutex);
+        doneSignal.wait(lock, [&] { return busyWorkers == 0; });
+        task = nullptr;
+    }
+};
+
+// 范围对范围胜率 - 双方各是一组底牌组合（例如 "QQ+,AKs"），一次算出每对组合之间的胜率矩阵
+// 所有组合共用同一组牌面：每个牌面只给每个组合评估一次牌力，之后逐对比较牌力值，
+// 组合之间、组合与牌面之间的冲突都用 CardSet 掩码判断。
+// 还差不超过两张公共牌时精确枚举所有牌面，否则所有组合共用同一组随机抽样的牌面（每批现抽，不预先保存）。
+// 牌面按批处理，每批分两步交给线程池：先按牌面分块评估每个组合的牌力，再按己方组合分组累计到同一个矩阵，
+// 矩阵的每一格只由一个任务写入，内存只有一份矩阵加一批牌力（计数都是整数，结果与线程数无关）
+namespace RangeEquity {
+    const int MAX_EXACT_MISSING = 2;        // 还差几张公共牌以内时精确枚举
+    const size_t RUNOUT_CHUNK = 16;         // 评估时每个任务处理的牌面数
+    const size_t RUNOUT_BATCH = 512;        // 每批评估并累计的牌面数
+    const size_t ROW_GROUP = 16;            // 累计时每个任务负责的己方组合数
+    const long long MAX_SAMPLES = 1LL << 30;    // 抽样牌面数上限：每对组合的得分（每个牌面最多2分）要放进32位计数
+
+    // 计算参数
+    struct Options {
+        int threads = 0;                    // 线程数，0表示使用全部核心
+        long long samples = 20000;          // 抽样时的牌面数（超过 MAX_SAMPLES 时按 MAX_SAMPLES 计算）
+        std::uint64_t seed = 0;             // 抽样的随机数种子，0表示使用真随机数
+    };
+
+    // 胜率矩阵
+    struct Matrix {
+        std::vector<CardSet> hero;              // 己方的组合
+        std::vector<CardSet> villain;           // 对方的组合
+        std::vector<std::uint32_t> points;      // [h × villain.size() + v]：每个牌面胜计2分、平计1分
+        std::vector<std::uint32_t> boards;      // 两个组合都能使用的牌面数，两个组合有同一张牌时为0
+        long long runouts = 0;                  // 枚举或抽样的牌面总数，0表示输入无效
+        bool exhaustive = false;                // 是否为精确枚举
+
+        // 一对组合的胜率（己方期望分得的底池比例），没有可用牌面时返回 -1
+        double equity(size_t h, size_t v) const {
+            size_t i = h * villain.size() + v;
+            return boards[i] == 0 ? -1.0 : points[i] / (2.0 * boards[i]);
+        }
+
+        // 己方若干个组合对整个对方范围的胜率（按可用牌面数加权），没有可用牌面时返回 -1
+        // 参数: rows - 己方组合的下标
+        double rowsEquity(const std::vector<size_t>& rows) const {
+            std::uint64_t won = 0, total = 0;
+            for (size_t h : rows) {
+                for (size_t i = h * villain.size(); i < (h + 1) * villain.size(); i++) {
+                    won += points[i];
+                    total += boards[i];
+                }
+            }
+            return total == 0 ? -1.0 : won / (2.0 * total);
+        }
+
+        // 己方整个范围对对方范围的胜率
+        double totalEquity() const {
+            std::vector<size_t> rows(hero.size());
+            for (size_t h = 0; h < rows.size(); h++) rows[h] = h;
+            return rowsEquity(rows);
+        }
+    };
+
+    // 组合的文本形式，大点数在前，例如 "AhKd"
+    inline std::string comboText(CardSet combo) {
+        static const char ranks[] = "23456789TJQKA";
+        static const char suits[] = "hdcs";
+        std::string text;
+        std::uint64_t bits = combo.bits();
+        int cards[2] = {countTrailingZeros(bits), countTrailingZeros(bits & (bits - 1))};
+        if (cards[0] % 13 < cards[1] % 13) std::swap(cards[0], cards[1]);
+        for (int card : cards) {
+            text += ranks[card % 13];
+            text += suits[card / 13];
+        }
+        return text;
+    }
+
+    namespace detail {
+        // 加入一个组合（已有的组合跳过）
+        // 参数:
+        //   a, b - 两张牌的编号
+        //   seen - 已加入组合的标记，seen[较小编号] 的第（较大编号）位
+        //   combos - 结果
+        inline void addCombo(int a, int b, std::uint64_t* seen, std::vector<CardSet>& combos) {
+            if (a == b) return;
+            if (a > b) std::swap(a, b);
+            if ((seen[a] >> b) & 1) return;
+            seen[a] |= std::uint64_t(1) << b;
+            combos.push_back(CardSet((std::uint64_t(1) << a) | (std::uint64_t(1) << b)));
+        }
+
+        // 加入一个起手牌类别的所有组合
+        // 参数:
+        //   high, low - 两张牌的点数（2-14）
+        //   suited - 1 只要同花，-1 只要不同花，0 都要（对子忽略）
+        inline void addClass(int high, int low, int suited, std::uint64_t* seen, std::vector<CardSet>& combos) {
+            for (int s = 0; s < 4; s++) {
+                for (int t = 0; t < 4; t++) {
+                    if (high == low ? t <= s : (suited > 0 && s != t) || (suited < 0 && s == t)) continue;
+                    addCombo(s * 13 + high - 2, t * 13 + low - 2, seen, combos);
+                }
+            }
+        }
+
+        // 行累加的实现，见 accumulateRow
+        using RowKernel = void (*)(std::uint64_t* row, const std::uint32_t* villainValues, size_t blocks, std::uint32_t hero);
+
+        const size_t ROW_BLOCK = 8;
+
+        // 把己方一个组合在一个牌面上对所有对方组合的结果累加到矩阵的一行
+        // 每对组合的得分和牌面数合在一个64位计数里（高32位为得分，低32位为牌面数），对方牌力为0（与牌面冲突）的不计；
+        // 行宽补齐到 ROW_BLOCK 的整数倍，循环没有余数也没有分支，编译器可以直接向量化。
+        // 总是内联，下面的两个实现各自按自己的目标指令集编译这段循环
+        // 参数:
+        //   row - 矩阵的一行
+        //   villainValues - 对方每个组合在本牌面的牌力值（补齐部分为0）
+        //   blocks - 行宽 / ROW_BLOCK
+        //   hero - 己方组合的牌力值
+        static inline __attribute__((always_inline))
+        void accumulateRow(std::uint64_t* row, const std::uint32_t* villainValues, size_t blocks, std::uint32_t hero) {
+            for (size_t b = 0; b < blocks; b++) {
+                for (size_t k = 0; k < ROW_BLOCK; k++) {
+                    std::uint32_t villain = villainValues[b * ROW_BLOCK + k];
+                    std::uint64_t score = (hero > villain) * 2u + (hero == villain);
+                    std::uint64_t live = 0 - static_cast<std::uint64_t>(villain != 0);
+                    row[b * ROW_BLOCK + k] += live & ((score << 32) | 1);
+                }
+            }
+        }
+
+        inline void accumulateRowPortable(std::uint64_t* row, const std::uint32_t* villainValues, size_t blocks, std::uint32_t hero) {
+            accumulateRow(row, villainValues, blocks, hero);
+        }
+
+#if HAND_EVALUATOR_X86_SIMD
+        // 同样的代码按 AVX2 编译，每条指令处理4个计数
+        __attribute__((target("avx2")))
+        inline void accumulateRowAvx2(std::uint64_t* row, const std::uint32_t* villainValues, size_t blocks, std::uint32_t hero) {
+            accumulateRow(row, villainValues, blocks, hero);
+        }
+#endif
+
+        // 运行时按CPU选择行累加的实现
+        inline RowKernel rowKernel() {
+            static const RowKernel kernel = [] {
+#if HAND_EVALUATOR_X86_SIMD
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2")) return static_cast<RowKernel>(accumulateRowAvx2);
+#endif
+                return static_cast<RowKernel>(accumulateRowPortable);
+            }();
+            return kernel;
+        }
+
+        // 一批牌面上每个组合的牌力：对方按组合顺序排成一行（补齐部分为0），己方单独一行
+        struct Batch {
+            std::vector<std::uint64_t> runouts;         // 本批的牌面（只是补全的牌）
+            std::vector<std::uint32_t> villainValues;   // [牌面 × stride + v]
+            std::vector<std::uint32_t> heroValues;      // [牌面 × 己方组合数 + h]
+        };
+
+        // 第一步：评估本批第 begin 到 end-1 个牌面上的每个组合，每个组合在每个牌面只评估一次，与牌面冲突的记为0（有效牌力值都大于0）
+        // 参数:
+        //   unique - 双方去重后的组合
+        //   heroSlots, villainSlots - 双方每个组合在 unique 中的下标
+        //   board - 已知公共牌
+        //   batch - 本批的牌面和评估结果
+        //   stride - 对方一行的宽度
+        //   values - 本线程的临时数组（unique.size() 格）
+        inline void evaluateRunouts(const std::vector<CardSet>& unique, const std::vector<int>& heroSlots,
+                                    const std::vector<int>& villainSlots, CardSet board, Batch& batch, size_t stride,
+                                    size_t begin, size_t end, std::vector<HandEvaluator::HandValue>& values) {
+            for (size_t r = begin; r < end; r++) {
+                CardSet full = board | CardSet(batch.runouts[r]);
+                for (size_t u = 0; u < unique.size(); u++) {
+                    values[u] = (unique[u] & full).empty() ? HandEvaluator::evaluateValue(unique[u] | full) : 0;
+                }
+                std::uint32_t* villainRow = batch.villainValues.data() + r * stride;
+                for (size_t v = 0; v < villainSlots.size(); v++) villainRow[v] = values[villainSlots[v]];
+                std::uint32_t* heroRow = batch.heroValues.data() + r * heroSlots.size();
+                for (size_t h = 0; h < heroSlots.size(); h++) heroRow[h] = values[heroSlots[h]];
+            }
+        }
+
+        // 第二步：把本批所有牌面累计到己方第 begin 到 end-1 行；按牌面在外层循环，同一行对方牌力供这一组的所有行使用
+        // 参数:
+        //   batch - 本批的评估结果
+        //   heroCount - 己方组合数
+        //   cells - 矩阵，每行 stride 格
+        //   stride - 行宽（对方组合数补齐到 ROW_BLOCK 的整数倍）
+        inline void accumulateRows(const Batch& batch, size_t heroCount, std::uint64_t* cells, size_t stride,
+                                   size_t begin, size_t end) {
+            RowKernel kernel = rowKernel();
+            for (size_t r = 0; r < batch.runouts.size(); r++) {
+                const std::uint32_t* villainRow = batch.villainValues.data() + r * stride;
+                const std::uint32_t* heroRow = batch.heroValues.data() + r * heroCount;
+                for (size_t h = begin; h < end; h++) {
+                    if (heroRow[h] != 0) kernel(cells + h * stride, villainRow, stride / ROW_BLOCK, heroRow[h]);
+                }
+            }
+        }
+    }
+
+    // 解析范围文本：逗号或空白分隔的若干项，每项可以是
+    //   起手牌类别："AA"、"AKs"（同花）、"AKo"（不同花）、"AK"（两者都要）；
+    //   加号表示提高小的那张："TT+" 为 TT 到 AA，"ATs+" 为 ATs 到 AKs；
+    //   具体的两张牌："AhKd"；
+    //   "all" 或 "*"：全部1326种组合
+    // 参数:
+    //   text - 范围文本
+    //   combos - 解析得到的组合（按出现顺序，重复的只保留一个）
+    // 返回值: 解析成功返回true，有无法识别的项时返回false
+    inline bool parseRange(const std::string& text, std::vector<CardSet>& combos) {
+        static const std::string rankChars = "23456789TJQKA";
+        combos.clear();
+        std::uint64_t seen[52] = {};
+        size_t i = 0;
+        while (i < text.size()) {
+            if (std::isspace(static_cast<unsigned char>(text[i])) || text[i] == ',') {
+                i++;
+                continue;
+            }
+            size_t end = i;
+            while (end < text.size() && text[end] != ',' && !std::isspace(static_cast<unsigned char>(text[end]))) end++;
+            std::string item = text.substr(i, end - i);
+            i = end;
+
+            if (item == "all" || item == "*") {
+                for (int a = 0; a < 52; a++) {
+                    for (int b = a + 1; b < 52; b++) detail::addCombo(a, b, seen, combos);
+                }
+                continue;
+            }
+            std::vector<Card> cards;
+            if (item.size() == 4 && parseCards(item, cards)) {
+                if (cards[0].getIndex() == cards[1].getIndex()) return false;
+                detail::addCombo(cards[0].getIndex(), cards[1].getIndex(), seen, combos);
+                continue;
+            }
+
+            if (item.size() < 2 || item.size() > 4) return false;
+            size_t first = rankChars.find(static_cast<char>(std::toupper(static_cast<unsigned char>(item[0]))));
+            size_t second = rankChars.find(static_cast<char>(std::toupper(static_cast<unsigned char>(item[1]))));
+            if (first == std::string::npos || second == std::string::npos) return false;
+            int high = static_cast<int>(std::max(first, second)) + 2, low = static_cast<int>(std::min(first, second)) + 2;
+            size_t k = 2;
+            int suited = 0;
+            if (k < item.size() && (item[k] == 's' || item[k] == 'o')) {
+                if (high == low) return false;
+                suited = item[k++] == 's' ? 1 : -1;
+            }
+            bool plus = k < item.size() && item[k] == '+';
+            if (plus) k++;
+            if (k != item.size()) return false;
+
+            if (high == low) {
+                for (int r = low; r <= (plus ? 14 : low); r++) detail::addClass(r, r, 0, seen, combos);
+            } else {
+                for (int r = low; r <= (plus ? high - 1 : low); r++) detail::addClass(high, r, suited, seen, combos);
+            }
+        }
+        return true;
+    }
+
+    // 计算两组范围之间的胜率矩阵
+    // 参数:
+    //   hero - 己方的组合
+    //   villain - 对方的组合
+    //   board - 已知的公共牌（0-5张）
+    //   options - 计算参数
+    // 返回值: 胜率矩阵，输入无效（范围为空、组合不是两张牌或公共牌多于5张）时 runouts 为0
+    inline Matrix compute(const std::vector<CardSet>& hero, const std::vector<CardSet>& villain, CardSet board,
+                          const Options& options = Options()) {
+        Matrix matrix;
+        if (hero.empty() || villain.empty() || board.size() > 5) return matrix;
+
+        // 双方的组合去重，重叠的范围（例如双方都是 all）每个牌面也只评估一次
+        std::vector<CardSet> unique;
+        std::vector<int> heroSlots, villainSlots;
+        std::vector<int> slotOf(52 * 52, -1);
+        auto slot = [&](CardSet combo) {
+            std::uint64_t bits = combo.bits();
+            int key = countTrailingZeros(bits) * 52 + countTrailingZeros(bits & (bits - 1));
+            if (slotOf[key] < 0) {
+                slotOf[key] = static_cast<int>(unique.size());
+                unique.push_back(combo);
+            }
+            return slotOf[key];
+        };
+        for (CardSet combo : hero) {
+            if (combo.size() != 2) return matrix;
+            heroSlots.push_back(slot(combo));
+        }
+        for (CardSet combo : villain) {
+            if (combo.size() != 2) return matrix;
+            villainSlots.push_back(slot(combo));
+        }
+
+        // 生成所有牌面（只是补全的牌，不含已知公共牌）
+        int live[52];
+        int liveCount = 0;
+        std::uint64_t liveBits = (CardSet::fullDeck() - board).bits();
+        for (int i = 0; i < 52; i++) {
+            if ((liveBits >> i) & 1) live[liveCount++] = i;
+        }
+        int missing = 5 - board.size();
+        std::vector<std::uint64_t> runouts;             // 精确枚举时的全部牌面
+        matrix.exhaustive = missing <= MAX_EXACT_MISSING;
+        if (missing == 0) {
+            runouts.push_back(0);
+        } else if (missing == 1) {
+            for (int a = 0; a < liveCount; a++) runouts.push_back(std::uint64_t(1) << live[a]);
+        } else if (missing == 2) {
+            for (int a = 0; a < liveCount; a++) {
+                for (int b = a + 1; b < liveCount; b++) runouts.push_back((std::uint64_t(1) << live[a]) | (std::uint64_t(1) << live[b]));
+            }
+        }
+        long long total = matrix.exhaustive ? static_cast<long long>(runouts.size()) 
+                                            : std::min(std::max(options.samples, 0LL), MAX_SAMPLES);
+        if (total == 0) return matrix;
+
+        size_t stride = (villain.size() + detail::ROW_BLOCK - 1) / detail::ROW_BLOCK * detail::ROW_BLOCK;
+        WorkStealingPool pool(options.threads);
+        std::vector<std::vector<HandEvaluator::HandValue>> scratch(pool.size(), std::vector<HandEvaluator::HandValue>(unique.size()));
+        std::vector<std::uint64_t> cells(hero.size() * stride);
+        detail::Batch batch;
+        batch.villainValues.resize(RUNOUT_BATCH * stride);
+        batch.heroValues.resize(RUNOUT_BATCH * hero.size());
+        Xoshiro256 rng(options.seed ? options.seed : Xoshiro256::randomSeed());
+        for (long long done = 0; done < total; done += static_cast<long long>(batch.runouts.size())) {
+            size_t count = static_cast<size_t>(std::min<long long>(RUNOUT_BATCH, total - done));
+            batch.runouts.clear();
+            if (matrix.exhaustive) {
+                batch.runouts.assign(runouts.begin() + done, runouts.begin() + done + count);
+            } else {
+                for (size_t n = 0; n < count; n++) {
+                    std::uint64_t cards = 0;
+                    for (int i = 0; i < missing; i++) {
+                        int j = i + static_cast<int>(randomBelow(rng, static_cast<std::uint32_t>(liveCount - i)));
+                        std::swap(live[i], live[j]);
+                        cards |= std::uint64_t(1) << live[i];
+                    }
+                    batch.runouts.push_back(cards);
+                }
+            }
+            pool.run((count + RUNOUT_CHUNK - 1) / RUNOUT_CHUNK, [&](size_t task) {
+                detail::evaluateRunouts(unique, heroSlots, villainSlots, board, batch, stride, task * RUNOUT_CHUNK,
+                                        std::min((task + 1) * RUNOUT_CHUNK, count), scratch[WorkStealingPool::threadIndex()]);
+            });
+            pool.run((hero.size() + ROW_GROUP - 1) / ROW_GROUP, [&](size_t task) {
+                detail::accumulateRows(batch, hero.size(), cells.data(), stride, task * ROW_GROUP,
+                                       std::min((task + 1) * ROW_GROUP, hero.size()));
+            });
+        }
+
+        matrix.hero = hero;
+        matrix.villain = villain;
+        matrix.points.resize(hero.size() * villain.size());
+        matrix.boards.resize(hero.size() * villain.size());
+        for (size_t h = 0; h < hero.size(); h++) {
+            for (size_t v = 0; v < villain.size(); v++) {
+                if (!(hero[h] & villain[v]).empty()) continue;  // 冲突的组合对不计入
+                std::uint64_t cell = cells[h * stride + v];
+                matrix.points[h * villain.size() + v] = static_cast<std::uint32_t>(cell >> 32);
+                matrix.boards[h * villain.size() + v] = static_cast<std::uint32_t>(cell);
+            }
+        }
+        matrix.runouts = total;
+        return matrix;
+    }
+}
+
+// 玩家操作类型
+enum class ActionType {
+    FOLD,       // 弃牌
+    CALL,       // 跟注（需要跟注的金额为0时即为过牌）
+    RAISE       // 加注
+};
+
+// 玩家操作 - 由代理（Agent）做出，由牌局引擎执行
+struct PlayerAction {
+    ActionType type;    // 操作类型
+    int amount;         // 加注时为在跟注之外额外加注的金额；跟注时由引擎填写实际跟注金额
+
+    static PlayerAction fold() { return {ActionType::FOLD, 0}; }
+    static PlayerAction call() { return {ActionType::CALL, 0}; }
+    static PlayerAction raise(int amount) { return {ActionType::RAISE, amount}; }
+};
+
+// 决策上下文 - 轮到某位玩家行动时，引擎提供给代理的全部信息
+struct DecisionContext {
+    int playerIndex;                            // 玩家座位索引
+    const Player& player;                       // 当前行动的玩家
+    int toCall;                                 // 需要跟注的金额
+    int minRaise;                               // 最小加注金额（在跟注之外额外加注的部分）
+    int maxBet;                                 // 当前最高下注金额
+    int pot;                                    // 底池金额
+    int round;                                  // 当前轮次（0:pre-flop, 1:flop, 2:turn, 3:river）
+    const BoardCards& communityCards;           // 公共牌
+    CardSet communityMask;                      // 公共牌的掩码
+    const HandEvaluator::IncrementalHand& hand; // 当前玩家目前的最好牌力（底牌加已发出的公共牌，随发牌增量更新）
+    int opponents;                              // 未弃牌的对手人数
+};
+
+// 玩家代理接口 - 下注轮中由它决定玩家的操作
+// 控制台输入、脚本、机器人都只是不同的代理实现，引擎本身不做任何输入
+class Agent {
+public:
+    virtual ~Agent() = default;
+
+    // 做出决策
+    // 参数: context - 当前局面
+    // 返回值: 玩家的操作，非法的加注金额会被引擎修正为最小加注
+    virtual PlayerAction decide(const DecisionContext& context) = 0;
+};
+
+// 牌局事件接收接口 - 引擎把所有需要展示或记录的事件交给它，而不是直接写控制台
+// 所有回调默认什么也不做，实现时只需重写关心的事件
+class GameEventSink {
+public:
+    virtual ~GameEventSink() = default;
+
+    virtual void onTableFull() {}                                               // 加入玩家时已达人数上限
+    virtual void onNotEnoughPlayers() {}                                        // 开局时玩家不足2人
+    virtual void onHandStart(const PlayerList& players, int dealer, int smallBlind, int bigBlind) { (void)players; (void)dealer; (void)smallBlind; (void)bigBlind; }  // 新的一局开始（players 为开局前的状态）
+    virtual void onBlind(int seat, const Player& player, int amount, bool big) { (void)seat; (void)player; (void)amount; (void)big; }  // 支付盲注
+    virtual void onHoleCards(int seat, const Player& player) { (void)seat; (void)player; }           // 发完底牌
+    virtual void onStreetStart(int round) { (void)round; }                       // 进入新的下注轮
+    virtual void onBurnCard(const Card& card) { (void)card; }                      // 发公共牌前烧掉一张牌
+    virtual void onCommunityCards(const BoardCards& cards) { (void)cards; }  // 发出公共牌
+    virtual void onAction(int seat, const Player& player, const PlayerAction& action) { (void)seat; (void)player; (void)action; }  // 玩家操作已执行（player 为执行后的状态）
+    virtual void onAllIn(int seat, const Player& player, int amount) { (void)seat; (void)player; (void)amount; }      // 玩家投入剩余全部筹码
+    virtual void onNoPlayersLeft() {}                                           // 没有玩家可以比牌
+    virtual void onShowdownStart() {}                                           // 进入比牌阶段
+    virtual void onShowdownHand(int seat, const Player& player, HandRank rank) { (void)seat; (void)player; (void)rank; }  // 亮出一位玩家的手牌
+    virtual void onUncalledBet(int seat, const Player& player, int amount) { (void)seat; (void)player; (void)amount; }  // 没有人跟到的下注将退还（在分配底池之前发出，随后发给该玩家的筹码包含这部分）
+    virtual void onPotStart(int index, int amount) { (void)index; (void)amount; }  // 开始分配第 index 个底池（0为主池，只有存在边池时才会发出）
+    virtual void onWinner(int seat, const Player& player, int amount) { (void)seat; (void)player; (void)amount; }     // 一位玩家独得底池
+    virtual void onSplitPot() {}                                                // 平局，底池将被平分
+    virtual void onPotShare(int seat, const Player& player, int amount) { (void)seat; (void)player; (void)amount; }   // 平分底池时一位玩家获得的份额
+    virtual void onRemainder(int seat, const Player& player, int amount) { (void)seat; (void)player; (void)amount; }  // 平分后的余数
+    virtual void onHandEnd() {}                                                 // 本局结束
+};
+
+// 空事件接收器 - 丢弃所有事件，用于无输出的高速模拟
+class NullEventSink : public GameEventSink {};
+
+// 控制台渲染器 - 把一帧文字（从上一次等待输入到下一次等待输入之间的全部输出）拼进同一个可复用的缓冲区，
+// 只在即将等待输入或一局结束时一次性写出并刷新，不再每行 std::endl 刷新一次；牌面文字使用预先生成的字符串
+// 输出的文字与逐行写入输出流完全相同
+class ConsoleRenderer {
+private:
+    std::ostream& out;      // 输出流
+    std::string buffer;     // 当前帧的文字，写出后清空但保留容量
+
+public:
+    // 构造函数
+    // 参数: output - 输出流
+    explicit ConsoleRenderer(std::ostream& output) : out(output) {
+        buffer.reserve(1 << 14);
+    }
+
+    ~ConsoleRenderer() {
+        flush();
+    }
+
+    // 标准输出上的渲染器（控制台代理和控制台事件接收器共用，保证输出顺序）
+    static ConsoleRenderer& standard() {
+        static ConsoleRenderer renderer(std::cout);
+        return renderer;
+    }
+
+    ConsoleRenderer& operator<<(const char* text) {
+        buffer += text;
+        return *this;
+    }
+
+    ConsoleRenderer& operator<<(const std::string& text) {
+        buffer += text;
+        return *this;
+    }
+
+    ConsoleRenderer& operator<<(char c) {
+        buffer += c;
+        return *this;
+    }
+
+    ConsoleRenderer& operator<<(long long value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+        return *this;
+    }
+
+    ConsoleRenderer& operator<<(int value) {
+        return *this << static_cast<long long>(value);
+    }
+
+    ConsoleRenderer& operator<<(size_t value) {
+        return *this << static_cast<long long>(value);
+    }
+
+    // 写出当前帧并刷新输出流（即将等待输入时调用）
+    void flush() {
+        if (!buffer.empty()) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+        out.flush();
+    }
+};
+
+// 控制台事件接收器 - 把事件格式化为原来的控制台文字
+// 文字写入控制台渲染器，一局结束（或无法开局）时才写出
+class ConsoleEventSink : public GameEventSink {
+private:
+    ConsoleRenderer& out;  // 控制台渲染器
+
+public:
+    // 构造函数
+    // 参数: renderer - 控制台渲染器，默认为标准输出上的渲染器
+    explicit ConsoleEventSink(ConsoleRenderer& renderer = ConsoleRenderer::standard()) : out(renderer) {}
+
+    void onTableFull() override {
+        out << "达到最大玩家数量限制（22人）。" << '\n';
+        out.flush();
+    }
+
+    void onNotEnoughPlayers() override {
+        out << "玩家数量不足，至少需要2名玩家。" << '\n';
+        out.flush();
+    }
+
+    void onHandStart(const PlayerList&, int, int, int) override {
+        out << "\n===== 开始新的一局 =====" << '\n';
+    }
+
+    void onBlind(int, const Player& player, int amount, bool big) override {
+        out << player.getName() << (big ? " 支付大盲注 " : " 支付小盲注 ") << amount << '\n';
+    }
+
+    void onHoleCards(int, const Player& player) override {
+        player.displayHand(out);
+    }
+
+    void onStreetStart(int round) override {
+        static const char* names[] = {"Pre-flop", "Flop", "Turn", "River"};
+        out << "\n===== " << names[round] << " 阶段 =====" << '\n';
+    }
+
+    void onCommunityCards(const BoardCards& cards) override {
+        out << "公共牌: ";
+        for (const auto& card : cards) {
+            out << card.glyph() << " ";
+        }
+        out << '\n';
+    }
+
+    void onAction(int, const Player& player, const PlayerAction& action) override {
+        switch (action.type) {
+            case ActionType::FOLD:
+                out << player.getName() << " 选择弃牌。" << '\n';
+                break;
+            case ActionType::CALL:
+                out << player.getName() << " 选择跟注 " << action.amount << "。" << '\n';
+                break;
+            case ActionType::RAISE:
+                out << player.getName() << " 选择加注到 " << player.getCurrentBet() << "。" << '\n';
+                break;
+        }
+    }
+
+    void onAllIn(int, const Player& player, int amount) override {
+        out << player.getName() << " 选择全下 " << amount << "（总下注 " << player.getCurrentBet() << "）。" << '\n';
+    }
+
+    void onNoPlayersLeft() override {
+        out << "没有剩余玩家进行比牌。" << '\n';
+    }
+
+    void onShowdownStart() override {
+        out << "\n===== 比牌阶段 =====" << '\n';
+    }
+
+    void onShowdownHand(int, const Player& player, HandRank rank) override {
+        player.displayHand(out);
+        out << "牌型: " << HandEvaluator::getHandRankName(rank) << '\n';
+    }
+
+    void onPotStart(int index, int amount) override {
+        if (index == 0) {
+            out << "\n----- 主池 " << amount << " -----" << '\n';
+        } else {
+            out << "\n----- 边池" << index << " " << amount << " -----" << '\n';
+        }
+    }
+
+    void onWinner(int, const Player& player, int amount) override {
+        out << "\n" << player.getName() << " 赢得了底池 " << amount << "！" << '\n';
+    }
+
+    void onSplitPot() override {
+        out << "\n平局！底池将平分给以下玩家：" << '\n';
+    }
+
+    void onPotShare(int, const Player& player, int amount) override {
+        out << "- " << player.getName() << " 获得 " << amount << '\n';
+    }
+
+    void onRemainder(int, const Player&, int amount) override {
+        out << "余数 " << amount << " 归第一个玩家。" << '\n';
+    }
+
+    void onHandEnd() override {
+        out << "\n===== 本局结束 =====" << '\n';
+        out.flush();
+    }
+};
+
+// 控制台代理 - 在控制台显示菜单并读取玩家输入（即原来的交互方式）
+// 菜单和提示写入控制台渲染器，每次读取输入前写出当前帧
+class ConsoleAgent : public Agent {
+private:
+    std::istream& in;           // 输入流
+    ConsoleRenderer& out;       // 控制台渲染器
+
+public:
+    // 构造函数
+    // 参数:
+    //   input - 输入流，默认为标准输入
+    //   output - 控制台渲染器，默认为标准输出上的渲染器
+    ConsoleAgent(std::istream& input = std::cin, ConsoleRenderer& output = ConsoleRenderer::standard()) 
+        : in(input), out(output) {}
+
+    PlayerAction decide(const DecisionContext& context) override {
+        const Player& player = context.player;
+        int toCall = context.toCall;
+
+        // 显示玩家信息，让玩家了解当前状态
+        out << "\n" << player.getName() << " 的回合（筹码: " << player.getChips() 
+            << ", 当前下注: " << player.getCurrentBet() << "）" << '\n';
+        out << "请选择操作：" << '\n';
+        out << "1. 弃牌" << '\n';
+        if (toCall > 0) {
+            out << "2. 跟注 (" << toCall << ")" << '\n';
+        }
+        out << "3. 加注" << '\n';
+
+        int choice;
+        // 获取并验证用户输入
+        while (true) {
+            out << "请输入选择 (1-3): ";
+            out.flush();
+            if (!(in >> choice)) { // 处理非数字输入
+                if (in.eof()) return PlayerAction::fold();  // 输入已结束（例如脚本读完），只能弃牌
+                in.clear();
+                in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                out << "无效输入，请重新输入数字。" << '\n';
+                continue;
+            }
+            
+            // 验证选择是否有效，避免当toCall<=0时选择跟注
+            if (choice >= 1 && choice <= 3 && !(choice == 2 && toCall <= 0)) {
+                // 清理输入缓冲区中的剩余字符
+                in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                break;
+            }
+            
+            out << "无效选择，请重新输入。" << '\n';
+            // 清理输入缓冲区
+            in.clear();
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+
+        if (choice == 1) return PlayerAction::fold();
+        if (choice == 2) return PlayerAction::call();
+
+        int raiseAmount;
+        // 获取并验证加注金额
+        while (true) {
+            out << "请输入加注金额（最小 " << context.minRaise << "，筹码: " << player.getChips() << "）: ";
+            out.flush();
+            if (!(in >> raiseAmount)) {
+                if (in.eof()) return PlayerAction::fold();
+                in.clear();
+                in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                out << "无效的加注金额，请重新输入。" << '\n';
+                continue;
+            }
+            
+            if (raiseAmount < context.minRaise || raiseAmount > player.getChips()) {
+                out << "无效的加注金额，请重新输入。" << '\n';
+                // 清理输入缓冲区
+                in.clear();
+                in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                continue;
+            }
+            
+            // 清理输入缓冲区中的剩余字符
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            break;
+        }
+        return PlayerAction::raise(raiseAmount);
+    }
+};
+
+// 随机代理 - 按给定概率随机弃牌/跟注/加注（最小加注），用于无输出的自我对局
+class RandomAgent : public Agent {
+private:
+    Xoshiro256 rng;     // 随机数引擎
+    int foldPercent;    // 需要跟注时弃牌的概率（百分比）
+    int raisePercent;   // 加注的概率（百分比）
+
+public:
+    // 构造函数
+    // 参数:
+    //   seed - 随机数种子
+    //   foldPct - 需要跟注时弃牌的概率（百分比）
+    //   raisePct - 加注的概率（百分比）
+    explicit RandomAgent(std::uint64_t seed, int foldPct = 20, int raisePct = 10) 
+        : rng(seed), foldPercent(foldPct), raisePercent(raisePct) {}
+
+    PlayerAction decide(const DecisionContext& context) override {
+        int roll = static_cast<int>(randomBelow(rng, 100));
+        if (roll < raisePercent && context.toCall + context.minRaise <= context.player.getChips()) {
+            return PlayerAction::raise(context.minRaise);
+        }
+        if (context.toCall > 0 && roll < raisePercent + foldPercent) {
+            return PlayerAction::fold();
+        }
+        return PlayerAction::call();  // 不需要跟注时即为过牌
+    }
+};
+
+// 机器人代理 - 每次决策只查表，不做任何模拟，用于高速的无人值守对局
+// 决策表的键是 (胜率档位, 轮次, 底池赔率档位)，每一格给出加注和跟注的概率（其余为弃牌）：
+//   胜率档位 - 翻牌前直接查 Preflop 牌力表；翻牌后用当前最好牌力在同一牌面上所有可能的对手底牌中的分位数 p，
+//              面对 n 名对手的胜率按 p^n 估计，档位边界 (k/10)^(1/n) 预先算好，查询时只比较整数
+//   底池赔率档位 - 0表示不需要跟注，1-10对应跟注额占（底池+跟注额）的比例
+// 档位边界、按点数查的牌力表和各风格的决策表都只在第一次使用时生成一次，之后所有机器人共用；
+// 每个线程缓存最近一个牌面的排名，每条街只生成一次，同桌的所有机器人共用
+namespace Bots {
+    // 机器人风格
+    enum class Style {
+        TIGHT,      // 紧：只玩强牌，要求胜率明显高于赔率才跟注
+        LOOSE,      // 松：胜率略低于赔率也跟注，且经常加注
+        RANDOM,     // 随机：与 RandomAgent 相同的固定概率，不看牌力
+        EQUITY      // 胜率阈值：胜率不低于赔率就跟注，胜率很高时加注
+    };
+
+    const int STYLE_COUNT = 4;
+    const int STREETS = 4;                  // 轮次数（pre-flop、flop、turn、river）
+    const int EQUITY_BUCKETS = 10;          // 胜率档位数（每档10%）
+    const int ODDS_BUCKETS = 11;            // 底池赔率档位数
+    const int MAX_ESTIMATED_OPPONENTS = 3;  // 估计胜率时最多计入的对手数（多人底池里真正走到摊牌的对手通常不超过3人）
+
+    // 决策表的一格
+    struct Cell {
+        std::uint8_t raise;     // 加注的概率（百分比）
+        std::uint8_t call;      // 跟注（或过牌）的概率（百分比），剩下的为弃牌
+    };
+
+    // 一种风格的完整决策表
+    struct Policy {
+        Cell cells[STREETS][EQUITY_BUCKETS][ODDS_BUCKETS];
+    };
+
+    namespace detail {
+        // 每个对手数的胜率档位边界，单位 1/65535
+        struct StrengthTables {
+            std::uint16_t edges[MAX_ESTIMATED_OPPONENTS + 1][EQUITY_BUCKETS - 1];    // [对手数][档位]
+        };
+
+        inline const StrengthTables& strengthTables() {
+            static const StrengthTables tables = [] {
+                StrengthTables t = {};
+                for (int n = 1; n <= MAX_ESTIMATED_OPPONENTS; n++) {
+                    for (int k = 0; k < EQUITY_BUCKETS - 1; k++) {
+                        t.edges[n][k] = static_cast<std::uint16_t>(std::pow((k + 1) / double(EQUITY_BUCKETS), 1.0 / n) * 65535 + 0.5);
+                    }
+                }
+                return t;
+            }();
+            return tables;
+        }
+
+        const int RANK_PAIRS = 91;          // 两张牌的点数组合数：13种相同点数 + 78种不同点数
+        const int BOARD_PATTERNS = 455 + 1820 + 6175;   // 3/4/5张牌面的点数次数序列数
+
+        // 点数组合（low <= high，0为2）的编号
+        constexpr int rankPairIndex(int low, int high) {
+            return low * 13 - low * (low - 1) / 2 + (high - low);
+        }
+
+        // 点数次数序列的完美哈希（与查表评估器的编号相同）
+        inline int rankPattern(const int counts[13], int total) {
+            int index = 0;
+            for (int r = 0; r < 13 && total > 0; r++) {
+                index += HandEvaluator::detail::HASH.step[r][counts[r]][total];
+                total -= counts[r];
+            }
+            return index;
+        }
+
+        // 凑不成同花时的牌力表：[牌面的点数次数序列][两张牌的点数组合] -> 牌面加这两张牌的牌力值
+        // 与花色无关，所有牌面共用一张表（约1.5MB），第一次使用时生成；不可能出现的组合（某点数超过4张）为0
+        struct RankPairTable {
+            int offset[3] = {0, 455, 455 + 1820};      // 3/4/5张牌面在表中的起始行
+            HandEvaluator::HandValue values[BOARD_PATTERNS][RANK_PAIRS];
+        };
+
+        // 枚举总数为 total 的所有点数次数序列，填写对应的一行
+        inline void fillRankPairs(RankPairTable& t, int counts[13], int r, int remaining, int total) {
+            if (r == 13) {
+                if (remaining != 0) return;
+                HandEvaluator::HandValue* row = t.values[t.offset[total - 3] + rankPattern(counts, total)];
+                for (int low = 0; low < 13; low++) {
+                    for (int high = low; high < 13; high++) {
+                        counts[low]++;
+                        counts[high]++;
+                        row[rankPairIndex(low, high)] = counts[low] <= 4 && counts[high] <= 4 
+                            ? HandEvaluator::detail::noFlushValue(total + 2, rankPattern(counts, total + 2)) : 0;
+                        counts[low]--;
+                        counts[high]--;
+                    }
+                }
+                return;
+            }
+            for (int c = 0; c <= 4 && c <= remaining; c++) {
+                counts[r] = c;
+                fillRankPairs(t, counts, r + 1, remaining - c, total);
+            }
+            counts[r] = 0;
+        }
+
+        inline const RankPairTable& rankPairTable() {
+            static const std::unique_ptr<RankPairTable> table = [] {
+                std::unique_ptr<RankPairTable> t(new RankPairTable());
+                int counts[13] = {};
+                for (int total = 3; total <= 5; total++) fillRankPairs(*t, counts, 0, total, total);
+                return t;
+            }();
+            return *table;
+        }
+
+        const int MAX_FLUSH_DRAWS = 1 + 13 + 78;    // 同花花色的牌的取法上限（0、1、2张）
+
+        // 牌面排名 - 一个牌面上所有可能的对手底牌（两张都不在牌面中）与牌面组成的牌力
+        // 分位数只和同一牌面上的对手比较：牌面本身就是三条、四条或四张同花时，只靠牌面的牌力人人都有，不再算作强牌。
+        // 凑不成同花的组合，牌力只取决于两张牌的点数，直接查 rankPairTable()，组合数在查询时按剩余的牌计算；
+        // 能凑成同花的组合，牌力只取决于其中该花色的牌，按该花色的取法分组
+        struct BoardRanking {
+            CardSet board;                              // 牌面
+            bool built = false;                         // 是否已生成
+            const HandEvaluator::HandValue* rankValues = nullptr;  // 牌面在 rankPairTable() 中的一行
+            int flushSuit = -1;                         // 牌面上至少3张的花色，没有为-1
+            int flushNeed = 0;                          // 凑成同花还需要的该花色张数（0-2）
+            int drawCount = 0;                          // 能凑成同花的取法数
+            std::uint64_t drawCards[MAX_FLUSH_DRAWS];   // 每种取法用到的该花色的牌
+            std::uint8_t drawSize[MAX_FLUSH_DRAWS];     // 其中的张数（不足2张时其余为其他花色的任意牌）
+            HandEvaluator::HandValue drawValues[MAX_FLUSH_DRAWS];   // 凑成的同花的牌力值
+
+            // 生成一个牌面（3-5张）的排名
+            void build(CardSet cards) {
+                board = cards;
+                built = true;
+                int counts[13];
+                for (int r = 0; r < 13; r++) counts[r] = popCount((board.bits() >> r) & 0x0008004002001ull);
+                const RankPairTable& table = rankPairTable();
+                rankValues = table.values[table.offset[board.size() - 3] + rankPattern(counts, board.size())];
+
+                flushSuit = -1;
+                drawCount = 0;
+                for (int suit = 0; suit < 4; suit++) {
+                    if (board.suitCount(static_cast<Suit>(suit)) >= 3) flushSuit = suit;
+                }
+                if (flushSuit < 0) return;
+                unsigned boardSuited = board.suitMask(static_cast<Suit>(flushSuit));
+                flushNeed = 5 - popCount(boardSuited);
+                auto addDraw = [this, boardSuited](unsigned ranks) {
+                    drawCards[drawCount] = static_cast<std::uint64_t>(ranks) << (flushSuit * 13);
+                    drawSize[drawCount] = static_cast<std::uint8_t>(popCount(ranks));
+                    drawValues[drawCount++] = HandEvaluator::detail::FLUSH.values[boardSuited | ranks];
+                };
+                unsigned rest = 0x1FFFu & ~boardSuited;
+                if (flushNeed == 0) addDraw(0);
+                for (int r = 0; r < 13; r++) {
+                    if (!((rest >> r) & 1)) continue;
+                    if (flushNeed <= 1) addDraw(1u << r);
+                    for (int q = r + 1; q < 13; q++) {
+                        if ((rest >> q) & 1) addDraw((1u << r) | (1u << q));
+                    }
+                }
+            }
+
+            // 牌力在不与 hole 冲突的组合中的分位数（比它弱的比例，相等的算一半），单位 1/65535
+            // 参数:
+            //   hole - 己方底牌，含有其中任何一张的组合不计入
+            //   value - 己方底牌加牌面的牌力值
+            std::uint16_t percentile(CardSet hole, HandEvaluator::HandValue value) const {
+                long long total = 0, below = 0;     // below 以半个组合为单位
+                auto count = [&total, &below, value](long long combos, HandEvaluator::HandValue opponent) {
+                    total += combos;
+                    below += combos * (opponent < value ? 2 : (opponent == value ? 1 : 0));
+                };
+                // 每个点数剩下的牌数，其中同花花色的牌是否还在，以及凑不成同花时可用的牌数
+                std::uint64_t used = board.bits() | hole.bits();
+                long long left[13], suited[13], plain[13];
+                for (int r = 0; r < 13; r++) {
+                    left[r] = 4 - popCount((used >> r) & 0x0008004002001ull);
+                    suited[r] = flushSuit >= 0 ? 1 - static_cast<long long>((used >> (flushSuit * 13 + r)) & 1) : 0;
+                    plain[r] = flushNeed == 1 ? left[r] - suited[r] : left[r];
+                }
+                if (flushSuit < 0 || flushNeed > 0) {
+                    for (int low = 0; low < 13; low++) {
+                        if (plain[low] >= 2) count(plain[low] * (plain[low] - 1) / 2, rankValues[rankPairIndex(low, low)]);
+                        for (int high = low + 1; high < 13; high++) {
+                            // 还差2张时，两张都是该花色的组合属于同花的取法
+                            long long combos = plain[low] * plain[high] - (flushNeed == 2 ? suited[low] * suited[high] : 0);
+                            if (combos > 0) count(combos, rankValues[rankPairIndex(low, high)]);
+                        }
+                    }
+                }
+                if (drawCount > 0) {
+                    std::uint64_t suitBits = std::uint64_t(0x1FFF) << (flushSuit * 13);
+                    long long others = popCount(CardSet::fullDeck().bits() & ~suitBits & ~used);   // 剩下的其他花色的牌
+                    for (int i = 0; i < drawCount; i++) {
+                        if (drawCards[i] & used) continue;
+                        count(drawSize[i] == 2 ? 1 : (drawSize[i] == 1 ? others : others * (others - 1) / 2), drawValues[i]);
+                    }
+                }
+                return total == 0 ? 0 : static_cast<std::uint16_t>((below * 65535 + total) / (2 * total));
+            }
+        };
+
+        // 当前线程最近一个牌面的排名，牌面变化时重新生成
+        // 参数: board - 牌面（3-5张）
+        inline const BoardRanking& boardRanking(CardSet board) {
+            thread_local BoardRanking ranking;
+            if (!ranking.built || ranking.board != board) ranking.build(board);
+            return ranking;
+        }
+
+        // 按风格生成决策表，e 为档位中心的胜率，q 为档位中心的赔率
+        inline Policy buildPolicy(Style style) {
+            Policy policy = {};
+            for (int street = 0; street < STREETS; street++) {
+                for (int b = 0; b < EQUITY_BUCKETS; b++) {
+                    double e = (b + 0.5) / EQUITY_BUCKETS;
+                    for (int o = 0; o < ODDS_BUCKETS; o++) {
+                        double q = o == 0 ? 0.0 : (o - 0.5) / 10;
+                        int raise = 0, call = 0;
+                        switch (style) {
+                            case Style::TIGHT:
+                                raise = e >= 0.7 ? 100 : 0;
+                                call = o == 0 || e >= q + 0.1 ? 100 - raise : 0;
+                                break;
+                            case Style::LOOSE:
+                                raise = e >= 0.5 ? 100 : (o == 0 && e < 0.3 ? 20 : 0);   // 没人下注时偶尔用弱牌诈唬
+                                call = o == 0 || e >= q - 0.1 ? 100 - raise : 0;
+                                break;
+                            case Style::RANDOM:
+                                raise = 10;
+                                call = o == 0 ? 90 : 70;
+                                break;
+                            case Style::EQUITY:
+                                raise = e >= 0.75 ? 100 : 0;
+                                call = o == 0 || e >= q ? 100 - raise : 0;
+                                break;
+                        }
+                        policy.cells[street][b][o] = {static_cast<std::uint8_t>(raise), static_cast<std::uint8_t>(call)};
+                    }
+                }
+            }
+            return policy;
+        }
+
+        // 各风格的决策表
+        inline const Policy& policy(Style style) {
+            static const Policy policies[STYLE_COUNT] = {
+                buildPolicy(Style::TIGHT), buildPolicy(Style::LOOSE), buildPolicy(Style::RANDOM), buildPolicy(Style::EQUITY)
+            };
+            return policies[static_cast<int>(style)];
+        }
+    }
+
+    // 胜率档位
+    // 参数: context - 决策上下文
+    // 返回值: 0 到 EQUITY_BUCKETS-1
+    inline int equityBucket(const DecisionContext& context) {
+        int opponents = std::min(std::max(context.opponents, 1), MAX_ESTIMATED_OPPONENTS);
+        if (context.round == 0 || context.hand.size() < 5) {
+            const HoleCards& hole = context.player.getHand();
+            if (hole.size() < 2) return 0;
+            int basisPoints = Preflop::equityBasisPoints(Preflop::classIndex(hole[0], hole[1]), opponents);
+            return std::min(basisPoints * EQUITY_BUCKETS / 10000, EQUITY_BUCKETS - 1);
+        }
+        const detail::StrengthTables& t = detail::strengthTables();
+        CardSet hole = context.hand.getCards() - context.communityMask;
+        std::uint16_t p = detail::boardRanking(context.communityMask).percentile(hole, context.hand.value());
+        int bucket = 0;
+        while (bucket < EQUITY_BUCKETS - 1 && p >= t.edges[opponents][bucket]) bucket++;
+        return bucket;
+    }
+
+    // 底池赔率档位
+    // 参数: context - 决策上下文
+    // 返回值: 0表示不需要跟注，否则为 1 + floor(10 × 跟注额 / (底池 + 跟注额))，最大为10
+    inline int oddsBucket(const DecisionContext& context) {
+        if (context.toCall <= 0) return 0;
+        long long total = static_cast<long long>(context.pot) + context.toCall;
+        return 1 + static_cast<int>(std::min<long long>(static_cast<long long>(context.toCall) * 10 / total, 9));
+    }
+
+    // 查表决策的机器人
+    class TableAgent : public Agent {
+    private:
+        Xoshiro256 rng;             // 随机数引擎，只用于按决策表中的概率选择
+        Style style;                // 风格
+        const Policy& table;        // 该风格的决策表
+
+    public:
+        // 构造函数
+        // 参数:
+        //   playStyle - 风格
+        //   seed - 随机数种子
+        TableAgent(Style playStyle, std::uint64_t seed) 
+            : rng(seed), style(playStyle), table(detail::policy(playStyle)) {}
+
+        Style getStyle() const {
+            return style;
+        }
+
+        PlayerAction decide(const DecisionContext& context) override {
+            int bucket = equityBucket(context);
+            const Cell& cell = table.cells[std::min(std::max(context.round, 0), STREETS - 1)][bucket][oddsBucket(context)];
+            int roll = static_cast<int>(randomBelow(rng, 100));
+            if (roll < cell.raise && context.toCall + context.minRaise <= context.player.getChips()) {
+                // 最强的两档按底池大小加注，其余最小加注
+                int amount = bucket >= EQUITY_BUCKETS - 2 ? std::max(context.minRaise, context.pot) : context.minRaise;
+                return PlayerAction::raise(amount);
+            }
+            if (roll < cell.raise + cell.call || context.toCall <= 0) {
+                return PlayerAction::call();  // 不需要跟注时从不弃牌
+            }
+            return PlayerAction::fold();
+        }
+    };
+
+    // 风格名称
+    inline const char* styleName(Style style) {
+        static const char* names[STYLE_COUNT] = {"tight", "loose", "random", "equity"};
+        return names[static_cast<int>(style)];
+    }
+
+    // 检查机器人阵容名称：tight、loose、random、equity 之一，或 mix（按座位轮流使用四种风格）
+    inline bool isValidLineup(const std::string& lineup) {
+        if (lineup == "mix") return true;
+        for (int i = 0; i < STYLE_COUNT; i++) {
+            if (lineup == styleName(static_cast<Style>(i))) return true;
+        }
+        return false;
+    }
+
+    // 按阵容为一个座位创建代理
+    // 参数:
+    //   lineup - 阵容名称（见 isValidLineup），为空时使用 RandomAgent
+    //   seat - 座位或参赛编号，mix 阵容按它轮流分配风格
+    //   seed - 随机数种子
+    // 返回值: 新建的代理
+    inline std::unique_ptr<Agent> makeAgent(const std::string& lineup, int seat, std::uint64_t seed) {
+        if (lineup.empty()) return std::unique_ptr<Agent>(new RandomAgent(seed));
+        Style style = static_cast<Style>(seat % STYLE_COUNT);
+        for (int i = 0; i < STYLE_COUNT; i++) {
+            if (lineup == styleName(static_cast<Style>(i))) style = static_cast<Style>(i);
+        }
+        return std::unique_ptr<Agent>(new TableAgent(style, seed));
+    }
+}
+
+// 手牌历史记录 - 定长二进制格式，每手牌一条记录，便于离线分析和回放
+// 文件由 HandHistoryHeader 开头，后面紧跟若干条 HandRecord；所有字段按本机字节序（小端）存放，
+// 记录长度固定，读取时可以直接把映射的内存当作记录数组使用
+namespace HandHistory {
+    const int MAX_SEATS = MAX_PLAYERS;  // 座位上限
+    const int MAX_ACTIONS = 95;         // 每手牌最多记录的操作数，超出时记录被标记为不完整
+    const std::uint8_t NO_CARD = 0xFF;  // 没有牌的位置
+    const std::uint32_t VERSION = 1;    // 格式版本
+
+    // 操作类型（ActionRecord::kind 的低2位），全下单独记录以便回放时不必区分跟注还是加注
+    enum ActionKind : std::uint8_t { KIND_FOLD = 0, KIND_CALL = 1, KIND_RAISE = 2, KIND_ALL_IN = 3 };
+
+    // 记录标志
+    enum RecordFlags : std::uint8_t {
+        FLAG_TRUNCATED = 1,             // 操作数超过 MAX_ACTIONS，后面的操作没有记录
+        FLAG_SHOWDOWN = 2               // 本局进行了比牌
+    };
+
+    // 文件头
+    struct HandHistoryHeader {
+        char magic[8];                  // "THHLOG\0\0"
+        std::uint32_t version;          // 格式版本
+        std::uint32_t recordSize;       // 每条记录的字节数
+    };
+
+    // 一次操作
+    struct ActionRecord {
+        std::uint8_t seat;              // 座位索引
+        std::uint8_t kind;              // 低2位为 ActionKind，第2-3位为下注轮（0-3）
+        std::uint16_t reserved;
+        std::int32_t amount;            // 跟注或全下时为实际投入的筹码，加注时为加注额
+    };
+
+    // 一手牌的完整记录（1024字节）
+    struct HandRecord {
+        std::uint64_t handId;                       // 本文件内的序号（从0开始）
+        std::uint32_t tableId;                      // 牌桌编号
+        std::uint8_t seatCount;                     // 座位数
+        std::uint8_t dealer;                        // 本局开始时的庄家位置
+        std::uint8_t boardCount;                    // 公共牌数量
+        std::uint8_t actionCount;                   // 记录的操作数
+        std::uint8_t flags;                         // RecordFlags 的组合
+        std::uint8_t burn[3];                       // 三张烧牌
+        std::uint8_t board[5];                      // 公共牌（Card::getIndex）
+        std::uint8_t uncalledSeat;                  // 下注没有人跟到的座位（uncalled 为0时无意义）
+        std::uint8_t reserved[2];
+        std::int32_t uncalled;                      // 退还给 uncalledSeat 的没有人跟到的筹码（已计入 won）
+        std::int32_t smallBlind;                    // 小盲注金额
+        std::int32_t bigBlind;                      // 大盲注金额
+        std::uint8_t hole[MAX_SEATS][2];            // 每个座位的两张底牌
+        std::int32_t startChips[MAX_SEATS];         // 本局开始前的筹码（0表示未参与）
+        std::int32_t won[MAX_SEATS];                // 本局从底池得到的筹码（包括退还的 uncalled）
+        ActionRecord actions[MAX_ACTIONS];          // 按顺序记录的操作
+        std::uint32_t reserved2;
+    };
+
+    static_assert(sizeof(ActionRecord) == 8, "ActionRecord must stay 8 bytes");
+    static_assert(sizeof(HandRecord) == 1024, "HandRecord must stay 1024 bytes");
+
+    // 记录端 - 作为事件接收器挂到牌桌上，每局结束时生成一条记录交给 onRecord()
+    class Recorder : public GameEventSink {
+    private:
+        HandRecord current;                 // 正在记录的一手牌
+        std::uint32_t tableId;              // 牌桌编号
+        std::uint64_t nextHandId;           // 下一手牌的序号
+        int round;                          // 当前下注轮
+        int burned;                         // 已记录的烧牌数
+
+        void addAction(int seat, ActionKind kind, int amount) {
+            if (current.actionCount >= MAX_ACTIONS) {
+                current.flags |= FLAG_TRUNCATED;
+                return;
+            }
+            ActionRecord& action = current.actions[current.actionCount++];
+            action.seat = static_cast<std::uint8_t>(seat);
+            action.kind = static_cast<std::uint8_t>(kind | (round << 2));
+            action.reserved = 0;
+            action.amount = amount;
+        }
+
+    protected:
+        // 一手牌结束时调用
+        // 参数: record - 本局的完整记录
+        virtual void onRecord(const HandRecord& record) = 0;
+
+    public:
+        // 构造函数
+        // 参数: table - 牌桌编号
+        explicit Recorder(std::uint32_t table = 0) : tableId(table), nextHandId(0), round(0), burned(0) {
+            std::memset(&current, 0, sizeof(current));
+        }
+
+        // 已记录的手数
+        std::uint64_t handCount() const {
+            return nextHandId;
+        }
+
+        void onHandStart(const PlayerList& players, int dealer, int smallBlind, int bigBlind) override {
+            std::memset(&current, 0, sizeof(current));
+            std::memset(current.hole, NO_CARD, sizeof(current.hole));
+            std::memset(current.burn, NO_CARD, sizeof(current.burn));
+            std::memset(current.board, NO_CARD, sizeof(current.board));
+            current.handId = nextHandId;
+            current.tableId = tableId;
+            current.seatCount = static_cast<std::uint8_t>(std::min<size_t>(players.size(), MAX_SEATS));
+            current.dealer = static_cast<std::uint8_t>(dealer);
+            current.smallBlind = smallBlind;
+            current.bigBlind = bigBlind;
+            for (int i = 0; i < current.seatCount; i++) current.startChips[i] = players[i].getChips();
+            round = 0;
+            burned = 0;
+        }
+
+        void onHoleCards(int seat, const Player& player) override {
+            const HoleCards& hand = player.getHand();
+            for (size_t i = 0; i < hand.size() && i < 2; i++) {
+                current.hole[seat][i] = static_cast<std::uint8_t>(hand[i].getIndex());
+            }
+        }
+
+        void onStreetStart(int street) override {
+            round = street;
+        }
+
+        void onBurnCard(const Card& card) override {
+            if (burned < 3) current.burn[burned++] = static_cast<std::uint8_t>(card.getIndex());
+        }
+
+        void onCommunityCards(const BoardCards& cards) override {
+            current.boardCount = static_cast<std::uint8_t>(std::min<size_t>(cards.size(), 5));
+            for (int i = 0; i < current.boardCount; i++) {
+                current.board[i] = static_cast<std::uint8_t>(cards[i].getIndex());
+            }
+        }
+
+        void onAction(int seat, const Player&, const PlayerAction& action) override {
+            ActionKind kind = action.type == ActionType::FOLD ? KIND_FOLD 
+                            : action.type == ActionType::CALL ? KIND_CALL : KIND_RAISE;
+            addAction(seat, kind, action.amount);
+        }
+
+        void onAllIn(int seat, const Player&, int amount) override {
+            addAction(seat, KIND_ALL_IN, amount);
+        }
+
+        void onShowdownStart() override {
+            current.flags |= FLAG_SHOWDOWN;
+        }
+
+        void onUncalledBet(int seat, const Player&, int amount) override {
+            current.uncalledSeat = static_cast<std::uint8_t>(seat);
+            current.uncalled = amount;
+        }
+
+        void onWinner(int seat, const Player&, int amount) override {
+            current.won[seat] += amount;
+        }
+
+        void onPotShare(int seat, const Player&, int amount) override {
+            current.won[seat] += amount;
+        }
+
+        void onRemainder(int seat, const Player&, int amount) override {
+            current.won[seat] += amount;
+        }
+
+        void onHandEnd() override {
+            nextHandId++;
+            onRecord(current);
+        }
+    };
+
+    // 写入端 - 记录攒满一批后一次写入文件
+    class Writer : public Recorder {
+    private:
+        std::FILE* file;                    // 输出文件
+        std::vector<HandRecord> buffer;     // 待写入的记录
+        size_t buffered;                    // buffer 中已填好的记录数
+
+        void flush() {
+            if (file && buffered > 0) std::fwrite(buffer.data(), sizeof(HandRecord), buffered, file);
+            buffered = 0;
+        }
+
+    protected:
+        void onRecord(const HandRecord& record) override {
+            buffer[buffered++] = record;
+            if (buffered == buffer.size()) flush();
+        }
+
+    public:
+        // 构造函数
+        // 参数:
+        //   path - 输出文件路径（覆盖已有文件）
+        //   table - 牌桌编号
+        //   batchRecords - 每批写入的记录数
+        explicit Writer(const std::string& path, std::uint32_t table = 0, size_t batchRecords = 1024)
+            : Recorder(table), file(std::fopen(path.c_str(), "wb")), 
+              buffer(std::max<size_t>(batchRecords, 1)), buffered(0) {
+            if (file) {
+                HandHistoryHeader header = {{'T', 'H', 'H', 'L', 'O', 'G', 0, 0}, VERSION, sizeof(HandRecord)};
+                std::fwrite(&header, sizeof(header), 1, file);
+            }
+        }
+
+        ~Writer() override {
+            close();
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // 文件是否成功打开
+        bool isOpen() const {
+            return file != nullptr;
+        }
+
+        // 写入一条由其他记录端生成的记录
+        void append(const HandRecord& record) {
+            onRecord(record);
+        }
+
+        // 写出缓冲的记录并关闭文件
+        void close() {
+            flush();
+            if (file) std::fclose(file);
+            file = nullptr;
+        }
+    };
+
+    // 读取端 - 把整个文件映射到内存，直接以记录数组的形式访问，不解析也不分配内存
+    class Reader {
+    private:
+        const unsigned char* data;      // 映射的文件内容
+        size_t length;                  // 文件长度
+        size_t count;                   // 记录数
+        bool valid;                     // 文件头是否正确
+#ifdef _WIN32
+        HANDLE fileHandle;
+        HANDLE mapping;
+#else
+        int descriptor;
+#endif
+
+    public:
+        // 构造函数 - 打开并映射文件，格式不符或打开失败时 isOpen() 返回false
+        // 参数: path - 文件路径
+        explicit Reader(const std::string& path) : data(nullptr), length(0), count(0), valid(false) {
+#ifdef _WIN32
+            mapping = nullptr;
+            fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, 
+                                     OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (fileHandle == INVALID_HANDLE_VALUE) return;
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(HandHistoryHeader))) return;
+            mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return;
+            data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            length = static_cast<size_t>(size.QuadPart);
+#else
+            descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) return;
+            struct stat info;
+            if (::fstat(descriptor, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(HandHistoryHeader))) return;
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapped == MAP_FAILED) return;
+            ::madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            data = static_cast<const unsigned char*>(mapped);
+            length = static_cast<size_t>(info.st_size);
+#endif
+            const HandHistoryHeader* header = reinterpret_cast<const HandHistoryHeader*>(data);
+            if (!data || std::memcmp(header->magic, "THHLOG", 6) != 0 || 
+                header->version != VERSION || header->recordSize != sizeof(HandRecord)) {
+                return;
+            }
+            valid = true;
+            count = (length - sizeof(HandHistoryHeader)) / sizeof(HandRecord);
+        }
+
+        ~Reader() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+            if (data) ::munmap(const_cast<unsigned char*>(data), length);
+            if (descriptor >= 0) ::close(descriptor);
+#endif
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // 文件是否成功打开且格式正确
+        bool isOpen() const {
+            return valid;
+        }
+
+        // 记录数
+        size_t size() const {
+            return count;
+        }
+
+        // 访问第 i 条记录
+        const HandRecord& operator[](size_t i) const {
+            return begin()[i];
+        }
+
+        // 记录数组的首尾，可直接用于范围for循环
+        const HandRecord* begin() const {
+            return reinterpret_cast<const HandRecord*>(data + sizeof(HandHistoryHeader));
+        }
+        const HandRecord* end() const {
+            return begin() + count;
+        }
+    };
+}
+
+// 手牌统计 - 对大量模拟手牌做流式汇总：每个起手牌类别的胜率和比牌率、比牌频率、底池大小分布、各轮的牌型分布
+// 数据有两个来源：挂在牌桌上的事件接收器（复用手牌历史的记录端，每局结束时汇总一条记录）和手牌历史文件，
+// 两者都归结为 Histogram::add(HandRecord)，同样的牌局得到完全相同的统计。
+// 每个线程写自己的直方图（按缓存行对齐，不加锁），全部结束后再逐项相加合并；结果写成按列存放的二进制文件
+namespace HandStats {
+    const int POT_BUCKETS = 32;         // 底池大小分布的档数：第k档为 [2^k, 2^(k+1)) 个大盲注，第0档还包括不到1个大盲注的底池
+    const int STREETS = 4;              // 牌型分布的阶段：翻牌、转牌、河牌、比牌
+    const int RANKS = 9;                // 牌型种类数（HandRank）
+    const std::uint32_t VERSION = 1;    // 列式文件的格式版本
+
+    // 统计直方图，所有计数都是64位，可以汇总数十亿手
+    struct alignas(64) Histogram {
+        std::uint64_t hands = 0;                            // 手数
+        std::uint64_t showdowns = 0;                        // 进行了比牌的手数
+        std::uint64_t potChips = 0;                         // 底池总额（不包括退还的没有人跟到的下注）
+        std::uint64_t classDealt[Preflop::CLASS_COUNT] = {};        // 每个起手牌类别被发到的次数
+        std::uint64_t classWon[Preflop::CLASS_COUNT] = {};          // 其中赢得（或分得）底池的次数
+        std::uint64_t classShowdowns[Preflop::CLASS_COUNT] = {};    // 其中打到比牌的次数
+        std::uint64_t classShowdownWins[Preflop::CLASS_COUNT] = {}; // 其中在比牌中赢得（或分得）底池的次数
+        std::uint64_t pots[POT_BUCKETS] = {};               // 底池大小（以大盲注计）的分布
+        std::uint64_t ranks[STREETS][RANKS] = {};           // 每个阶段仍未弃牌的玩家当时的最好牌型
+
+        // 汇总一手牌
+        // 参数: record - 手牌记录
+        void add(const HandHistory::HandRecord& record) {
+            using namespace HandHistory;
+            hands++;
+            bool showdown = (record.flags & FLAG_SHOWDOWN) != 0;
+            showdowns += showdown;
+
+            // 每个座位弃牌的下注轮，没有弃牌为4
+            int foldRound[MAX_SEATS];
+            std::fill(std::begin(foldRound), std::end(foldRound), 4);
+            for (int i = 0; i < record.actionCount; i++) {
+                const ActionRecord& action = record.actions[i];
+                if ((action.kind & 3) == KIND_FOLD) foldRound[action.seat] = std::min(foldRound[action.seat], action.kind >> 2);
+            }
+
+            // 赢得的筹码不包括退还给下注者的没有人跟到的部分，底池也只算真正争夺的筹码
+            std::int64_t net[MAX_SEATS];
+            std::uint64_t pot = 0;
+            for (int s = 0; s < record.seatCount; s++) {
+                net[s] = record.won[s];
+                if (s == record.uncalledSeat) net[s] -= record.uncalled;
+                pot += static_cast<std::uint64_t>(std::max<std::int64_t>(net[s], 0));
+            }
+            potChips += pot;
+            std::uint64_t bigBlinds = pot / static_cast<std::uint64_t>(std::max(record.bigBlind, 1));
+            int bucket = 0;
+            while (bucket < POT_BUCKETS - 1 && (bigBlinds >> (bucket + 1)) != 0) bucket++;
+            pots[bucket]++;
+
+            // 翻牌、转牌、河牌时的公共牌
+            CardSet boards[3];
+            for (int i = 0; i < record.boardCount && i < 5; i++) {
+                for (int k = std::max(i - 2, 0); k < 3; k++) boards[k].add(Card::fromIndex(record.board[i]));
+            }
+
+            for (int s = 0; s < record.seatCount; s++) {
+                if (record.hole[s][0] == NO_CARD || record.hole[s][1] == NO_CARD) continue;
+                Card a = Card::fromIndex(record.hole[s][0]), b = Card::fromIndex(record.hole[s][1]);
+                int index = Preflop::classIndex(a, b);
+                bool won = net[s] > 0;
+                classDealt[index]++;
+                classWon[index] += won;
+                bool reachedShowdown = showdown && foldRound[s] == 4;
+                if (reachedShowdown) {
+                    classShowdowns[index]++;
+                    classShowdownWins[index] += won;
+                }
+                CardSet hole;
+                hole.add(a);
+                hole.add(b);
+                for (int street = 1; street <= 3; street++) {
+                    if (record.boardCount < street + 2 || foldRound[s] < street) break;
+                    int rank = static_cast<int>(HandEvaluator::getHandRank(HandEvaluator::evaluateValue(hole | boards[street - 1])));
+                    ranks[street - 1][rank]++;
+                    if (street == 3 && reachedShowdown) ranks[3][rank]++;
+                }
+            }
+        }
+
+        // 合并另一个直方图（逐项相加）
+        void merge(const Histogram& other) {
+            hands += other.hands;
+            showdowns += other.showdowns;
+            potChips += other.potChips;
+            for (int i = 0; i < Preflop::CLASS_COUNT; i++) {
+                classDealt[i] += other.classDealt[i];
+                classWon[i] += other.classWon[i];
+                classShowdowns[i] += other.classShowdowns[i];
+                classShowdownWins[i] += other.classShowdownWins[i];
+            }
+            for (int i = 0; i < POT_BUCKETS; i++) pots[i] += other.pots[i];
+            for (int s = 0; s < STREETS; s++) {
+                for (int r = 0; r < RANKS; r++) ranks[s][r] += other.ranks[s][r];
+            }
+        }
+    };
+
+    // 统计接收器 - 挂到牌桌上，每局结束时把记录汇总进当前绑定的直方图
+    // 多线程时每张牌桌一个接收器（保存正在进行的一局），开始运行前绑定到所在线程的直方图；
+    // 也可以同时把记录写入手牌历史文件
+    class Collector : public HandHistory::Recorder {
+    private:
+        Histogram* histogram;               // 当前绑定的直方图
+        HandHistory::Writer* log;           // 同时写入的记录文件，可以为空
+
+    protected:
+        void onRecord(const HandHistory::HandRecord& record) override {
+            if (histogram) histogram->add(record);
+            if (log) log->append(record);
+        }
+
+    public:
+        // 构造函数
+        // 参数:
+        //   target - 直方图，nullptr表示在第一局之前再用 bind() 绑定
+        //   writer - 同时写入的记录文件，nullptr表示不写
+        //   table - 牌桌编号
+        explicit Collector(Histogram* target = nullptr, HandHistory::Writer* writer = nullptr, std::uint32_t table = 0)
+            : Recorder(table), histogram(target), log(writer) {}
+
+        // 改为汇总进另一个直方图（牌局之间调用）
+        void bind(Histogram& target) {
+            histogram = &target;
+        }
+    };
+
+    // 列式文件 - 文件头之后是列目录，再后面是各列的数据；每列为连续存放的64位无符号整数（本机字节序，小端），
+    // 读取时按目录中的偏移直接访问一列，不需要解析。各列（名称: 长度）为：
+    //   hands、showdowns、pot_chips: 1          总手数、比牌手数、底池总额
+    //   class_dealt、class_won、class_showdowns、class_showdown_wins: 169   按起手牌类别索引（见 Preflop::classIndex）
+    //   pot_bb_log2: 32                         底池大小分布（第k档为 [2^k, 2^(k+1)) 个大盲注）
+    //   rank_flop、rank_turn、rank_river、rank_showdown: 9   每个阶段的牌型分布（按 HandRank）
+    struct FileHeader {
+        char magic[8];                  // "THSTAT\0\0"
+        std::uint32_t version;          // 格式版本
+        std::uint32_t columnCount;      // 列数
+    };
+
+    // 列目录的一项
+    struct ColumnEntry {
+        char name[24];                  // 列名（以0结尾）
+        std::uint64_t offset;           // 数据在文件中的偏移
+        std::uint64_t count;            // 元素个数
+    };
+
+    static_assert(sizeof(FileHeader) == 16, "FileHeader must stay 16 bytes");
+    static_assert(sizeof(ColumnEntry) == 40, "ColumnEntry must stay 40 bytes");
+
+    // 把直方图写成列式文件
+    // 参数:
+    //   path - 输出文件路径（覆盖已有文件）
+    //   histogram - 直方图
+    // 返回值: 写入成功返回true
+    inline bool writeColumns(const std::string& path, const Histogram& histogram) {
+        struct Column {
+            const char* name;
+            const std::uint64_t* data;
+            size_t count;
+        };
+        const Column columns[] = {
+            {"hands", &histogram.hands, 1},
+            {"showdowns", &histogram.showdowns, 1},
+            {"pot_chips", &histogram.potChips, 1},
+            {"class_dealt", histogram.classDealt, Preflop::CLASS_COUNT},
+            {"class_won", histogram.classWon, Preflop::CLASS_COUNT},
+            {"class_showdowns", histogram.classShowdowns, Preflop::CLASS_COUNT},
+            {"class_showdown_wins", histogram.classShowdownWins, Preflop::CLASS_COUNT},
+            {"pot_bb_log2", histogram.pots, POT_BUCKETS},
+            {"rank_flop", histogram.ranks[0], RANKS},
+            {"rank_turn", histogram.ranks[1], RANKS},
+            {"rank_river", histogram.ranks[2], RANKS},
+            {"rank_showdown", histogram.ranks[3], RANKS},
+        };
+        const std::uint32_t count = sizeof(columns) / sizeof(columns[0]);
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        FileHeader header = {{'T', 'H', 'S', 'T', 'A', 'T', 0, 0}, VERSION, count};
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        std::uint64_t offset = sizeof(FileHeader) + count * sizeof(ColumnEntry);
+        for (const Column& column : columns) {
+            ColumnEntry entry;
+            std::memset(&entry, 0, sizeof(entry));
+            std::strncpy(entry.name, column.name, sizeof(entry.name) - 1);
+            entry.offset = offset;
+            entry.count = column.count;
+            offset += column.count * sizeof(std::uint64_t);
+            ok = ok && std::fwrite(&entry, sizeof(entry), 1, file) == 1;
+        }
+        for (const Column& column : columns) {
+            ok = ok && std::fwrite(column.data, sizeof(std::uint64_t), column.count, file) == column.count;
+        }
+        return std::fclose(file) == 0 && ok;
+    }
+
+    // 输出统计摘要：比牌频率、平均底池、底池大小分布、各阶段的牌型分布，以及13×13的起手牌胜率网格
+    // 参数: histogram - 直方图
+    inline void printSummary(const Histogram& histogram) {
+        auto percent = [](std::uint64_t part, std::uint64_t total) {
+            return total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+        };
+        char line[160];
+        std::snprintf(line, sizeof(line), "统计 %llu 手，比牌 %llu 手（%.2f%%），平均底池 %.1f\n",
+                      static_cast<unsigned long long>(histogram.hands), static_cast<unsigned long long>(histogram.showdowns),
+                      percent(histogram.showdowns, histogram.hands),
+                      histogram.hands == 0 ? 0.0 : static_cast<double>(histogram.potChips) / static_cast<double>(histogram.hands));
+        std::cout << line;
+
+        std::cout << "\n底池大小分布（大盲注）:\n";
+        for (int k = 0; k < POT_BUCKETS; k++) {
+            if (histogram.pots[k] == 0) continue;
+            std::snprintf(line, sizeof(line), "  %10llu - %-10llu %7.2f%%\n",
+                          k == 0 ? 0ULL : 1ULL << k, (1ULL << (k + 1)) - 1, percent(histogram.pots[k], histogram.hands));
+            std::cout << line;
+        }
+
+        // 名称都是汉字（UTF-8 每字3字节，显示宽度为2），按显示宽度补齐
+        static const char* streets[STREETS] = {"翻牌", "转牌", "河牌", "比牌"};
+        std::cout << "\n牌型分布（仍未弃牌的玩家）:\n          ";
+        for (const char* street : streets) std::cout << "      " << street;
+        std::cout << "\n";
+        for (int r = 0; r < RANKS; r++) {
+            std::string name = HandEvaluator::getHandRankName(static_cast<HandRank>(r));
+            std::cout << "  " << name << std::string(8 - name.size() / 3 * 2, ' ');
+            for (int s = 0; s < STREETS; s++) {
+                std::uint64_t total = 0;
+                for (int k = 0; k < RANKS; k++) total += histogram.ranks[s][k];
+                std::snprintf(line, sizeof(line), "%9.2f%%", percent(histogram.ranks[s][r], total));
+                std::cout << line;
+            }
+            std::cout << "\n";
+        }
+
+        std::cout << "\n起手牌胜率（赢得或分得底池的比例，右上为同花，左下为不同花）:\n     ";
+        const char* rankNames = "23456789TJQKA";
+        for (int column = 12; column >= 0; column--) {
+            std::snprintf(line, sizeof(line), "%6c", rankNames[column]);
+            std::cout << line;
+        }
+        std::cout << "\n";
+        // 网格按 A 到 2 排列，对角线为对子，列的点数小于行时为同花
+        for (int row = 12; row >= 0; row--) {
+            std::snprintf(line, sizeof(line), "  %c  ", rankNames[row]);
+            std::cout << line;
+            for (int column = 12; column >= 0; column--) {
+                int index = Preflop::classIndex(row + 2, column + 2, column < row);
+                if (histogram.classDealt[index] == 0) {
+                    std::cout << "     -";
+                } else {
+                    std::snprintf(line, sizeof(line), "%6.1f", percent(histogram.classWon[index], histogram.classDealt[index]));
+                    std::cout << line;
+                }
+            }
+            std::cout << "\n";
+        }
+        std::cout.flush();
+    }
+}
+
+// 底池管理类 - 记录每个座位投入的筹码，在比牌时拆分主池和边池并分配给获胜者
+// 所有座位状态都用位掩码表示（座位上限22，一个32位整数足够），整个过程不分配内存
+class PotManager {
+public:
+    static const int MAX_SEATS = MAX_PLAYERS;   // 座位上限
+
+    // 一个底池（主池或边池）
+    struct Pot {
+        int amount;                 // 底池金额
+        std::uint32_t eligible;     // 有资格争夺该底池的座位（未弃牌且投入不少于本层金额）
+        std::uint32_t winners;      // 获胜的座位（resolve 之后有效）
+        int share;                  // 每位获胜者分得的金额
+        int remainder;              // 平分后的余数，归座位号最小的获胜者
+    };
+
+private:
+    int contributions[MAX_SEATS];   // 每个座位本局投入的筹码
+    int seatCount;                  // 座位数
+    int totalAmount;                // 投入总额
+    FixedVector<Pot, MAX_SEATS> pots;   // 拆分后的底池，第0个为主池
+
+public:
+    // 构造函数 - 创建空的底池
+    PotManager() : seatCount(0), totalAmount(0) {
+        reset(0);
+    }
+
+    // 开始新的一局
+    // 参数: seats - 座位数
+    void reset(int seats) {
+        seatCount = std::min(seats, MAX_SEATS);
+        totalAmount = 0;
+        std::fill(std::begin(contributions), std::end(contributions), 0);
+        pots.clear();
+    }
+
+    // 记录某个座位投入筹码
+    // 参数:
+    //   seat - 座位索引
+    //   amount - 投入的筹码
+    void add(int seat, int amount) {
+        contributions[seat] += amount;
+        totalAmount += amount;
+    }
+
+    // 投入总额
+    int total() const {
+        return totalAmount;
+    }
+
+    // 某个座位本局的投入
+    int contribution(int seat) const {
+        return contributions[seat];
+    }
+
+    // 没有人跟到的下注：投入最多的座位超出第二多投入的部分，分池时会原样退还给它
+    // 参数: seat - 输出投入最多的座位（返回0时不修改）
+    // 返回值: 没有人跟到的筹码，没有时为0
+    int uncalled(int& seat) const {
+        int top = -1, second = 0;
+        for (int i = 0; i < seatCount; i++) {
+            if (top < 0 || contributions[i] > contributions[top]) {
+                if (top >= 0) second = contributions[top];
+                top = i;
+            } else {
+                second = std::max(second, contributions[i]);
+            }
+        }
+        if (top < 0 || contributions[top] <= second) return 0;
+        seat = top;
+        return contributions[top] - second;
+    }
+
+    // 拆分底池：按投入金额排序一次，再从低到高逐层切出底池
+    // 每一层的金额 = (本层投入 - 上一层投入) × 投入不少于本层的座位数，
+    // 有资格争夺的是其中未弃牌的座位；资格相同的相邻层合并为同一个底池，
+    // 因此没有人全下时只会得到一个底池
+    // 参数: liveMask - 未弃牌的座位
+    // 返回值: 拆分后的底池，第0个为主池
+    const FixedVector<Pot, MAX_SEATS>& build(std::uint32_t liveMask) {
+        pots.clear();
+        int order[MAX_SEATS];
+        for (int i = 0; i < seatCount; i++) order[i] = i;
+        std::sort(order, order + seatCount, [this](int a, int b) {
+            return contributions[a] < contributions[b];
+        });
+
+        std::uint32_t atOrAbove = seatCount >= 32 ? ~0u : (1u << seatCount) - 1;  // 投入不少于当前层的座位
+        int previous = 0;
+        int carried = 0;  // 没有人有资格争夺的层，并入下一层
+        for (int i = 0; i < seatCount;) {
+            int level = contributions[order[i]];
+            if (level > previous) {
+                int amount = (level - previous) * (seatCount - i) + carried;
+                std::uint32_t eligible = atOrAbove & liveMask;
+                if (eligible == 0) {
+                    carried = amount;
+                } else if (!pots.empty() && pots.back().eligible == eligible) {
+                    pots.back().amount += amount;
+                    carried = 0;
+                } else {
+                    pots.push_back({amount, eligible, 0, 0, 0});
+                    carried = 0;
+                }
+                previous = level;
+            }
+            while (i < seatCount && contributions[order[i]] == level) {
+                atOrAbove &= ~(1u << order[i]);
+                i++;
+            }
+        }
+        if (carried > 0 && !pots.empty()) pots.back().amount += carried;
+        return pots;
+    }
+
+    // 拆分底池并决定每个底池的获胜者
+    // 参数:
+    //   liveMask - 未弃牌的座位
+    //   values - 每个座位预先算好的牌力值
+    // 返回值: 拆分后的底池，winners/share/remainder 已填写
+    const FixedVector<Pot, MAX_SEATS>& resolve(std::uint32_t liveMask, const HandEvaluator::HandValue* values) {
+        build(liveMask);
+        for (auto& pot : pots) {
+            HandEvaluator::HandValue best = 0;
+            for (int seat = 0; seat < seatCount; seat++) {
+                if ((pot.eligible >> seat) & 1) best = std::max(best, values[seat]);
+            }
+            pot.winners = 0;
+            for (int seat = 0; seat < seatCount; seat++) {
+                if (((pot.eligible >> seat) & 1) && values[seat] == best) pot.winners |= 1u << seat;
+            }
+            int count = popCount(pot.winners);
+            pot.share = pot.amount / count;
+            pot.remainder = pot.amount % count;
+        }
+        return pots;
+    }
+};
+
+// 座位表 - 下注循环用到的座位状态，按"结构数组"存放
+// 筹码和当前下注各是一个连续数组，在局中、已弃牌、筹码为0三种状态各是一个位掩码（第i位对应第i个座位），
+// 活跃人数只需一次 popcount，"下一位活跃玩家"只需一次循环移位加一次 count-trailing-zeros，
+// 22个座位的全部数据也只占两三条缓存行。每局开始时从 Player 同步一次，之后由 TexasHoldem 与 Player 同时更新
+class SeatTable {
+public:
+    static const int MAX_SEATS = MAX_PLAYERS;   // 座位上限
+
+private:
+    int chips[MAX_SEATS];       // 每个座位的筹码
+    int bets[MAX_SEATS];        // 每个座位当前的下注金额
+    std::uint32_t inGame;       // 在本局中的座位
+    std::uint32_t folded;       // 已弃牌的座位
+    std::uint32_t empty;        // 筹码为0的座位（在局且未弃牌时即为全下）
+    int seatCount;              // 座位数
+
+    static std::uint32_t bit(int seat) { return 1u << seat; }
+
+public:
+    // 构造函数 - 创建空的座位表
+    SeatTable() : inGame(0), folded(0), empty(0), seatCount(0) {
+        std::fill(std::begin(chips), std::end(chips), 0);
+        std::fill(std::begin(bets), std::end(bets), 0);
+    }
+
+    // 从玩家列表同步全部座位状态（每局开始、玩家状态重置之后调用）
+    // 参数: players - 玩家列表
+    void reset(const PlayerList& players) {
+        seatCount = static_cast<int>(std::min<size_t>(players.size(), MAX_SEATS));
+        inGame = folded = empty = 0;
+        for (int i = 0; i < seatCount; i++) {
+            const Player& player = players[i];
+            chips[i] = player.getChips();
+            bets[i] = player.getCurrentBet();
+            if (player.getIsInGame()) inGame |= bit(i);
+            if (player.getHasFolded()) folded |= bit(i);
+            if (chips[i] == 0) empty |= bit(i);
+        }
+    }
+
+    // 记录某个座位投入筹码（金额不超过其筹码）
+    void commit(int seat, int amount) {
+        chips[seat] -= amount;
+        bets[seat] += amount;
+        if (chips[seat] == 0) empty |= bit(seat);
+    }
+
+    // 记录某个座位赢得筹码
+    void win(int seat, int amount) {
+        chips[seat] += amount;
+        if (chips[seat] > 0) empty &= ~bit(seat);
+    }
+
+    // 记录某个座位弃牌
+    void fold(int seat) {
+        folded |= bit(seat);
+    }
+
+    // 某个座位当前的下注金额
+    int bet(int seat) const {
+        return bets[seat];
+    }
+
+    // 在本局中且未弃牌的座位
+    std::uint32_t liveMask() const {
+        return inGame & ~folded;
+    }
+
+    // 还能行动的座位（在本局中、未弃牌且未全下）
+    std::uint32_t actingMask() const {
+        return inGame & ~folded & ~empty;
+    }
+
+    // 在本局中且未弃牌的人数
+    int liveCount() const {
+        return popCount(liveMask());
+    }
+
+    // 还能行动的人数
+    int actingCount() const {
+        return popCount(actingMask());
+    }
+
+    // 某个座位是否还能行动
+    bool isActing(int seat) const {
+        return (actingMask() >> seat) & 1;
+    }
+
+    // 在本局中且未弃牌的座位中的最高下注
+    int maxLiveBet() const {
+        int best = 0;
+        for (std::uint32_t m = liveMask(); m != 0; m &= m - 1) {
+            best = std::max(best, bets[countTrailingZeros(m)]);
+        }
+        return best;
+    }
+
+    // 是否有还能行动的座位下注少于 amount（即还需要行动）
+    bool anyActingBelow(int amount) const {
+        for (std::uint32_t m = actingMask(); m != 0; m &= m - 1) {
+            if (bets[countTrailingZeros(m)] < amount) return true;
+        }
+        return false;
+    }
+
+    // 从 seat 的下一位开始按座位顺序循环查找，返回第一个在本局中且未弃牌的座位
+    // 把活跃掩码循环右移到 seat 的下一位，最低的1即为所求；只有 seat 自己活跃时返回 seat
+    // 参数: seat - 起始座位
+    // 返回值: 座位索引，没有活跃座位时返回-1
+    int nextLive(int seat) const {
+        std::uint32_t live = liveMask();
+        if (live == 0 || seatCount == 0) return -1;
+        int shift = (seat + 1) % seatCount;
+        std::uint32_t all = seatCount >= 32 ? ~0u : bit(seatCount) - 1;
+        std::uint32_t rotated = ((live >> shift) | (live << (seatCount - shift))) & all;
+        return (countTrailingZeros(rotated) + shift) % seatCount;
+    }
+};
+
+// 牌桌快照 - 一张牌桌完整状态的二进制格式，用于检查点和在进程之间迁移牌桌
+// 快照是不含指针的普通结构，所有字段按本机字节序（小端）存放；内存中总是留出 MAX_SEATS 个座位，
+// 但只有固定的表头（136字节）和实际的 seatCount 个座位（每个32字节）有意义，
+// 写入文件或通过网络发送时只需前 size 字节（6人桌328字节），读回时用 load() 放进完整的结构。
+// 恢复时只做范围检查，不需要解析
+namespace Snapshot {
+    const int MAX_SEATS = MAX_PLAYERS;  // 座位上限
+    const int NAME_BYTES = 16;          // 玩家名称最多保存的字节数
+    const std::uint8_t NO_CARD = 0xFF;  // 没有牌的位置
+    const std::uint32_t VERSION = 1;    // 格式版本
+
+    // 座位标志
+    enum SeatFlags : std::uint8_t {
+        SEAT_IN_GAME = 1,               // 在本局中
+        SEAT_FOLDED = 2,                // 已弃牌
+        SEAT_SMALL_BLIND = 4,           // 小盲注
+        SEAT_BIG_BLIND = 8              // 大盲注
+    };
+
+    // 一个座位（32字节）
+    struct SeatState {
+        std::int32_t chips;             // 筹码（不含当前下注）
+        std::int32_t bet;               // 当前下注金额
+        std::int32_t contribution;      // 本局投入底池的筹码
+        std::uint8_t hole[2];           // 两张底牌（Card::getIndex），没有时为 NO_CARD
+        std::uint8_t flags;             // SeatFlags 的组合
+        std::uint8_t nameLength;        // 名称的字节数
+        char name[NAME_BYTES];          // 玩家名称（UTF-8，不以0结尾）
+    };
+
+    // 一张牌桌（表头136字节，之后是 seatCount 个座位）
+    struct TableState {
+        char magic[8];                  // "THSNAP\0\0"
+        std::uint32_t version;          // 格式版本
+        std::uint32_t size;             // 快照有意义的字节数（见 byteSize）
+        std::uint64_t rng[4];           // 随机数引擎的内部状态
+        std::int32_t pot;               // 底池金额
+        std::int32_t currentBet;        // 当前最高下注金额
+        std::int32_t smallBlind;        // 小盲注金额
+        std::int32_t bigBlind;          // 大盲注金额
+        std::uint8_t seatCount;         // 座位数
+        std::uint8_t dealer;            // 庄家位置
+        std::uint8_t round;             // 当前轮次（0-3）
+        std::int8_t lastAggressor;      // 最后一个加注的座位，-1表示没有
+        std::uint8_t deckCount;         // 牌堆中剩余的牌数
+        std::uint8_t boardCount;        // 公共牌数量
+        std::uint8_t lazyDeck;          // 为1时牌堆中剩余的牌还没有洗（懒洗牌，之后发牌时用 rng 逐张洗）
+        std::uint8_t reserved;
+        std::uint8_t deck[52];          // 牌堆，deck[0] 在底部，deck[deckCount - 1] 是下一张发出的牌
+        std::uint8_t board[5];          // 公共牌
+        std::uint8_t reserved2[7];
+        SeatState seats[MAX_SEATS];     // 座位，只有前 seatCount 个有意义
+    };
+
+    static_assert(sizeof(SeatState) == 32, "SeatState must stay 32 bytes");
+    static_assert(offsetof(TableState, seats) == 136, "TableState header must stay 136 bytes");
+
+    // 有 seatCount 个座位的快照的字节数
+    constexpr std::uint32_t byteSize(int seatCount) {
+        return static_cast<std::uint32_t>(offsetof(TableState, seats) + seatCount * sizeof(SeatState));
+    }
+
+    // 名称保存的字节数：不超过 NAME_BYTES，且不把 UTF-8 字符截成两半
+    // 参数: name - 玩家名称
+    inline int nameLength(const std::string& name) {
+        size_t length = std::min<size_t>(name.size(), NAME_BYTES);
+        if (length < name.size()) {
+            while (length > 0 && (static_cast<unsigned char>(name[length]) & 0xC0) == 0x80) length--;
+        }
+        return static_cast<int>(length);
+    }
+
+    // 检查快照的格式和内容：编号、版本和长度一致，计数和座位索引在范围内，筹码不为负，牌不重复
+    // 参数: state - 快照
+    // 返回值: 快照是否可以恢复
+    inline bool isValid(const TableState& state) {
+        if (std::memcmp(state.magic, "THSNAP", 6) != 0 || state.version != VERSION || state.seatCount > MAX_SEATS ||
+            state.size != byteSize(state.seatCount)) {
+            return false;
+        }
+        if ( state.round > 3 || state.deckCount > 52 || state.boardCount > 5 ||
+            (state.seatCount > 0 && state.dealer >= state.seatCount) || state.lastAggressor < -1 ||
+            state.lastAggressor >= static_cast<int>(state.seatCount) || state.lazyDeck > 1 ||
+            state.pot < 0 || state.currentBet < 0 || state.smallBlind < 0 || state.bigBlind < 0) {
+            return false;
+        }
+        std::uint64_t seen = 0;
+        int cards = 0;
+        auto use = [&seen, &cards](std::uint8_t card) {
+            if (card >= 52) return false;
+            seen |= std::uint64_t(1) << card;
+            cards++;
+            return true;
+        };
+        for (int i = 0; i < state.deckCount; i++) {
+            if (!use(state.deck[i])) return false;
+        }
+        for (int i = 0; i < state.boardCount; i++) {
+            if (!use(state.board[i])) return false;
+        }
+        for (int s = 0; s < state.seatCount; s++) {
+            const SeatState& seat = state.seats[s];
+            if (seat.chips < 0 || seat.bet < 0 || seat.contribution < 0 || seat.nameLength > NAME_BYTES) return false;
+            for (std::uint8_t card : seat.hole) {
+                if (card != NO_CARD && !use(card)) return false;
+            }
+        }
+        return popCount(seen) == cards;
+    }
+
+    // 读回写出的快照：把前 size 字节放进 state，多出的座位清零
+    // 参数:
+    //   data - 快照数据（从文件或网络读到的字节）
+    //   length - 数据的字节数
+    //   state - 输出的快照
+    // 返回值: 数据长度与快照记录的 size 一致且快照合法（见 isValid）时返回true
+    inline bool load(const void* data, size_t length, TableState& state) {
+        std::memset(&state, 0, sizeof(state));
+        if (length < offsetof(TableState, seats) || length > sizeof(TableState)) return false;
+        std::memcpy(&state, data, length);
+        return state.size == length && isValid(state);
+    }
+}
+
+// 德州扑克游戏类 - 管理整个德州扑克游戏的流程和规则
+// 这是游戏的核心类，负责协调整个游戏过程，包括发牌、下注、比牌和筹码分配
+class TexasHoldem {
+    friend class BenchmarkSuite;  // 性能测试需要直接构造比牌局面
+
+private:
+    Deck deck;                  // 游戏使用的牌堆
+    PlayerList players;         // 游戏中的玩家列表
+    SeatTable seats;            // 下注循环使用的座位状态，与 players 同步更新
+    BoardCards communityCards;  // 公共牌（最多5张）
+    CardSet communityMask;      // 公共牌的掩码，与 communityCards 同步更新
+    int pot;                    // 底池金额，所有玩家下注的筹码总和
+    int currentRound;           // 当前轮次（0:pre-flop, 1:flop, 2:turn, 3:river）
+    int dealerPosition;         // 庄家位置索引
+    int smallBlindAmount;       // 小盲注金额（大盲注的一半）
+    int bigBlindAmount;         // 大盲注金额
+    int currentBetAmount;       // 当前最高下注金额
+    int lastAggressorIndex;     // 最后一个加注的玩家索引
+    Xoshiro256 rng;             // 本桌的随机数引擎，整个牌桌生命周期只设置一次种子
+    Agent* defaultAgent;        // 未单独设置代理的座位使用的代理
+    FixedVector<Agent*, MAX_PLAYERS> agents; // 每个座位单独设置的代理（nullptr表示使用默认代理）
+    GameEventSink* sink;        // 牌局事件接收器
+    FixedVector<HandEvaluator::HandValue, MAX_PLAYERS> handValues; // 比牌时每位玩家的牌力值
+    FixedVector<HandEvaluator::IncrementalHand, MAX_PLAYERS> handStates; // 每位玩家的增量评估状态，发牌时更新
+    PotManager potManager;      // 记录每个座位的投入，比牌时拆分主池和边池
+    std::vector<Card> stackedOrder; // 下一局预先指定的发牌顺序（回放用）
+    bool deckStacked;           // 下一局是否使用 stackedOrder 代替洗牌
+
+    // 清空所有玩家的增量评估状态（每局开始时调用）
+    void resetHandStates() {
+        handStates.resize(players.size());
+        for (auto& state : handStates) state.clear();
+    }
+
+    // 给一名玩家发一张底牌，同时更新其增量评估状态
+    // 参数: playerIndex - 玩家索引
+    void dealHoleCard(int playerIndex) {
+        Card card = deck.dealCard(rng);
+        players[playerIndex].addCard(card);
+        handStates[playerIndex].add(card);
+    }
+
+    // 发出一张公共牌，并加入每位仍在本局中的玩家的增量评估状态
+    // 参数: card - 公共牌
+    void addCommunityCard(const Card& card) {
+        communityCards.push_back(card);
+        communityMask.add(card);
+        std::uint32_t live = seats.liveMask();
+        for (size_t i = 0; i < handStates.size(); i++) {
+            if ((live >> i) & 1) handStates[i].add(card);
+        }
+    }
+
+    // 玩家投入筹码：扣除筹码、增加底池并记录到底池管理器
+    // 参数:
+    //   playerIndex - 玩家索引
+    //   amount - 投入金额，超过玩家筹码时只投入剩余的全部筹码
+    // 返回值: 实际投入的金额
+    int commitChips(int playerIndex, int amount) {
+        Player& player = players[playerIndex];
+        amount = std::min(amount, player.getChips());
+        player.placeBet(amount);
+        seats.commit(playerIndex, amount);
+        pot += amount;
+        potManager.add(playerIndex, amount);
+        return amount;
+    }
+
+    // 玩家赢得筹码，同时更新座位表
+    // 参数:
+    //   playerIndex - 玩家索引
+    //   amount - 赢得的筹码
+    void awardChips(int playerIndex, int amount) {
+        players[playerIndex].winChips(amount);
+        seats.win(playerIndex, amount);
+    }
+
+    // 获取还能行动的玩家数量（在游戏中、未弃牌且未全下）
+    int getActingPlayerCount() const {
+        return seats.actingCount();
+    }
+
+    // 获取活跃玩家数量（在游戏中且未弃牌的玩家）
+    // 返回值: 当前仍在参与游戏且未弃牌的玩家数量
+    int getActivePlayerCount() const {
+        return seats.liveCount();
+    }
+
+    // 获取下一个活跃玩家的索引（从当前玩家的下一位开始循环查找，只有当前玩家活跃时返回其自身）
+    // 参数: currentIndex - 当前玩家索引
+    // 返回值: 下一个活跃玩家的索引，如果没有活跃玩家则返回-1
+    int getNextActivePlayerIndex(int currentIndex) const {
+        return seats.nextLive(currentIndex);
+    }
+
+    // 获取某个座位的代理，未单独设置时使用默认代理
+    Agent& agentFor(int playerIndex) {
+        Agent* agent = agents[playerIndex];
+        return agent ? *agent : *defaultAgent;
+    }
+
+    // 处理玩家操作（弃牌/跟注/加注）
+    // 这是游戏中玩家交互的核心方法：向代理询问决策，再按规则执行
+    // 参数:
+    //   playerIndex - 当前玩家的索引
+    //   maxBet - 当前最高下注金额的引用，用于更新
+    void handlePlayerAction(int playerIndex, int& maxBet) {
+        Player& player = players[playerIndex];
+        if (!seats.isActing(playerIndex)) return; // 跳过不在游戏、已弃牌或已全下的玩家
+
+        // 计算需要跟注的金额和最小加注金额（需要跟注的金额 + 大盲注）
+        int toCall = maxBet - player.getCurrentBet();
+        int minRaise = (toCall > 0 ? toCall : 0) + bigBlindAmount;
+
+        DecisionContext context{playerIndex, player, std::max(toCall, 0), minRaise, maxBet, 
+                                pot, currentRound, communityCards, communityMask, handStates[playerIndex],
+                                getActivePlayerCount() - 1};
+        PlayerAction action = agentFor(playerIndex).decide(context);
+
+        // 根据玩家选择执行相应操作
+        switch (action.type) {
+            case ActionType::FOLD: // 弃牌
+                player.setHasFolded(true);
+                seats.fold(playerIndex);
+                sink->onAction(playerIndex, player, action);
+                break;
+                
+            case ActionType::CALL: // 跟注
+                action.amount = commitChips(playerIndex, std::max(toCall, 0));
+                if (player.getChips() == 0 && action.amount > 0) {
+                    sink->onAllIn(playerIndex, player, action.amount); // 筹码不足以跟注时全下
+                } else {
+                    sink->onAction(playerIndex, player, action);
+                }
+                break;
+                
+            case ActionType::RAISE: // 加注
+                action.amount = std::max(action.amount, minRaise);
+                if (toCall + action.amount >= player.getChips()) {
+                    // 筹码不够完成加注时全下，超过当前最高下注的部分仍算作加注
+                    int amount = commitChips(playerIndex, player.getChips());
+                    if (player.getCurrentBet() > maxBet) {
+                        maxBet = player.getCurrentBet();
+                        lastAggressorIndex = playerIndex;
+                    }
+                    sink->onAllIn(playerIndex, player, amount);
+                } else {
+                    commitChips(playerIndex, toCall + action.amount);
+                    maxBet = player.getCurrentBet(); // 更新最高下注金额
+                    lastAggressorIndex = playerIndex; // 更新最后加注者
+                    sink->onAction(playerIndex, player, action);
+                }
+                break;
+        }
+    }
+
+    // 进行一轮下注
+    // 这是德州扑克游戏的核心环节，处理玩家之间的下注交互
+    // 实现了标准的德州扑克下注规则，包括跟注、加注和弃牌
+    // 参数:
+    //   startPlayerIndex - 本轮下注开始的玩家索引
+    void bettingRound(int startPlayerIndex) {
+        // 如果只有一个或没有活跃玩家，无需下注
+        if (getActivePlayerCount() <= 1) return;
+        
+        // 重置当前最高下注金额和最后加注者索引
+        currentBetAmount = 0;
+        lastAggressorIndex = -1;
+        
+        // 重置当前下注金额，考虑盲注或之前下注
+        currentBetAmount = seats.maxLiveBet();
+
+        // 其他人都已全下时，剩下的唯一一名玩家只要已经跟到最高下注就无需再行动
+        int acting = getActingPlayerCount();
+        if (acting == 0) return;
+        if (acting == 1 && !seats.anyActingBelow(currentBetAmount)) return;
+        
+        // 设置当前玩家和第一个玩家索引
+        int currentPlayerIndex = startPlayerIndex;
+        int firstPlayerIndex = startPlayerIndex;
+        bool allCalled = false;
+        
+        // 下注主循环，直到所有玩家都完成了跟注或只剩一个玩家
+        while (!allCalled) {
+            Instrumentation::count(Instrumentation::BETTING_ITERATIONS);
+            // 处理当前玩家的操作
+            handlePlayerAction(currentPlayerIndex, currentBetAmount);
+            
+            // 检查是否只有一个玩家剩余
+            if (getActivePlayerCount() <= 1) break;
+            
+            // 检查是否所有玩家都已跟注到当前最高金额（已全下的玩家视为已跟注）
+            allCalled = !seats.anyActingBelow(currentBetAmount);
+            
+            if (allCalled) break;
+            
+            // 获取下一个活跃玩家
+            currentPlayerIndex = getNextActivePlayerIndex(currentPlayerIndex);
+            
+            // 如果回到第一个玩家且有玩家加注过，则从最后加注者的下一位继续下注轮
+            // 这是德州扑克规则中的必要环节，确保每位玩家都有机会对新的加注做出反应
+            if (currentPlayerIndex == firstPlayerIndex && lastAggressorIndex != -1) {
+                firstPlayerIndex = getNextActivePlayerIndex(lastAggressorIndex);
+                currentPlayerIndex = firstPlayerIndex;
+            }
+        }
+    }
+
+    // 进行比牌并分配筹码
+    // 在游戏的最后阶段，所有未弃牌的玩家展示手牌进行比较
+    // 实现了牌型评估、比较和筹码分配的完整逻辑
+    void showdown() {
+        // 获取所有活跃玩家（未弃牌）
+        FixedVector<int, MAX_PLAYERS> remainingPlayers;
+        for (std::uint32_t m = seats.liveMask(); m != 0; m &= m - 1) {
+            remainingPlayers.push_back(countTrailingZeros(m));
+        }
+        
+        // 如果没有剩余玩家，输出提示
+        if (remainingPlayers.empty()) {
+            sink->onNoPlayersLeft();
+            return;
+        }
+
+        // 没有人跟到的下注会随底池一起发回给下注者，先单独报告，便于统计区分退还和赢得的筹码
+        int uncalledSeat = -1;
+        int uncalled = potManager.uncalled(uncalledSeat);
+        if (uncalled > 0) sink->onUncalledBet(uncalledSeat, players[uncalledSeat], uncalled);
+        
+        // 如果只有一个玩家剩余，直接赢取底池（没有对手）
+        if (remainingPlayers.size() == 1) {
+            // 只有一个玩家剩余，直接赢取底池
+            int winnerIndex = remainingPlayers[0];
+            awardChips(winnerIndex, pot);
+            sink->onWinner(winnerIndex, players[winnerIndex], pot);
+            return;
+        }
+        
+        // 每位玩家的牌力已随发牌增量更新，这里只读取一次，后面的显示和比较都使用同一组牌力值
+        std::uint32_t live = seats.liveMask();
+        handValues.resize(players.size());
+        for (size_t i = 0; i < players.size(); i++) {
+            handValues[i] = ((live >> i) & 1) && i < handStates.size() ? handStates[i].value() : 0;
+        }
+
+        // 显示所有剩余玩家的手牌和牌型
+        sink->onShowdownStart();
+        for (int playerIndex : remainingPlayers) {
+            sink->onShowdownHand(playerIndex, players[playerIndex], 
+                                 HandEvaluator::getHandRank(handValues[playerIndex]));
+        }
+        
+        // 拆分主池和边池，每个底池的获胜者直接由预先算好的牌力值决定
+        const auto& pots = potManager.resolve(live, handValues.data());
+
+        for (size_t k = 0; k < pots.size(); k++) {
+            const PotManager::Pot& current = pots[k];
+            if (pots.size() > 1) sink->onPotStart(static_cast<int>(k), current.amount);
+
+            // 分配底池，处理单人和多人获胜的情况
+            if (popCount(current.winners) > 1) {
+                // 平局情况下，平分底池
+                sink->onSplitPot();
+                int first = -1;
+                for (size_t i = 0; i < players.size(); i++) {
+                    if ((current.winners >> i) & 1) {
+                        if (first < 0) first = static_cast<int>(i);
+                        awardChips(static_cast<int>(i), current.share);
+                        sink->onPotShare(static_cast<int>(i), players[i], current.share);
+                    }
+                }
+                // 处理余数（可能由于除法取整），将余数分配给第一个玩家
+                if (current.remainder > 0) {
+                    awardChips(first, current.remainder);
+                    sink->onRemainder(first, players[first], current.remainder);
+                }
+            } else {
+                // 单人获胜情况
+                for (size_t i = 0; i < players.size(); i++) {
+                    if ((current.winners >> i) & 1) {
+                        awardChips(static_cast<int>(i), current.amount);
+                        sink->onWinner(static_cast<int>(i), players[i], current.amount);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    // 构造函数 - 初始化德州扑克游戏实例
+    // 设置游戏的初始状态，包括底池、轮次、庄家位置和盲注金额
+    // 随机数引擎以真随机数设置种子
+    TexasHoldem() : TexasHoldem(Xoshiro256::randomSeed()) {}
+
+    // 构造函数 - 以固定种子初始化，同样的种子和同样的操作序列会得到完全相同的牌局
+    // 参数: seed - 随机数种子
+    explicit TexasHoldem(std::uint64_t seed) 
+        : pot(0), currentRound(0), dealerPosition(0), 
+          smallBlindAmount(50), bigBlindAmount(100), 
+          currentBetAmount(0), lastAggressorIndex(-1), rng(seed),
+          defaultAgent(&consoleAgent()), sink(&consoleSink()), deckStacked(false) {}
+
+    // 标准输入输出上的控制台代理和事件接收器（默认使用）
+    static ConsoleAgent& consoleAgent() {
+        static ConsoleAgent agent;
+        return agent;
+    }
+    static ConsoleEventSink& consoleSink() {
+        static ConsoleEventSink consoleSink;
+        return consoleSink;
+    }
+
+    // 设置默认代理（未单独设置代理的座位都使用它）
+    // 参数: agent - 代理，由调用者负责其生命周期
+    void setDefaultAgent(Agent* agent) {
+        defaultAgent = agent;
+    }
+
+    // 为某个座位单独设置代理
+    // 参数:
+    //   playerIndex - 座位索引
+    //   agent - 代理，nullptr表示恢复为默认代理；由调用者负责其生命周期
+    void setAgent(int playerIndex, Agent* agent) {
+        agents[playerIndex] = agent;
+    }
+
+    // 设置事件接收器，例如 NullEventSink 用于无输出的高速模拟
+    // 参数: eventSink - 事件接收器，由调用者负责其生命周期
+    void setEventSink(GameEventSink* eventSink) {
+        sink = eventSink;
+    }
+
+    // 获取玩家列表
+    const PlayerList& getPlayers() const {
+        return players;
+    }
+
+    // 重新设置随机数种子
+    // 参数: seed - 随机数种子
+    void setSeed(std::uint64_t seed) {
+        rng.seed(seed);
     }
 
     // 添加玩家（确保玩家数量在2-22之间）
     // 参数:
-    //   player - 要添加到游戏中的玩家对象
-    // 返回值:
-    //   如果添加成功返回true，如果达到玩家数量上限返回false
-    bool addPlayer(const Player& player) {
-        if (players.size() >= 22) {
-            std::cout << "达到最大玩家数量限制（22人）。" << std::endl;
-            return false;
+    //   player - 要添加到游戏中的玩家对象
+    // 返回值:
+    //   如果添加成功返回true，如果达到玩家数量上限返回false
+    bool addPlayer(const Player& player) {
+        if (players.size() >= MAX_PLAYERS) {
+            sink->onTableFull();
+            return false;
+        }
+        players.push_back(player);
+        agents.push_back(nullptr);
+        return true;
+    }
+
+    // 设置盲注金额
+    // 参数:
+    //   smallBlind - 小盲注金额
+    //   bigBlind - 大盲注金额（同时也是最小加注额）
+    void setBlinds(int smallBlind, int bigBlind) {
+        smallBlindAmount = smallBlind;
+        bigBlindAmount = bigBlind;
+    }
+
+    // 设置庄家位置（牌局之间调用）
+    // 参数: position - 座位索引
+    void setDealerPosition(int position) {
+        dealerPosition = position;
+    }
+
+    // 设置一名玩家的筹码（牌局之间调用）
+    // 参数:
+    //   playerIndex - 座位索引
+    //   chips - 筹码数量
+    void setChips(int playerIndex, int chips) {
+        players[playerIndex].setChips(chips);
+    }
+
+    // 指定下一局的发牌顺序，下一局不再洗牌（只作用一局）
+    // 参数: order - 依次发出的牌：两轮底牌、烧牌、翻牌、烧牌、转牌、烧牌、河牌，未列出的牌排在后面
+    void stackNextDeck(const std::vector<Card>& order) {
+        stackedOrder = order;
+        deckStacked = true;
+    }
+
+    // 移除一名玩家（牌局之间调用），庄家位置随之调整，保持其余玩家的相对顺序
+    // 参数: playerIndex - 座位索引
+    // 返回值: 被移除的玩家
+    Player removePlayer(int playerIndex) {
+        Player player = players[playerIndex];
+        players.erase(players.begin() + playerIndex);
+        agents.erase(agents.begin() + playerIndex);
+        if (playerIndex < dealerPosition) dealerPosition--;
+        if (dealerPosition >= static_cast<int>(players.size())) dealerPosition = 0;
+        return player;
+    }
+
+    // 生成牌桌快照 - 记录牌堆、座位、筹码、当前下注、盲注、庄家位置、轮次、底池、最后加注者和随机数引擎的状态
+    // 不分配内存；超过 Snapshot::NAME_BYTES 字节的玩家名称按完整的字符截断。
+    // 代理、事件接收器和回放用的叠牌不属于牌桌状态，不在快照中
+    // 返回值: 快照
+    Snapshot::TableState snapshot() const {
+        Snapshot::TableState state;
+        std::memset(&state, 0, sizeof(state));
+        std::memcpy(state.magic, "THSNAP", 6);
+        state.version = Snapshot::VERSION;
+        state.size = Snapshot::byteSize(static_cast<int>(players.size()));
+        rng.getState(state.rng);
+        state.pot = pot;
+        state.currentBet = currentBetAmount;
+        state.smallBlind = smallBlindAmount;
+        state.bigBlind = bigBlindAmount;
+        state.seatCount = static_cast<std::uint8_t>(players.size());
+        state.dealer = static_cast<std::uint8_t>(dealerPosition);
+        state.round = static_cast<std::uint8_t>(currentRound);
+        state.lastAggressor = static_cast<std::int8_t>(lastAggressorIndex);
+        state.deckCount = static_cast<std::uint8_t>(deck.size());
+        state.lazyDeck = deck.isLazy() ? 1 : 0;
+        for (size_t i = 0; i < deck.size(); i++) state.deck[i] = static_cast<std::uint8_t>(deck.at(i).getIndex());
+        state.boardCount = static_cast<std::uint8_t>(communityCards.size());
+        for (size_t i = 0; i < communityCards.size(); i++) {
+            state.board[i] = static_cast<std::uint8_t>(communityCards[i].getIndex());
+        }
+        for (size_t s = 0; s < players.size(); s++) {
+            const Player& player = players[s];
+            Snapshot::SeatState& seat = state.seats[s];
+            seat.chips = player.getChips();
+            seat.bet = player.getCurrentBet();
+            seat.contribution = potManager.contribution(static_cast<int>(s));
+            const HoleCards& hand = player.getHand();
+            for (size_t c = 0; c < 2; c++) {
+                seat.hole[c] = c < hand.size() ? static_cast<std::uint8_t>(hand[c].getIndex()) : Snapshot::NO_CARD;
+            }
+            seat.flags = (player.getIsInGame() ? Snapshot::SEAT_IN_GAME : 0) |
+                         (player.getHasFolded() ? Snapshot::SEAT_FOLDED : 0) |
+                         (player.getIsSmallBlind() ? Snapshot::SEAT_SMALL_BLIND : 0) |
+                         (player.getIsBigBlind() ? Snapshot::SEAT_BIG_BLIND : 0);
+            int length = Snapshot::nameLength(player.getName());
+            seat.nameLength = static_cast<std::uint8_t>(length);
+            std::memcpy(seat.name, player.getName().data(), length);
+        }
+        return state;
+    }
+
+    // 从快照恢复牌桌状态，快照不合法（见 Snapshot::isValid）时不做任何修改
+    // 只保存了 Snapshot::NAME_BYTES 字节的玩家名称（见 snapshot()），较长的名称恢复后是截断后的名称。
+    // 已单独设置的代理按座位保留，多出的座位使用默认代理。
+    // 牌局之间生成的快照恢复后，之后的每一局都与原牌桌完全相同（同样的牌序和随机数）；
+    // 局中生成的快照（例如在代理的回调里）同样完整恢复全部状态，但 startGame 总是开始新的一局，迁移牌桌应在牌局之间进行
+    // 参数: state - 快照
+    // 返回值: 恢复成功返回true
+    bool restore(const Snapshot::TableState& state) {
+        if (!Snapshot::isValid(state)) return false;
+        players.clear();
+        potManager.reset(state.seatCount);
+        for (int s = 0; s < state.seatCount; s++) {
+            const Snapshot::SeatState& seat = state.seats[s];
+            Player& player = players.emplace_back(std::string(seat.name, seat.nameLength), seat.chips + seat.bet);
+            player.placeBet(seat.bet);
+            for (std::uint8_t card : seat.hole) {
+                if (card != Snapshot::NO_CARD) player.addCard(Card::fromIndex(card));
+            }
+            player.setIsInGame((seat.flags & Snapshot::SEAT_IN_GAME) != 0);
+            player.setHasFolded((seat.flags & Snapshot::SEAT_FOLDED) != 0);
+            player.setIsSmallBlind((seat.flags & Snapshot::SEAT_SMALL_BLIND) != 0);
+            player.setIsBigBlind((seat.flags & Snapshot::SEAT_BIG_BLIND) != 0);
+            potManager.add(s, seat.contribution);
+        }
+        agents.resize(players.size());
+
+        deck.restore(state.deck, state.deckCount, state.lazyDeck != 0);
+        communityCards.clear();
+        communityMask = CardSet();
+        for (int i = 0; i < state.boardCount; i++) {
+            communityCards.push_back(Card::fromIndex(state.board[i]));
+            communityMask.add(communityCards.back());
+        }
+
+        rng.setState(state.rng);
+        pot = state.pot;
+        currentBetAmount = state.currentBet;
+        smallBlindAmount = state.smallBlind;
+        bigBlindAmount = state.bigBlind;
+        dealerPosition = state.dealer;
+        currentRound = state.round;
+        lastAggressorIndex = state.lastAggressor;
+        deckStacked = false;
+
+        // 座位表和增量评估状态由恢复后的玩家和公共牌重新生成
+        seats.reset(players);
+        resetHandStates();
+        std::uint32_t live = seats.liveMask();
+        for (size_t s = 0; s < players.size(); s++) {
+            for (const Card& card : players[s].getHand()) handStates[s].add(card);
+            if ((live >> s) & 1) {
+                for (const Card& card : communityCards) handStates[s].add(card);
+            }
+        }
+        return true;
+    }
+
+    // 开始一局游戏
+    // 这是游戏的核心方法，协调整个德州扑克游戏的进行
+    // 处理发牌、下注、公共牌展示和最终比牌的完整流程
+    void startGame() {
+        // 检查玩家数量（筹码已输光的玩家不再参与）
+        int seatedPlayers = 0;
+        for (const auto& player : players) {
+            if (player.getChips() > 0) seatedPlayers++;
+        }
+        if (seatedPlayers < 2) {
+            sink->onNotEnoughPlayers();
+            return;
+        }
+
+        Instrumentation::count(Instrumentation::HANDS);
+        Instrumentation::PhaseClock phases;
+        phases.begin(Instrumentation::PREFLOP);
+        sink->onHandStart(players, dealerPosition, smallBlindAmount, bigBlindAmount);
+        
+        // 重置游戏状态
+        pot = 0;
+        currentRound = 0;
+        communityCards.clear();
+        communityMask = CardSet();
+        if (deckStacked) {
+            deck.stack(stackedOrder);
+            deckStacked = false;
+        } else {
+            deck.reset();
+            deck.shuffleLazily();   // 边发边洗，提前结束的一局不必洗完整副牌
+        }
+        potManager.reset(static_cast<int>(players.size()));
+
+        // 重置玩家状态
+        for (auto& player : players) {
+            player.resetForNewGame();
+            player.setIsInGame(player.getChips() > 0);
+        }
+        seats.reset(players);
+        resetHandStates();
+
+        // 设置盲注（庄家之后的两位在座玩家）
+        int smallBlindIndex = getNextActivePlayerIndex(dealerPosition);
+        int bigBlindIndex = getNextActivePlayerIndex(smallBlindIndex);
+        
+        players[smallBlindIndex].setIsSmallBlind(true);
+        players[bigBlindIndex].setIsBigBlind(true);
+        
+        // 支付盲注，筹码不足时投入全部筹码
+        int posted = commitChips(smallBlindIndex, smallBlindAmount);
+        sink->onBlind(smallBlindIndex, players[smallBlindIndex], posted, false);
+        
+        posted = commitChips(bigBlindIndex, bigBlindAmount);
+        sink->onBlind(bigBlindIndex, players[bigBlindIndex], posted, true);
+
+        // 发底牌（每个玩家两张）
+        for (int i = 0; i < 2; i++) {
+            for (size_t p = 0; p < players.size(); p++) {
+                if (players[p].getIsInGame()) {
+                    dealHoleCard(static_cast<int>(p));
+                }
+            }
+        }
+
+        // 显示玩家手牌
+        for (size_t i = 0; i < players.size(); i++) {
+            if (players[i].getIsInGame()) {
+                sink->onHoleCards(static_cast<int>(i), players[i]);
+            }
+        }
+
+        // Pre-flop 下注轮
+        sink->onStreetStart(0);
+        int startPlayerIndex = getNextActivePlayerIndex(bigBlindIndex);
+        bettingRound(startPlayerIndex);
+
+        // 如果还有多个玩家，继续游戏
+        if (getActivePlayerCount() > 1) {
+            // Flop 阶段
+            phases.begin(Instrumentation::FLOP);
+            dealFlop();
+            sink->onStreetStart(1);
+            bettingRound(bigBlindIndex);
+
+            if (getActivePlayerCount() > 1) {
+                // Turn 阶段
+                phases.begin(Instrumentation::TURN);
+                dealTurn();
+                sink->onStreetStart(2);
+                bettingRound(bigBlindIndex);
+
+                if (getActivePlayerCount() > 1) {
+                    // River 阶段
+                    phases.begin(Instrumentation::RIVER);
+                    dealRiver();
+                    sink->onStreetStart(3);
+                    bettingRound(bigBlindIndex);
+                }
+            }
+        }
+
+        // 比牌阶段
+        phases.begin(Instrumentation::SHOWDOWN);
+        showdown();
+        phases.end();
+        Instrumentation::count(Instrumentation::CARDS_DEALT, 52 - deck.size());
+
+        // 更新庄家位置
+        dealerPosition = (dealerPosition + 1) % players.size();
+        
+        sink->onHandEnd();
+    }
+
+    // 发三张公共牌（flop）
+    // 实现德州扑克中的翻牌阶段
+    // 包含烧牌（burn card）操作，这是正规德州扑克的标准流程
+    void dealFlop() {
+        // 弃一张牌（烧牌）
+        // 烧牌是为了防止作弊，增加游戏公平性
+        sink->onBurnCard(deck.dealCard(rng));
+        
+        // 发三张翻牌，这是德州扑克中第一个重要的牌局阶段
+        for (int i = 0; i < 3; i++) {
+            addCommunityCard(deck.dealCard(rng));
+        }
+        
+        // 更新当前轮次为翻牌阶段
+        currentRound = 1;
+        // 显示公共牌，让所有玩家看到翻牌结果
+        sink->onCommunityCards(communityCards);
+    }
+
+    // 发第四张公共牌（turn）
+    // 实现德州扑克中的转牌阶段
+    void dealTurn() {
+        // 弃一张牌，保持游戏公平性
+        sink->onBurnCard(deck.dealCard(rng));
+        
+        // 发转牌，游戏进入倒数第二个阶段
+        addCommunityCard(deck.dealCard(rng));
+        
+        // 更新当前轮次为转牌阶段
+        currentRound = 2;
+        // 显示公共牌
+        sink->onCommunityCards(communityCards);
+    }
+
+    // 发第五张公共牌（river）
+    // 实现德州扑克中的河牌阶段，这是最后一张公共牌
+    void dealRiver() {
+        // 弃一张牌，保持游戏公平性
+        sink->onBurnCard(deck.dealCard(rng));
+        
+        // 发河牌，游戏进入最终阶段
+        addCommunityCard(deck.dealCard(rng));
+        
+        // 更新当前轮次为河牌阶段
+        currentRound = 3;
+        // 显示公共牌
+        sink->onCommunityCards(communityCards);
+    }
+
+    // 显示公共牌
+    // 格式化输出当前的所有公共牌，方便玩家查看当前可用的公共牌
+    // 参数: out - 控制台渲染器，默认为标准输出上的渲染器（不刷新，等待输入前由渲染器统一写出）
+    void displayCommunityCards(ConsoleRenderer& out = ConsoleRenderer::standard()) const {
+        out << "公共牌: ";
+        for (const auto& card : communityCards) {
+            out << card.glyph() << " ";
+        }
+        out << '\n';
+    }
+
+    // 获取游戏状态摘要
+    // 输出当前游戏的核心信息，包括底池大小、玩家数量和各玩家状态
+    // 参数: out - 控制台渲染器，默认为标准输出上的渲染器（不刷新，等待输入前由渲染器统一写出）
+    void displayGameStatus(ConsoleRenderer& out = ConsoleRenderer::standard()) const {
+        out << "\n===== 游戏状态 =====" << '\n';
+        out << "底池: " << pot << '\n';
+        out << "玩家数量: " << players.size() << '\n';
+        out << "活跃玩家: " << getActivePlayerCount() << '\n';
+        
+        out << "\n玩家状态:" << '\n';
+        for (const auto& player : players) {
+            out << player.getName() << " - 筹码: " << player.getChips();
+            if (player.getIsSmallBlind()) out << " [小盲注]";
+            if (player.getIsBigBlind()) out << " [大盲注]";
+            if (player.getHasFolded()) out << " [已弃牌]";
+            if (player.getIsAllIn()) out << " [全下]";
+            out << '\n';
+        }
+    }
+};
+
+// 性能测试套件 - 对发牌、评估、比牌和完整一手牌做微基准测试
+// 每项测试先预热，再重复多次测量，报告每次操作的耗时（中位数/最小值/平均值±标准差）和吞吐量，
+// 用作 main.cpp 性能改动前后的对比基准
+class BenchmarkSuite {
+private:
+    // 一项测试的统计结果
+    struct Stats {
+        double median, min, mean, stddev;   // 每次操作的纳秒数
+    };
+
+    static volatile std::uint64_t blackhole;   // 存放计算结果，防止编译器把被测代码优化掉
+
+    // 测量一项操作
+    // 参数:
+    //   repetitions - 重复测量的次数
+    //   fn - 被测函数，参数为本次要执行的操作次数
+    // 返回值: 统计结果
+    template <typename Fn>
+    static Stats measure(int repetitions, Fn&& fn) {
+        using Clock = std::chrono::steady_clock;
+        // 预热并校准：找到一次测量约20毫秒所需的操作次数
+        long long batch = 16;
+        while (true) {
+            auto start = Clock::now();
+            fn(batch);
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if (elapsed >= 0.02 || batch >= (1LL << 30)) break;
+            batch = elapsed < 0.002 ? batch * 8 : static_cast<long long>(batch * 0.025 / elapsed) + 1;
+        }
+
+        std::vector<double> samples;
+        for (int r = 0; r < repetitions; r++) {
+            auto start = Clock::now();
+            fn(batch);
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            samples.push_back(elapsed / batch);
+        }
+        std::sort(samples.begin(), samples.end());
+        Stats stats;
+        stats.median = samples[samples.size() / 2];
+        stats.min = samples.front();
+        stats.mean = 0;
+        for (double x : samples) stats.mean += x;
+        stats.mean /= samples.size();
+        stats.stddev = 0;
+        for (double x : samples) stats.stddev += (x - stats.mean) * (x - stats.mean);
+        stats.stddev = std::sqrt(stats.stddev / samples.size());
+        return stats;
+    }
+
+    // 输出一行结果
+    // 参数:
+    //   name - 测试名称
+    //   stats - 统计结果
+    //   unit - 吞吐量的单位（例如"次/秒"、"手/秒"）
+    static void report(const std::string& name, const Stats& stats, const char* unit) {
+        std::printf("%-34s %10.1f %10.1f %10.1f ±%5.1f%% %14.0f %s\n", name.c_str(), 
+                    stats.median, stats.min, stats.mean, 
+                    stats.mean > 0 ? stats.stddev / stats.mean * 100 : 0.0, 
+                    1e9 / stats.median, unit);
+    }
+
+    // 生成 count 组互不重复的随机牌（每组 size 张）
+    static std::vector<std::vector<Card>> randomHands(int count, int size, Xoshiro256& rng) {
+        std::vector<std::vector<Card>> hands;
+        Deck deck;
+        for (int i = 0; i < count; i++) {
+            deck.reset();
+            deck.shuffleLazily();
+            std::vector<Card> hand;
+            for (int j = 0; j < size; j++) hand.push_back(deck.dealCard(rng));
+            hands.push_back(hand);
+        }
+        return hands;
+    }
+
+    // 为比牌测试重新发一手牌：所有人的筹码重置为20000，投入一个大盲注并发完五张公共牌
+    // 之后的每次 showdown() 都会再分一次同一个底池，重置筹码保证重复分配的筹码不会累积到溢出
+    static void dealShowdown(TexasHoldem& game) {
+        game.deck.reset();
+        game.deck.shuffle(game.rng);
+        game.pot = 0;
+        game.communityCards.clear();
+        game.communityMask = CardSet();
+        game.potManager.reset(static_cast<int>(game.players.size()));
+        game.resetHandStates();
+        for (auto& player : game.players) {
+            player.resetForNewGame();
+            player.setChips(20000);
+        }
+        game.seats.reset(game.players);
+        for (size_t i = 0; i < game.players.size(); i++) {
+            game.dealHoleCard(static_cast<int>(i));
+            game.dealHoleCard(static_cast<int>(i));
+            game.commitChips(static_cast<int>(i), game.bigBlindAmount);
+        }
+        game.dealFlop();
+        game.dealTurn();
+        game.dealRiver();
+    }
+
+public:
+    // 运行全部测试
+    // 参数: repetitions - 每项测试重复测量的次数
+    // 返回值: 进程退出码
+    static int run(int repetitions) {
+        Xoshiro256 rng(20240601);
+        NullEventSink nullSink;
+        std::printf("%-34s %10s %10s %10s %7s %14s\n", "测试项", "中位数ns", "最小ns", "平均ns", "标准差", "吞吐量");
+
+        // 洗牌并发完整副牌
+        {
+            Deck deck;
+            report("Deck reset+shuffle+deal 52", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    deck.reset();
+                    deck.shuffle(rng);
+                    for (int c = 0; c < 52; c++) blackhole = blackhole + deck.dealCard(rng).getIndex();
+                }
+            }), "副/秒");
+        }
+
+        // 懒洗牌：只发出需要的牌（两人局翻牌前结束时为4张底牌，打到河牌为12张）
+        for (int count : {4, 12, 52}) {
+            Deck deck;
+            report("Deck reset+lazy deal " + std::to_string(count), measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    deck.reset();
+                    deck.shuffleLazily();
+                    for (int c = 0; c < count; c++) blackhole = blackhole + deck.dealCard(rng).getIndex();
+                }
+            }), "副/秒");
+        }
+
+        // 5/6/7张牌的评估：原始实现、兼容接口和掩码接口
+        for (int size = 5; size <= 7; size++) {
+            auto hands = randomHands(4096, size, rng);
+            std::vector<CardSet> masks;
+            for (const auto& hand : hands) masks.emplace_back(hand);
+            std::string suffix = " (" + std::to_string(size) + "张)";
+
+            report("legacyEvaluateHand" + suffix, measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    blackhole = blackhole + static_cast<int>(HandEvaluator::legacyEvaluateHand(hands[i & 4095]).first);
+                }
+            }), "次/秒");
+            report("evaluateHand" + suffix, measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    blackhole = blackhole + static_cast<int>(HandEvaluator::evaluateHand(hands[i & 4095]).first);
+                }
+            }), "次/秒");
+            report("evaluateValue(CardSet)" + suffix, measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    blackhole = blackhole + HandEvaluator::evaluateValue(masks[i & 4095]);
+                }
+            }), "次/秒");
+        }
+
+        // 批量评估（7张），与逐手调用 evaluateStrength 对比
+        {
+            auto hands = randomHands(4096, 7, rng);
+            std::vector<CardSet> masks;
+            for (const auto& hand : hands) masks.emplace_back(hand);
+            std::vector<HandStrength> strengths(masks.size());
+            report("evaluateStrength (7张)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    blackhole = blackhole + HandEvaluator::evaluateStrength(masks[i & 4095]).raw();
+                }
+            }), "次/秒");
+            report(std::string("evaluateBatch (7张, ") + HandEvaluator::batchInstructionSet() + ")", 
+                   measure(repetitions, [&](long long n) {
+                // 每次操作评估一手，按4096手一批调用
+                for (long long done = 0; done < n; done += 4096) {
+                    size_t count = static_cast<size_t>(std::min<long long>(4096, n - done));
+                    HandEvaluator::evaluateBatch(masks.data(), strengths.data(), count);
+                    blackhole = blackhole + strengths[count - 1].raw();
+                }
+            }), "次/秒");
+        }
+
+        // 胜率缓存命中：预先放入4096个翻牌局面，之后查询它们随机交换花色后的同构局面（含规范化和加锁）
+        {
+            Equity::ResultCache cache(1 << 16);
+            auto deals = randomHands(4096, 5, rng);
+            std::vector<CardSet> holes, boards;
+            for (const auto& deal : deals) {
+                CardSet hole, board;
+                hole.add(deal[0]);
+                hole.add(deal[1]);
+                for (int c = 2; c < 5; c++) board.add(deal[c]);
+                Equity::EquityResult result;
+                result.samples = 1;
+                cache.insert(Equity::canonicalKey(hole, board, 1, false), result);
+                // 随机的花色置换
+                int permutation[4] = {0, 1, 2, 3};
+                std::shuffle(std::begin(permutation), std::end(permutation), rng);
+                auto relabel = [&permutation](CardSet cards) {
+                    std::uint64_t bits = 0;
+                    for (int suit = 0; suit < 4; suit++) {
+                        bits |= static_cast<std::uint64_t>(cards.suitMask(static_cast<Suit>(suit))) << (13 * permutation[suit]);
+                    }
+                    return CardSet(bits);
+                };
+                holes.push_back(relabel(hole));
+                boards.push_back(relabel(board));
+            }
+            report("ResultCache::monteCarlo (同构命中)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    blackhole = blackhole + cache.monteCarlo(holes[i & 4095], boards[i & 4095], 1).samples;
+                }
+            }), "次/秒");
+        }
+
+        // 两名玩家比牌
+        {
+            auto deals = randomHands(1024, 9, rng);
+            std::vector<Player> first, second;
+            std::vector<std::vector<Card>> boards;
+            std::vector<CardSet> boardMasks;
+            for (const auto& deal : deals) {
+                first.emplace_back("A");
+                second.emplace_back("B");
+                first.back().addCard(deal[0]);
+                first.back().addCard(deal[1]);
+                second.back().addCard(deal[2]);
+                second.back().addCard(deal[3]);
+                boards.emplace_back(deal.begin() + 4, deal.end());
+                boardMasks.emplace_back(boards.back());
+            }
+            report("compareHands(vector)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    size_t k = i & 1023;
+                    blackhole = blackhole + HandEvaluator::compareHands(first[k], second[k], boards[k]);
+                }
+            }), "次/秒");
+            report("compareHands(CardSet)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    size_t k = i & 1023;
+                    blackhole = blackhole + HandEvaluator::compareHands(first[k], second[k], boardMasks[k]);
+                }
+            }), "次/秒");
+        }
+
+        // 比牌阶段（每256次重新发一手牌，发牌开销分摊后可以忽略）
+        for (int count : {2, 6, 10, 22}) {
+            TexasHoldem game(rng());
+            game.setEventSink(&nullSink);
+            for (int i = 0; i < count; i++) game.addPlayer(Player("玩家" + std::to_string(i + 1)));
+            report("showdown (" + std::to_string(count) + "人)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    if ((i & 255) == 0) dealShowdown(game);
+                    game.showdown();
+                }
+            }), "次/秒");
+        }
+
+        // 完整的一手牌（随机代理、无输出），筹码输光的玩家会被补满
+        for (int count : {2, 6, 10, 22}) {
+            TexasHoldem game(rng());
+            game.setEventSink(&nullSink);
+            std::vector<RandomAgent> bots;
+            for (int i = 0; i < count; i++) bots.emplace_back(rng());
+            for (int i = 0; i < count; i++) {
+                game.addPlayer(Player("玩家" + std::to_string(i + 1)));
+                game.setAgent(i, &bots[i]);
+            }
+            report("startGame (" + std::to_string(count) + "人)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    game.startGame();
+                    for (auto& player : game.players) {
+                        if (player.getChips() < game.bigBlindAmount) player.winChips(20000);
+                    }
+                }
+            }), "手/秒");
+        }
+
+        // 牌桌快照：在牌局之间生成快照，按写出的长度复制出来读回，再恢复到另一张牌桌
+        for (int count : {6, 22}) {
+            TexasHoldem game(rng()), copy(rng());
+            std::uint8_t bytes[sizeof(Snapshot::TableState)];
+            Snapshot::TableState loaded;
+            game.setEventSink(&nullSink);
+            RandomAgent bot(rng());
+            game.setDefaultAgent(&bot);
+            for (int i = 0; i < count; i++) game.addPlayer(Player("玩家" + std::to_string(i + 1)));
+            game.startGame();
+            report("snapshot+restore (" + std::to_string(count) + "人)", measure(repetitions, [&](long long n) {
+                for (long long i = 0; i < n; i++) {
+                    Snapshot::TableState state = game.snapshot();
+                    std::memcpy(bytes, &state, state.size);
+                    blackhole = blackhole + (Snapshot::load(bytes, state.size, loaded) && copy.restore(loaded));
+                }
+            }), "次/秒");
+        }
+        std::fflush(stdout);
+        return 0;
+    }
+};
+
+volatile std::uint64_t BenchmarkSuite::blackhole = 0;
+
+// 无输出的自我对局 - 所有座位由机器人操作，事件全部丢弃，用于测量引擎吞吐量
+// 每局开始前给输光的玩家补回初始筹码（20000），保证每一手都能开局，报告的手数就是实际打完的手数
+// 参数:
+//   hands - 对局手数
+//   playerCount - 玩家数量（2-22）
+//   seed - 随机数种子
+//   logPath - 手牌历史记录文件，为空时不记录
+//   lineup - 机器人阵容（见 Bots::makeAgent），为空时使用随机代理
+//   statsPath - 手牌统计的列式文件（见 HandStats），为空时不统计
+// 返回值: 进程退出码
+int runSelfPlay(long long hands, int playerCount, std::uint64_t seed, const std::string& logPath,
+                const std::string& lineup, const std::string& statsPath) {
+    NullEventSink nullSink;
+    std::unique_ptr<HandHistory::Writer> writer;
+    std::unique_ptr<HandStats::Histogram> histogram;
+    std::unique_ptr<HandStats::Collector> collector;
+    TexasHoldem game(seed);
+    game.setEventSink(&nullSink);
+    if (!logPath.empty()) {
+        writer.reset(new HandHistory::Writer(logPath));
+        if (!writer->isOpen()) {
+            std::cout << "无法创建手牌记录文件: " << logPath << "\n";
+            return 1;
+        }
+        game.setEventSink(writer.get());
+    }
+    if (!statsPath.empty()) {
+        // 统计接收器同时负责写记录文件，牌桌上只挂一个接收器
+        histogram.reset(new HandStats::Histogram());
+        collector.reset(new HandStats::Collector(histogram.get(), writer.get()));
+        game.setEventSink(collector.get());
+    }
+
+    std::vector<std::unique_ptr<Agent>> bots;
+    for (int i = 0; i < playerCount; i++) {
+        bots.push_back(Bots::makeAgent(lineup, i, seed + 1 + i));
+    }
+    for (int i = 0; i < playerCount; i++) {
+        game.addPlayer(Player("玩家" + std::to_string(i + 1)));
+        game.setAgent(i, bots[i].get());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (long long h = 0; h < hands; h++) {
+        for (int i = 0; i < playerCount; i++) {
+            if (game.getPlayers()[i].getChips() == 0) game.setChips(i, 20000);
+        }
+        game.startGame();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "自我对局 " << hands << " 手，" << playerCount << " 名玩家，耗时 " << seconds << " 秒（"
+              << static_cast<long long>(hands / std::max(seconds, 1e-9)) << " 手/秒）\n";
+    for (const auto& player : game.getPlayers()) {
+        std::cout << player.getName() << " - 筹码: " << player.getChips() << "\n";
+    }
+    if (histogram) {
+        std::cout << "\n";
+        HandStats::printSummary(*histogram);
+        if (!HandStats::writeColumns(statsPath, *histogram)) {
+            std::cout << "无法写入统计文件: " << statsPath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 检查牌局过程中的堆内存分配：不输出事件的机器人自我对局，每局开始前把筹码补满，保证每一局都完整进行
+// 先打几局预热（首次使用时才构建的查表等），之后统计的分配次数应为0
+// 参数:
+//   hands - 统计的局数
+//   playerCount - 玩家数量（2-22）
+//   seed - 随机数种子
+// 返回值: 进程退出码，0表示没有分配，1表示发生了分配或本次构建没有启用分配计数（见 HOLDEM_ALLOC_CHECK）
+int runAllocationCheck(long long hands, int playerCount, std::uint64_t seed) {
+    if (!AllocationCounter::ENABLED) {
+        std::cout << "分配计数不可用：需要以 -DHOLDEM_ALLOC_CHECK=1 重新编译。\n";
+        return 1;
+    }
+    NullEventSink nullSink;
+    TexasHoldem game(seed);
+    game.setEventSink(&nullSink);
+    std::vector<RandomAgent> bots;
+    for (int i = 0; i < playerCount; i++) {
+        bots.emplace_back(seed + 1 + i);
+    }
+    for (int i = 0; i < playerCount; i++) {
+        game.addPlayer(Player("玩家" + std::to_string(i + 1)));
+        game.setAgent(i, &bots[i]);
+    }
+
+    auto playHand = [&game, playerCount] {
+        for (int i = 0; i < playerCount; i++) game.setChips(i, 20000);
+        game.startGame();
+    };
+    HandEvaluator::evaluateValue(CardSet(0x7F));    // 构建6张、7张牌的查表
+    for (int h = 0; h < 16; h++) playHand();
+
+    std::uint64_t before = AllocationCounter::count();
+    for (long long h = 0; h < hands; h++) playHand();
+    std::uint64_t allocations = AllocationCounter::count() - before;
+
+    std::cout << playerCount << " 名玩家对局 " << hands << " 手，堆内存分配 " << allocations << " 次\n";
+    if (allocations != 0) {
+        std::cout << "牌局过程中发生了内存分配。\n";
+        return 1;
+    }
+    std::cout << "检查通过。\n";
+    return 0;
+}
+
+// 扫描手牌历史记录文件并输出汇总统计，用于检查记录内容和测量读取速度
+// 参数: path - 记录文件路径
+// 返回值: 进程退出码
+int runScan(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    HandHistory::Reader reader(path);
+    if (!reader.isOpen()) {
+        std::cout << "无法读取手牌记录文件: " << path << "\n";
+        return 1;
+    }
+    long long showdowns = 0, truncated = 0, actions = 0, potTotal = 0, seats = 0;
+    for (const HandHistory::HandRecord& record : reader) {
+        showdowns += (record.flags & HandHistory::FLAG_SHOWDOWN) != 0;
+        truncated += (record.flags & HandHistory::FLAG_TRUNCATED) != 0;
+        actions += record.actionCount;
+        for (int i = 0; i < record.seatCount; i++) {
+            potTotal += record.won[i];
+            seats += record.startChips[i] > 0;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long hands = static_cast<long long>(reader.size());
+    double perHand = static_cast<double>(std::max(hands, 1LL));
+    std::cout << "记录 " << hands << " 手，比牌 " << showdowns << " 手，操作记录不完整 " << truncated << " 手\n"
+              << "平均每手 " << seats / perHand << " 名玩家、" << actions / perHand 
+              << " 次操作、底池 " << potTotal / perHand << "\n"
+              << "耗时 " << seconds << " 秒（" 
+              << hands * sizeof(HandHistory::HandRecord) / std::max(seconds, 1e-9) / (1 << 20) << " MB/秒）" << std::endl;
+    return 0;
+}
+
+// 多桌锦标赛 - 同时运行大量无输出的牌桌，直到只剩一名玩家
+// 每一轮把所有仍在进行的牌桌作为任务交给线程池，每张桌子最多连打若干手（有人输光即提前结束）；
+// 一轮结束后由调用线程统一淘汰输光的玩家、拆桌并平衡各桌人数，然后按轮数提升盲注。
+// 每张桌子的统计只由正在运行它的线程写入，回合之间再汇总，因此打牌过程中没有全局锁
+class Tournament {
+public:
+    // 锦标赛参数
+    struct Options {
+        int tables = 1000;              // 开始时的牌桌数量
+        int seatsPerTable = 9;          // 每桌座位数（2-22）
+        int startingChips = 10000;      // 初始筹码
+        int handsPerRound = 16;         // 每张桌子每轮最多打的手数
+        int roundsPerLevel = 8;         // 每隔多少轮盲注翻倍
+        int threads = 0;                // 线程数，0表示使用硬件线程数
+        std::uint64_t seed = 0;         // 随机数种子，0表示使用真随机数
+        std::string bots;               // 机器人阵容（见 Bots::makeAgent），为空时使用随机代理
+        bool stats = false;             // 是否统计每一手牌（见 HandStats）
+    };
+
+    // 锦标赛结果
+    struct Result {
+        int entrants = 0;               // 参赛人数
+        long long hands = 0;            // 所有牌桌打的总手数
+        int rounds = 0;                 // 调度轮数
+        int tablesBroken = 0;           // 拆掉的牌桌数
+        int playersMoved = 0;           // 换桌的玩家人次
+        int threads = 0;                // 使用的线程数
+        double seconds = 0;             // 耗时
+        std::string winner;             // 冠军
+        int winnerChips = 0;            // 冠军筹码（应等于全部筹码）
+        std::vector<int> finishOrder;   // 淘汰顺序（参赛编号），最后一个是冠军
+        HandStats::Histogram stats;     // 所有牌桌的手牌统计（Options::stats 为true时）
+    };
+
+private:
+    // 一张牌桌，座位顺序与 game 中的玩家顺序一致
+    struct alignas(64) Table {
+        TexasHoldem game;
+        std::vector<int> entrants;      // 每个座位上的参赛编号
+        long long hands = 0;            // 本桌打的总手数（只由运行本桌的线程写入）
+        bool active = true;             // 是否仍在使用
+        HandStats::Collector collector; // 手牌统计，每轮开始时绑定到运行本桌的线程的直方图
+
+        Table(std::uint64_t seed, std::uint32_t id) : game(seed), collector(nullptr, nullptr, id) {}
+    };
+
+    Options options;
+    NullEventSink nullSink;
+    std::vector<std::unique_ptr<Agent>> agents;         // 每名参赛者的代理，随玩家换桌
+    std::vector<std::unique_ptr<Table>> tables;
+
+    // 把一名玩家安排到某张桌子的末尾座位
+    void seat(Table& table, const Player& player, int entrant) {
+        table.game.addPlayer(player);
+        table.game.setAgent(static_cast<int>(table.entrants.size()), agents[entrant].get());
+        table.entrants.push_back(entrant);
+    }
+
+    // 从桌子上移走一名玩家
+    Player unseat(Table& table, int seatIndex, int& entrant) {
+        entrant = table.entrants[seatIndex];
+        table.entrants.erase(table.entrants.begin() + seatIndex);
+        return table.game.removePlayer(seatIndex);
+    }
+
+    // 人数最少（或最多）的在用牌桌，exclude 表示排除的桌子
+    Table* pickTable(bool fewest, const Table* exclude) {
+        Table* best = nullptr;
+        for (auto& table : tables) {
+            if (!table->active || table.get() == exclude) continue;
+            if (!best || (fewest ? table->entrants.size() < best->entrants.size()
+                                 : table->entrants.size() > best->entrants.size())) {
+                best = table.get();
+            }
+        }
+        return best;
+    }
+
+    // 一轮结束后：淘汰输光的玩家，拆掉多余的桌子，平衡各桌人数
+    // 返回值: 剩余玩家数
+    int rebalance(Result& result) {
+        int remaining = 0;
+        for (auto& table : tables) {
+            if (!table->active) continue;
+            for (int i = static_cast<int>(table->entrants.size()) - 1; i >= 0; i--) {
+                if (table->game.getPlayers()[i].getChips() == 0) {
+                    int entrant;
+                    unseat(*table, i, entrant);
+                    result.finishOrder.push_back(entrant);
+                }
+            }
+            remaining += static_cast<int>(table->entrants.size());
+        }
+
+        // 拆桌：人数最少的桌子上的玩家依次坐到人数最少的其他桌子
+        int activeTables = 0;
+        for (const auto& table : tables) activeTables += table->active;
+        int needed = std::max(1, (remaining + options.seatsPerTable - 1) / options.seatsPerTable);
+        while (activeTables > needed) {
+            Table* broken = pickTable(true, nullptr);
+            broken->active = false;
+            activeTables--;
+            result.tablesBroken++;
+            while (!broken->entrants.empty()) {
+                int entrant;
+                Player player = unseat(*broken, 0, entrant);
+                seat(*pickTable(true, broken), player, entrant);
+                result.playersMoved++;
+            }
+        }
+
+        // 平衡：人数最多和最少的桌子相差超过1人时，从多的桌子移一人到少的桌子
+        while (activeTables > 1) {
+            Table* largest = pickTable(false, nullptr);
+            Table* smallest = pickTable(true, nullptr);
+            if (largest->entrants.size() <= smallest->entrants.size() + 1) break;
+            int entrant;
+            Player player = unseat(*largest, static_cast<int>(largest->entrants.size()) - 1, entrant);
+            seat(*smallest, player, entrant);
+            result.playersMoved++;
+        }
+        return remaining;
+    }
+
+public:
+    // 构造函数 - 建好所有牌桌并安排参赛者入座
+    // 参数: opts - 锦标赛参数
+    explicit Tournament(const Options& opts) : options(opts) {
+        options.tables = std::max(options.tables, 1);
+        options.seatsPerTable = std::min(std::max(options.seatsPerTable, 2), PotManager::MAX_SEATS);
+        Xoshiro256 rng(options.seed ? options.seed : Xoshiro256::randomSeed());
+        int entrants = options.tables * options.seatsPerTable;
+        for (int i = 0; i < entrants; i++) agents.push_back(Bots::makeAgent(options.bots, i, rng()));
+        for (int t = 0; t < options.tables; t++) {
+            tables.emplace_back(new Table(rng(), static_cast<std::uint32_t>(t)));
+            Table& table = *tables.back();
+            table.game.setEventSink(options.stats ? static_cast<GameEventSink*>(&table.collector) : &nullSink);
+        }
+        for (int i = 0; i < entrants; i++) {
+            seat(*tables[i / options.seatsPerTable], Player("玩家" + std::to_string(i + 1), options.startingChips), i);
+        }
+    }
+
+    // 运行锦标赛直到产生冠军
+    // 返回值: 锦标赛结果
+    Result run() {
+        Result result;
+        result.entrants = options.tables * options.seatsPerTable;
+        WorkStealingPool pool(options.threads);
+        result.threads = pool.size();
+        std::vector<HandStats::Histogram> perThread(options.stats ? pool.size() : 0);
+        std::vector<Table*> schedule;
+        int smallBlind = 50;
+
+        auto start = std::chrono::steady_clock::now();
+        while (true) {
+            schedule.clear();
+            for (auto& table : tables) {
+                if (table->active) schedule.push_back(table.get());
+            }
+            if (schedule.size() == 1 && schedule[0]->entrants.size() < 2) break;
+
+            // 每张桌子连打若干手，有玩家输光就停下等待重新分桌
+            int handsPerRound = options.handsPerRound;
+            pool.run(schedule.size(), [&](size_t index) {
+                Table& table = *schedule[index];
+                if (options.stats) table.collector.bind(perThread[WorkStealingPool::threadIndex()]);
+                for (int h = 0; h < handsPerRound; h++) {
+                    table.game.startGame();
+                    table.hands++;
+                    bool busted = false;
+                    for (const auto& player : table.game.getPlayers()) busted = busted || player.getChips() == 0;
+                    if (busted) break;
+                }
+            });
+            result.rounds++;
+            rebalance(result);
+
+            // 盲注升级
+            if (result.rounds % options.roundsPerLevel == 0) {
+                smallBlind *= 2;
+                for (auto& table : tables) table->game.setBlinds(smallBlind, smallBlind * 2);
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (const auto& table : tables) result.hands += table->hands;
+        for (const HandStats::Histogram& histogram : perThread) result.stats.merge(histogram);
+        for (auto& table : tables) {
+            if (table->active && !table->entrants.empty()) {
+                result.finishOrder.push_back(table->entrants[0]);
+                result.winner = table->game.getPlayers()[0].getName();
+                result.winnerChips = table->game.getPlayers()[0].getChips();
+            }
+        }
+        return result;
+    }
+};
+
+// 命令行锦标赛 - 运行一场多桌锦标赛并输出统计
+// 参数:
+//   options - 锦标赛参数
+//   statsPath - 手牌统计的列式文件，为空时不统计（options.stats 应与之一致）
+// 返回值: 进程退出码
+int runTournament(const Tournament::Options& options, const std::string& statsPath) {
+    Tournament tournament(options);
+    Tournament::Result result = tournament.run();
+    std::cout << "锦标赛 " << result.entrants << " 名玩家，" << result.threads << " 个线程\n"
+              << "总手数: " << result.hands << "，调度轮数: " << result.rounds 
+              << "，拆桌: " << result.tablesBroken << "，换桌: " << result.playersMoved << " 人次\n"
+              << "耗时 " << result.seconds << " 秒（" 
+              << static_cast<long long>(result.hands / std::max(result.seconds, 1e-9)) << " 手/秒）\n"
+              << "冠军: " << result.winner << "，筹码: " << result.winnerChips << std::endl;
+    if (!statsPath.empty()) {
+        std::cout << "\n";
+        HandStats::printSummary(result.stats);
+        if (!HandStats::writeColumns(statsPath, result.stats)) {
+            std::cout << "无法写入统计文件: " << statsPath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 命令行统计汇总 - 读入手牌记录文件，统计后输出摘要，可选写出列式统计文件
+// 所有文件切成小块交给线程池，每个线程汇总进自己的直方图，全部完成后合并
+// 参数:
+//   paths - 记录文件路径
+//   statsPath - 列式统计文件路径，为空时不写
+//   threads - 线程数，0表示使用硬件线程数
+// 返回值: 进程退出码
+int runAggregate(const std::vector<std::string>& paths, const std::string& statsPath, int threads) {
+    const size_t CHUNK = 4096;  // 每个任务汇总的记录数
+    struct Chunk {
+        const HandHistory::Reader* reader;
+        size_t begin, end;
+    };
+    std::vector<std::unique_ptr<HandHistory::Reader>> readers;
+    std::vector<Chunk> chunks;
+    for (const std::string& path : paths) {
+        readers.emplace_back(new HandHistory::Reader(path));
+        const HandHistory::Reader& reader = *readers.back();
+        if (!reader.isOpen()) {
+            std::cout << "无法读取手牌记录文件: " << path << "\n";
+            return 1;
+        }
+        for (size_t begin = 0; begin < reader.size(); begin += CHUNK) {
+            chunks.push_back(Chunk{&reader, begin, std::min(begin + CHUNK, reader.size())});
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WorkStealingPool pool(threads);
+    std::vector<HandStats::Histogram> perThread(pool.size());
+    pool.run(chunks.size(), [&](size_t index) {
+        const Chunk& chunk = chunks[index];
+        HandStats::Histogram& histogram = perThread[WorkStealingPool::threadIndex()];
+        for (size_t i = chunk.begin; i < chunk.end; i++) histogram.add((*chunk.reader)[i]);
+    });
+    HandStats::Histogram total;
+    for (const HandStats::Histogram& histogram : perThread) total.merge(histogram);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    HandStats::printSummary(total);
+    std::cout << "\n" << paths.size() << " 个文件，" << pool.size() << " 个线程，耗时 " << seconds << " 秒（"
+              << static_cast<long long>(total.hands / std::max(seconds, 1e-9)) << " 手/秒）" << std::endl;
+    if (!statsPath.empty() && !HandStats::writeColumns(statsPath, total)) {
+        std::cout << "无法写入统计文件: " << statsPath << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// 手牌回放 - 按手牌历史记录重建每一局（同样的筹码、庄家、盲注、牌序和操作），
+// 用当前的引擎和评估器重新打一遍，检查操作、公共牌和分池结果是否与记录一致。
+// 记录之间互不依赖，所有文件切成小块后交给线程池并行回放
+namespace Replay {
+    // 按记录的操作依次行动的代理，轮到的座位与记录不符时弃牌并标记为已偏离
+    class ScriptedAgent : public Agent {
+    private:
+        const HandHistory::HandRecord* record;  // 当前回放的记录
+        int next;                               // 下一个要执行的操作
+
+    public:
+        ScriptedAgent() : record(nullptr), next(0) {}
+
+        // 载入一手牌的操作序列
+        void load(const HandHistory::HandRecord& hand) {
+            record = &hand;
+            next = 0;
+        }
+
+        PlayerAction decide(const DecisionContext& context) override {
+            if (!record || next >= record->actionCount || record->actions[next].seat != context.playerIndex) {
+                return PlayerAction::fold();
+            }
+            const HandHistory::ActionRecord& action = record->actions[next++];
+            switch (action.kind & 3) {
+                case HandHistory::KIND_FOLD:   return PlayerAction::fold();
+                case HandHistory::KIND_CALL:   return PlayerAction::call();
+                case HandHistory::KIND_RAISE:  return PlayerAction::raise(action.amount);
+                default:                       return PlayerAction::raise(context.player.getChips());  // 全下
+            }
+        }
+    };
+
+    // 保存最近一条记录的记录端
+    class Capture : public HandHistory::Recorder {
+    public:
+        HandHistory::HandRecord last;
+
+    protected:
+        void onRecord(const HandHistory::HandRecord& record) override {
+            last = record;
+        }
+    };
+
+    // 按记录重建发牌顺序：两轮底牌、烧牌、翻牌、烧牌、转牌、烧牌、河牌
+    inline std::vector<Card> deckOrder(const HandHistory::HandRecord& record) {
+        std::vector<Card> order;
+        for (int round = 0; round < 2; round++) {
+            for (int seat = 0; seat < record.seatCount; seat++) {
+                if (record.hole[seat][round] != HandHistory::NO_CARD) order.push_back(Card::fromIndex(record.hole[seat][round]));
+            }
+        }
+        const int streetEnd[3] = {3, 4, 5};
+        int dealt = 0;
+        for (int street = 0; street < 3; street++) {
+            if (record.burn[street] != HandHistory::NO_CARD) order.push_back(Card::fromIndex(record.burn[street]));
+            for (; dealt < streetEnd[street] && dealt < record.boardCount; dealt++) {
+                order.push_back(Card::fromIndex(record.board[dealt]));
+            }
+        }
+        return order;
+    }
+
+    // 比较记录和回放结果
+    // 返回值: 一致时返回nullptr，否则返回第一个不一致的内容
+    inline const char* compare(const HandHistory::HandRecord& expected, const HandHistory::HandRecord& actual) {
+        if (actual.actionCount != expected.actionCount || 
+            std::memcmp(actual.actions, expected.actions, expected.actionCount * sizeof(HandHistory::ActionRecord)) != 0) {
+            return "操作序列";
+        }
+        if (std::memcmp(actual.hole, expected.hole, sizeof(expected.hole)) != 0) return "底牌";
+        if (actual.boardCount != expected.boardCount || std::memcmp(actual.board, expected.board, sizeof(expected.board)) != 0) {
+            return "公共牌";
+        }
+        if (actual.flags != expected.flags) return "比牌";
+        if (std::memcmp(actual.won, expected.won, sizeof(expected.won)) != 0) return "分池结果";
+        return nullptr;
+    }
+
+    // 回放器 - 复用同一张牌桌连续回放多条记录（座位数变化时重建牌桌）
+    class Replayer {
+    private:
+        Capture capture;
+        ScriptedAgent agent;
+        std::unique_ptr<TexasHoldem> game;
+        int seats;
+
+    public:
+        Replayer() : seats(-1) {}
+
+        // 回放一条记录
+        // 返回值: 一致时返回nullptr，否则返回第一个不一致的内容
+        const char* replay(const HandHistory::HandRecord& record) {
+            if (record.seatCount != seats) {
+                seats = record.seatCount;
+                game.reset(new TexasHoldem(0));
+                game->setEventSink(&capture);
+                game->setDefaultAgent(&agent);
+                for (int i = 0; i < seats; i++) game->addPlayer(Player("玩家" + std::to_string(i + 1)));
+            }
+            for (int i = 0; i < seats; i++) game->setChips(i, record.startChips[i]);
+            game->setBlinds(record.smallBlind, record.bigBlind);
+            game->setDealerPosition(record.dealer);
+            game->stackNextDeck(deckOrder(record));
+            agent.load(record);
+
+            std::uint64_t before = capture.handCount();
+            game->startGame();
+            if (capture.handCount() == before) return "开局";
+            return compare(record, capture.last);
+        }
+
+        // 最近一次回放得到的记录
+        const HandHistory::HandRecord& last() const {
+            return capture.last;
+        }
+    };
+
+    // 第一处不一致
+    struct Mismatch {
+        bool found = false;
+        size_t shard = 0;           // 文件序号
+        size_t index = 0;           // 文件内的记录序号
+        std::uint64_t handId = 0;   // 记录中的手牌序号
+        const char* field = "";     // 不一致的内容
+    };
+
+    // 回放结果
+    struct Summary {
+        long long hands = 0;        // 回放的手数
+        long long skipped = 0;      // 操作记录不完整而跳过的手数
+        int threads = 0;            // 使用的线程数
+        double seconds = 0;         // 耗时
+        Mismatch first;             // 按文件和记录顺序的第一处不一致
+        bool opened = true;         // 所有文件是否都成功打开
+    };
+
+    // 并行回放若干个记录文件
+    // 参数:
+    //   paths - 记录文件（分片）路径
+    //   threads - 线程数，0表示使用硬件线程数
+    // 返回值: 回放结果
+    inline Summary run(const std::vector<std::string>& paths, int threads) {
+        const size_t CHUNK = 4096;  // 每个任务回放的记录数
+
+        // 单个任务：某个文件中的一段记录，结果只由执行它的线程写入
+        struct Chunk {
+            size_t shard, begin, end;
+            long long hands = 0, skipped = 0;
+            Mismatch mismatch;
+        };
+
+        Summary summary;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<HandHistory::Reader>> readers;
+        std::vector<Chunk> chunks;
+        for (size_t s = 0; s < paths.size(); s++) {
+            readers.emplace_back(new HandHistory::Reader(paths[s]));
+            if (!readers.back()->isOpen()) {
+                summary.opened = false;
+                return summary;
+            }
+            for (size_t begin = 0; begin < readers.back()->size(); begin += CHUNK) {
+                Chunk chunk;
+                chunk.shard = s;
+                chunk.begin = begin;
+                chunk.end = std::min(begin + CHUNK, readers.back()->size());
+                chunks.push_back(chunk);
+            }
+        }
+
+        WorkStealingPool pool(threads);
+        summary.threads = pool.size();
+        pool.run(chunks.size(), [&](size_t index) {
+            Chunk& chunk = chunks[index];
+            const HandHistory::Reader& reader = *readers[chunk.shard];
+            Replayer replayer;
+            for (size_t i = chunk.begin; i < chunk.end; i++) {
+                const HandHistory::HandRecord& record = reader[i];
+                if (record.flags & HandHistory::FLAG_TRUNCATED) {
+                    chunk.skipped++;
+                    continue;
+                }
+                chunk.hands++;
+                const char* field = replayer.replay(record);
+                if (field) {
+                    chunk.mismatch = Mismatch{true, chunk.shard, i, record.handId, field};
+                    break;
+                }
+            }
+        });
+
+        // 任务按文件和记录顺序排列，第一个出错的任务即为第一处不一致
+        for (const Chunk& chunk : chunks) {
+            summary.hands += chunk.hands;
+            summary.skipped += chunk.skipped;
+            if (chunk.mismatch.found && !summary.first.found) summary.first = chunk.mismatch;
+        }
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return summary;
+    }
+}
+
+// 求解器 - 在抽象后的单挑牌局上运行反事实遗憾最小化（CFR），生成近似均衡策略
+// 下注抽象照搬 bettingRound 的规则：最小加注为跟注额 + 大盲注，任何操作之后双方下注相等即结束本轮
+// （所以翻牌前小盲平跟、翻牌后大盲过牌都直接进入下一轮）；加注额只保留最小加注和底池大小两种，每轮最多 MAX_RAISES 次。
+// 牌力抽象：翻牌前按起手牌类别对一名对手的胜率分档，翻牌后按当前牌力在同一牌面上对手底牌中的分位数分档（与机器人共用牌面排名），
+// 信息集只由树节点和当前轮的档位确定（不记之前各轮的档位）。
+// 迭代使用外部抽样：每次抽一副牌，遍历者的节点展开全部操作，对手的节点按当前策略只抽一个操作。
+// 一批迭代并行运行时都读取批次开始时的遗憾值，增量以定点整数原子累加，批次结束后统一并入，
+// 整数加法与顺序无关，所以结果不随线程数和任务调度变化
+namespace Solver {
+    const int PLAYERS = 2;
+    const int STREETS = 4;
+    const int BUCKETS = 8;                  // 每轮的牌力档位数
+    const int MAX_ACTIONS = 4;              // 弃牌、跟注（过牌）、最小加注、底池加注
+    const int MAX_RAISES = 3;               // 每轮最多加注次数
+    const int SMALL_BLIND = 50;             // 与牌桌默认盲注相同
+    const int BIG_BLIND = 100;
+    const int STACK = 20000;                // 与牌桌默认初始筹码相同，超过筹码的加注不进入抽象树
+    const std::uint32_t VERSION = 1;        // 检查点格式版本
+
+    const std::uint64_t BATCH_ITERATIONS = 1024;    // 每批迭代数（批内共用同一份遗憾值）
+    const std::uint64_t TASK_ITERATIONS = 64;       // 每个线程池任务的迭代数
+    const std::uint64_t CHECKPOINT_BATCHES = 64;    // 每隔多少批把映射的数组写回文件
+    const double FIXED_SCALE = 65536.0;             // 定点增量的比例
+
+    // 操作（抽象后的）
+    enum ActionKind : std::uint8_t { FOLD = 0, CALL = 1, RAISE_MIN = 2, RAISE_POT = 3 };
+
+    // 节点类型
+    enum NodeType : std::uint8_t { DECISION = 0, TERMINAL_FOLD = 1, TERMINAL_SHOWDOWN = 2 };
+
+    // 树节点，子节点连续存放
+    struct Node {
+        std::uint8_t type;                  // NodeType
+        std::uint8_t player;                // 行动者（0为小盲，1为大盲）；弃牌终局时为弃牌者
+        std::uint8_t street;                // 下注轮（0-3）
+        std::uint8_t actionCount;           // 操作数
+        std::uint8_t actions[MAX_ACTIONS];  // 各操作的 ActionKind
+        std::int32_t bets[PLAYERS];         // 到达该节点时双方投入的总筹码
+        std::int32_t firstChild;            // 第一个子节点的索引
+        std::int32_t offset;                // 决策节点在策略数组中的起始位置，每个档位占 actionCount 格
+    };
+
+    static_assert(sizeof(Node) == 24, "Node must stay 24 bytes");
+
+    // 操作名称
+    inline const char* actionName(std::uint8_t kind) {
+        static const char* names[MAX_ACTIONS] = {"弃牌", "跟注/过牌", "最小加注", "底池加注"};
+        return names[kind];
+    }
+
+    // 抽象博弈树 - 构造时一次展开，之后只读
+    class GameTree {
+    private:
+        std::vector<Node> nodes;    // 所有节点，0号为根（翻牌前小盲行动）
+        size_t slotCount;           // 策略数组的总格数
+        int decisionCount;          // 决策节点数
+
+        // 为一个决策节点生成全部操作和子节点，并递归展开子决策节点
+        // 参数:
+        //   index - 节点索引
+        //   raises - 本轮已有的加注次数
+        void expand(int index, int raises) {
+            Node node = nodes[index];
+            int p = node.player, q = 1 - p;
+            int toCall = node.bets[q] - node.bets[p];
+            int minRaise = toCall + BIG_BLIND;
+            int potRaise = std::max(minRaise, node.bets[0] + node.bets[1]);
+            bool canRaise = raises < MAX_RAISES;
+
+            node.actionCount = 0;
+            if (toCall > 0) node.actions[node.actionCount++] = FOLD;   // 不需要跟注时弃牌总是劣于过牌，不列入
+            node.actions[node.actionCount++] = CALL;
+            if (canRaise && node.bets[p] + toCall + minRaise <= STACK) node.actions[node.actionCount++] = RAISE_MIN;
+            if (canRaise && potRaise > minRaise && node.bets[p] + toCall + potRaise <= STACK) node.actions[node.actionCount++] = RAISE_POT;
+            node.firstChild = static_cast<std::int32_t>(nodes.size());
+            node.offset = static_cast<std::int32_t>(slotCount);
+            slotCount += static_cast<size_t>(BUCKETS) * node.actionCount;
+            decisionCount++;
+            nodes[index] = node;
+
+            for (int a = 0; a < node.actionCount; a++) {
+                Node child = {};
+                child.street = node.street;
+                child.bets[0] = node.bets[0];
+                child.bets[1] = node.bets[1];
+                switch (node.actions[a]) {
+                    case FOLD:
+                        child.type = TERMINAL_FOLD;
+                        child.player = static_cast<std::uint8_t>(p);
+                        break;
+                    case CALL:
+                        // 跟注后双方下注相等，本轮结束：河牌后比牌，否则下一轮由大盲先行动
+                        child.bets[p] = node.bets[q];
+                        child.type = node.street == STREETS - 1 ? TERMINAL_SHOWDOWN : DECISION;
+                        child.street = static_cast<std::uint8_t>(std::min(node.street + 1, STREETS - 1));
+                        child.player = 1;
+                        break;
+                    default:
+                        child.bets[p] += toCall + (node.actions[a] == RAISE_MIN ? minRaise : potRaise);
+                        child.type = DECISION;
+                        child.player = static_cast<std::uint8_t>(q);
+                        break;
+                }
+                nodes.push_back(child);
+            }
+            for (int a = 0; a < node.actionCount; a++) {
+                if (nodes[node.firstChild + a].type == DECISION) {
+                    expand(node.firstChild + a, node.actions[a] == CALL ? 0 : raises + 1);
+                }
+            }
+        }
+
+    public:
+        GameTree() : slotCount(0), decisionCount(0) {
+            Node root = {};
+            root.type = DECISION;
+            root.bets[0] = SMALL_BLIND;
+            root.bets[1] = BIG_BLIND;
+            nodes.push_back(root);
+            expand(0, 0);
+        }
+
+        const Node& node(int index) const {
+            return nodes[index];
+        }
+
+        // 节点总数
+        size_t size() const {
+            return nodes.size();
+        }
+
+        // 决策节点数
+        int decisions() const {
+            return decisionCount;
+        }
+
+        // 策略数组的总格数（决策节点数 × 档位数 × 每个节点的操作数之和）
+        size_t slots() const {
+            return slotCount;
+        }
+
+        // 树结构和抽象参数的哈希，用于确认检查点属于同一棵树
+        std::uint64_t hash() const {
+            std::uint64_t h = 1469598103934665603ull;
+            auto mix = [&h](const void* data, size_t length) {
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < length; i++) h = (h ^ bytes[i]) * 1099511628211ull;
+            };
+            int parameters[] = {BUCKETS, MAX_RAISES, SMALL_BLIND, BIG_BLIND, STACK};
+            mix(parameters, sizeof(parameters));
+            mix(nodes.data(), nodes.size() * sizeof(Node));
+            return h;
+        }
+    };
+
+    namespace detail {
+        // 翻牌前各起手牌类别的档位
+        struct PreflopBuckets {
+            std::uint8_t bucket[Preflop::CLASS_COUNT];
+        };
+
+        // 按对一名对手的胜率给169类起手牌排序，再按组合数（对子6、同花4、不同花12）加权等分成 BUCKETS 档
+        inline const PreflopBuckets& preflopBuckets() {
+            static const PreflopBuckets table = [] {
+                PreflopBuckets t = {};
+                int order[Preflop::CLASS_COUNT];
+                for (int i = 0; i < Preflop::CLASS_COUNT; i++) order[i] = i;
+                std::stable_sort(std::begin(order), std::end(order), [](int a, int b) {
+                    return Preflop::equityBasisPoints(a, 1) < Preflop::equityBasisPoints(b, 1);
+                });
+                int below = 0;
+                for (int index : order) {
+                    int row = index / 13, column = index % 13;
+                    int combos = row == column ? 6 : (row > column ? 4 : 12);
+                    t.bucket[index] = static_cast<std::uint8_t>((2 * below + combos) * BUCKETS / (2 * 1326));
+                    below += combos;
+                }
+                return t;
+            }();
+            return table;
+        }
+    }
+
+    // 一次抽样的发牌结果
+    struct Deal {
+        std::uint8_t buckets[PLAYERS][STREETS];     // 每名玩家每一轮的档位
+        int winner;                                 // 比牌胜者，平局为 -1
+    };
+
+    // 抽一副牌（双方底牌和五张公共牌）并计算档位和比牌结果
+    // 参数: rng - 随机数引擎
+    inline Deal sampleDeal(Xoshiro256& rng) {
+        std::uint8_t deck[52];
+        for (int i = 0; i < 52; i++) deck[i] = static_cast<std::uint8_t>(i);
+        for (int i = 0; i < 9; i++) {
+            int j = i + static_cast<int>(randomBelow(rng, static_cast<std::uint32_t>(52 - i)));
+            std::swap(deck[i], deck[j]);
+        }
+
+        const detail::PreflopBuckets& preflop = detail::preflopBuckets();
+        Deal deal;
+        CardSet hole[PLAYERS], board;
+        for (int p = 0; p < PLAYERS; p++) {
+            Card first = Card::fromIndex(deck[2 * p]), second = Card::fromIndex(deck[2 * p + 1]);
+            deal.buckets[p][0] = preflop.bucket[Preflop::classIndex(first, second)];
+            hole[p].add(first);
+            hole[p].add(second);
+        }
+        // 翻牌后的档位与机器人相同，是相对当前牌面的分位数；按街处理，两名玩家共用同一个牌面排名
+        for (int i = 4; i < 7; i++) board.add(Card::fromIndex(deck[i]));
+        HandEvaluator::HandValue values[PLAYERS] = {0, 0};
+        for (int street = 1; street < STREETS; street++) {
+            if (street > 1) board.add(Card::fromIndex(deck[5 + street]));
+            const Bots::detail::BoardRanking& ranking = Bots::detail::boardRanking(board);
+            for (int p = 0; p < PLAYERS; p++) {
+                values[p] = HandEvaluator::evaluateValue(hole[p] | board);
+                deal.buckets[p][street] = static_cast<std::uint8_t>(ranking.percentile(hole[p], values[p]) * BUCKETS / 65536);
+            }
+        }
+        deal.winner = values[0] > values[1] ? 0 : (values[1] > values[0] ? 1 : -1);
+        return deal;
+    }
+
+    // 检查点文件头，后面紧跟遗憾值和平均策略累计值两个 double 数组（各 slots 格）
+    struct CheckpointHeader {
+        char magic[8];                  // "THCFR\0\0\0"
+        std::uint32_t version;          // 格式版本
+        std::uint32_t buckets;          // 每轮的档位数
+        std::uint64_t slots;            // 每个数组的格数
+        std::uint64_t treeHash;         // GameTree::hash()
+        std::uint64_t seed;             // 随机数种子，继续求解时沿用
+        std::uint64_t iterations;       // 已完成的迭代数
+    };
+
+    static_assert(sizeof(CheckpointHeader) == 48, "CheckpointHeader must stay 48 bytes");
+
+    // 策略存储 - 文件头和两个数组放在同一块连续内存里，同一信息集的各操作相邻。
+    // 给出检查点路径时这块内存就是映射的文件：已存在且与当前树一致则直接继续，否则新建；
+    // 迭代直接写映射的内存，sync() 只需把脏页写回磁盘
+    class Arena {
+    private:
+        unsigned char* data;                        // 文件头 + 两个数组
+        size_t length;                              // 总字节数
+        bool resumedFromFile;                       // 是否从已有的检查点继续
+        const char* failure;                        // 打开失败的原因，成功时为空
+        std::unique_ptr<std::uint64_t[]> heap;      // 不使用文件时的堆内存
+#ifdef _WIN32
+        HANDLE fileHandle;
+        HANDLE mapping;
+#else
+        int descriptor;
+#endif
+
+        // 打开或新建检查点文件并映射，返回是否成功
+        bool map(const std::string& path) {
+#ifdef _WIN32
+            fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                                     OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (fileHandle == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(fileHandle, &size)) return false;
+            resumedFromFile = size.QuadPart != 0;
+            if (resumedFromFile && size.QuadPart != static_cast<LONGLONG>(length)) return false;
+            // 新文件由映射扩展到所需长度，扩展部分为0
+            std::uint64_t total = length;
+            mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE,
+                                         static_cast<DWORD>(total >> 32), static_cast<DWORD>(total), nullptr);
+            if (!mapping) return false;
+            data = static_cast<unsigned char*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+#else
+            descriptor = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (descriptor < 0) return false;
+            struct stat info;
+            if (::fstat(descriptor, &info) != 0) return false;
+            resumedFromFile = info.st_size != 0;
+            if (resumedFromFile && info.st_size != static_cast<off_t>(length)) return false;
+            if (!resumedFromFile && ::ftruncate(descriptor, static_cast<off_t>(length)) != 0) return false;   // 扩展部分为0
+            void* mapped = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            if (mapped == MAP_FAILED) return false;
+            data = static_cast<unsigned char*>(mapped);
+#endif
+            return data != nullptr;
+        }
+
+    public:
+        // 构造函数
+        // 参数:
+        //   path - 检查点文件路径，为空时只使用内存
+        //   slots - 每个数组的格数
+        //   treeHash - 博弈树的哈希
+        //   seed - 新建时使用的随机数种子
+        Arena(const std::string& path, size_t slots, std::uint64_t treeHash, std::uint64_t seed)
+            : data(nullptr), length(sizeof(CheckpointHeader) + 2 * slots * sizeof(double)),
+              resumedFromFile(false), failure(nullptr) {
+#ifdef _WIN32
+            fileHandle = INVALID_HANDLE_VALUE;
+            mapping = nullptr;
+#else
+            descriptor = -1;
+#endif
+            if (path.empty()) {
+                heap.reset(new std::uint64_t[length / sizeof(std::uint64_t)]());
+                data = reinterpret_cast<unsigned char*>(heap.get());
+            } else if (!map(path)) {
+                failure = resumedFromFile ? "文件长度与当前抽象不符" : "无法创建或映射文件";
+                return;
+            }
+
+            CheckpointHeader& h = header();
+            if (resumedFromFile) {
+                if (std::memcmp(h.magic, "THCFR", 5) != 0 || h.version != VERSION ||
+                    h.buckets != static_cast<std::uint32_t>(BUCKETS) || h.slots != slots || h.treeHash != treeHash) {
+                    failure = "文件头与当前抽象不符";
+                }
+                return;
+            }
+            h = CheckpointHeader{{'T', 'H', 'C', 'F', 'R', 0, 0, 0}, VERSION, static_cast<std::uint32_t>(BUCKETS),
+                                 slots, treeHash, seed, 0};
+        }
+
+        ~Arena() {
+#ifdef _WIN32
+            if (data && !heap) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+            if (data && !heap) ::munmap(data, length);
+            if (descriptor >= 0) ::close(descriptor);
+#endif
+        }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        // 是否可用（文件已映射且与当前抽象一致）
+        bool isOpen() const {
+            return data != nullptr && failure == nullptr;
+        }
+
+        // 打开失败的原因
+        const char* error() const {
+            return failure ? failure : "";
+        }
+
+        // 是否从已有的检查点继续
+        bool resumed() const {
+            return resumedFromFile;
+        }
+
+        CheckpointHeader& header() {
+            return *reinterpret_cast<CheckpointHeader*>(data);
+        }
+
+        // 遗憾值数组
+        double* regrets() {
+            return reinterpret_cast<double*>(data + sizeof(CheckpointHeader));
+        }
+
+        // 平均策略累计值数组
+        double* strategy() {
+            return regrets() + header().slots;
+        }
+
+        // 把映射的内容写回磁盘（只使用内存时什么也不做）
+        void sync() {
+            if (!data || heap) return;
+#ifdef _WIN32
+            FlushViewOfFile(data, length);
+            FlushFileBuffers(fileHandle);
+#else
+            ::msync(data, length, MS_SYNC);
+#endif
+        }
+    };
+
+    // 遗憾匹配：正遗憾值按比例分配概率，全部不为正时均匀分配
+    // 参数:
+    //   regrets - 一个信息集的遗憾值
+    //   count - 操作数
+    //   out - 输出的策略
+    inline void regretMatching(const double* regrets, int count, double* out) {
+        double total = 0;
+        for (int a = 0; a < count; a++) total += std::max(regrets[a], 0.0);
+        for (int a = 0; a < count; a++) out[a] = total > 0 ? std::max(regrets[a], 0.0) / total : 1.0 / count;
+    }
+
+    // 训练器 - 在线程池上分批运行外部抽样迭代
+    class Trainer {
+    private:
+        const GameTree& tree;
+        Arena& arena;
+        std::unique_ptr<std::atomic<std::int64_t>[]> regretDelta;      // 本批的遗憾值增量（定点）
+        std::unique_ptr<std::atomic<std::int64_t>[]> strategyDelta;    // 本批的平均策略增量（定点）
+
+        static std::int64_t toFixed(double value) {
+            return static_cast<std::int64_t>(std::llround(value * FIXED_SCALE));
+        }
+
+        // 外部抽样遍历
+        // 参数:
+        //   index - 节点索引
+        //   traverser - 遍历者
+        //   deal - 本次迭代的发牌
+        //   rng - 对手节点抽样用的随机数引擎
+        // 返回值: 遍历者在该节点的抽样反事实价值（筹码）
+        double traverse(int index, int traverser, const Deal& deal, Xoshiro256& rng) {
+            const Node& node = tree.node(index);
+            if (node.type == TERMINAL_FOLD) {
+                return node.player == traverser ? -node.bets[traverser] : node.bets[1 - traverser];
+            }
+            if (node.type == TERMINAL_SHOWDOWN) {
+                if (deal.winner < 0) return 0;
+                return deal.winner == traverser ? node.bets[1 - traverser] : -node.bets[traverser];
+            }
+
+            int count = node.actionCount;
+            size_t slot = node.offset + static_cast<size_t>(deal.buckets[node.player][node.street]) * count;
+            double strategy[MAX_ACTIONS];
+            regretMatching(arena.regrets() + slot, count, strategy);
+
+            if (node.player != traverser) {
+                for (int a = 0; a < count; a++) {
+                    strategyDelta[slot + a].fetch_add(toFixed(strategy[a]), std::memory_order_relaxed);
+                }
+                double roll = static_cast<double>(rng() >> 11) * 0x1.0p-53;
+                int a = 0;
+                while (a < count - 1 && roll >= strategy[a]) roll -= strategy[a++];
+                return traverse(node.firstChild + a, traverser, deal, rng);
+            }
+
+            double values[MAX_ACTIONS];
+            double expected = 0;
+            for (int a = 0; a < count; a++) {
+                values[a] = traverse(node.firstChild + a, traverser, deal, rng);
+                expected += strategy[a] * values[a];
+            }
+            for (int a = 0; a < count; a++) {
+                regretDelta[slot + a].fetch_add(toFixed(values[a] - expected), std::memory_order_relaxed);
+            }
+            return expected;
+        }
+
+        // 把本批增量并入存储并清零；遗憾值截断为非负（CFR+ 的做法，收敛更快）
+        void merge() {
+            double* regrets = arena.regrets();
+            double* strategy = arena.strategy();
+            for (size_t i = 0; i < tree.slots(); i++) {
+                std::int64_t r = regretDelta[i].exchange(0, std::memory_order_relaxed);
+                std::int64_t s = strategyDelta[i].exchange(0, std::memory_order_relaxed);
+                if (r != 0) regrets[i] = std::max(regrets[i] + r / FIXED_SCALE, 0.0);
+                if (s != 0) strategy[i] += s / FIXED_SCALE;
+            }
+        }
+
+    public:
+        Trainer(const GameTree& gameTree, Arena& storage)
+            : tree(gameTree), arena(storage),
+              regretDelta(new std::atomic<std::int64_t>[gameTree.slots()]()),
+              strategyDelta(new std::atomic<std::int64_t>[gameTree.slots()]()) {}
+
+        // 继续运行若干次迭代
+        // 批次边界按全局迭代序号对齐，第 i 次迭代的随机数只由种子和 i 决定，
+        // 因此只要每次在 BATCH_ITERATIONS 的整数倍处停下，分几次继续求解与一次连续求解的结果完全相同
+        // 参数:
+        //   iterations - 迭代次数
+        //   pool - 线程池
+        void run(std::uint64_t iterations, WorkStealingPool& pool) {
+            CheckpointHeader& h = arena.header();
+            while (iterations > 0) {
+                std::uint64_t first = h.iterations;
+                std::uint64_t batch = std::min(BATCH_ITERATIONS - first % BATCH_ITERATIONS, iterations);
+                std::uint64_t seed = h.seed;
+                pool.run(static_cast<size_t>((batch + TASK_ITERATIONS - 1) / TASK_ITERATIONS), [&](size_t task) {
+                    std::uint64_t end = std::min((task + 1) * TASK_ITERATIONS, batch);
+                    for (std::uint64_t i = task * TASK_ITERATIONS; i < end; i++) {
+                        Xoshiro256 rng(seed ^ ((first + i) * 0xD1B54A32D192ED03ull));
+                        Deal deal = sampleDeal(rng);
+                        for (int traverser = 0; traverser < PLAYERS; traverser++) traverse(0, traverser, deal, rng);
+                    }
+                });
+                merge();
+                h.iterations += batch;
+                iterations -= batch;
+                if (h.iterations % (BATCH_ITERATIONS * CHECKPOINT_BATCHES) == 0) arena.sync();
+            }
+            arena.sync();
+        }
+
+        // 一个信息集的平均策略（累计值归一化，从未到达时均匀分配）
+        // 参数:
+        //   index - 决策节点索引
+        //   bucket - 档位
+        //   out - 输出的策略
+        void averageStrategy(int index, int bucket, double* out) {
+            const Node& node = tree.node(index);
+            const double* sums = arena.strategy() + node.offset + static_cast<size_t>(bucket) * node.actionCount;
+            double total = 0;
+            for (int a = 0; a < node.actionCount; a++) total += sums[a];
+            for (int a = 0; a < node.actionCount; a++) out[a] = total > 0 ? sums[a] / total : 1.0 / node.actionCount;
+        }
+    };
+}
+
+// 牌桌服务器 - 在一个进程里开多张牌桌，远程玩家通过 TCP 连接（按行收发的文字协议，可以直接用 nc/telnet）
+// 所有连接由一个 I/O 线程用非阻塞套接字和 poll() 处理，空闲的座位只占一个套接字和两个缓冲区；
+// 引擎的下注循环是同步的，所以每张牌桌在自己的线程里打牌，等待玩家行动时阻塞在条件变量上，并受每次行动的时限约束，
+// 慢的或断开的客户端到时自动过牌或弃牌，不会卡住整张牌桌。
+// 牌桌线程不直接写套接字：要发送的文字先放进发件箱，再通过管道唤醒 I/O 线程。
+// 公开的牌局文字按下注轮批量广播（进入新的下注轮、轮到某人行动或一局结束时各发一次），底牌只发给本人
+namespace TableServer {
+    // 服务器参数
+    struct Options {
+        int port = 7777;                // 监听端口
+        int tables = 16;                // 牌桌数量
+        int seats = 6;                  // 每桌座位数（2-22）
+        int actionTimeout = 30;         // 每次行动的时限（秒）
+        std::uint64_t seed = 0;         // 随机数种子，0表示使用真随机数；第 t 张牌桌使用 seed + t
+    };
+
+#ifndef _WIN32
+    const int STARTING_CHIPS = 20000;   // 入座和输光后补充的筹码
+    const size_t MAX_LINE = 4096;       // 一行输入的最大长度，超过时断开连接
+
+    // 收到 SIGINT/SIGTERM 后置位，I/O 线程在下一次 poll() 返回后开始关闭
+    inline volatile std::sig_atomic_t stopRequested = 0;
+
+    // 发件箱 - 牌桌线程要发给客户端的文字，由 I/O 线程取出写入连接
+    class Outbox {
+    private:
+        std::mutex mutex;
+        std::vector<std::pair<int, std::string>> messages;  // （连接编号，文字）
+        int wakeFd = -1;                                    // 唤醒 I/O 线程的管道写端（非阻塞）
+
+        void wake() {
+            char byte = 1;
+            ssize_t written = ::write(wakeFd, &byte, 1);    // 管道已满时 I/O 线程反正会被唤醒
+            (void)written;
+        }
+
+    public:
+        // 设置唤醒用的管道写端
+        void setWakeFd(int fd) {
+            wakeFd = fd;
+        }
+
+        // 发送给一个连接
+        void send(int connection, std::string text) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                messages.emplace_back(connection, std::move(text));
+            }
+            wake();
+        }
+
+        // 同一段文字发送给多个连接
+        void broadcast(const std::vector<int>& connections, const std::string& text) {
+            if (connections.empty() || text.empty()) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int connection : connections) messages.emplace_back(connection, text);
+            }
+            wake();
+        }
+
+        // 取出全部待发送的文字
+        void drain(std::vector<std::pair<int, std::string>>& out) {
+            std::lock_guard<std::mutex> lock(mutex);
+            out.swap(messages);
+            messages.clear();
+        }
+    };
+
+    class Table;
+
+    // 远程代理 - 把行动请求发给客户端，等待它回复一行操作；超时或连接已断开时能过牌就过牌，否则弃牌
+    class RemoteAgent : public Agent {
+    private:
+        Table& table;
+        int connection;
+
+    public:
+        RemoteAgent(Table& owner, int connectionId) : table(owner), connection(connectionId) {}
+
+        PlayerAction decide(const DecisionContext& context) override;
+    };
+
+    // 一位远程玩家，由 Table::mutex 保护
+    struct Member {
+        int connection;                 // 连接编号
+        std::string name;               // 玩家名称
+        bool connected = true;          // 连接是否还在
+        bool waiting = false;           // 是否正在等待该玩家行动
+        bool hasLine = false;           // 等待期间是否收到了一行输入
+        std::string line;               // 收到的输入
+        RemoteAgent agent;              // 该座位的代理
+
+        Member(Table& table, int connectionId, const std::string& playerName)
+            : connection(connectionId), name(playerName), agent(table, connectionId) {}
+    };
+
+    // 广播事件接收器 - 沿用控制台文字，公开的事件先攒在一个缓冲区里，按下注轮批量广播给整桌；底牌只发给本人
+    class BroadcastSink : public ConsoleEventSink {
+    private:
+        Table& table;
+        std::ostringstream text;        // 尚未广播的文字
+        ConsoleRenderer renderer;       // 写入 text 的渲染器
+
+    public:
+        explicit BroadcastSink(Table& owner) : ConsoleEventSink(renderer), table(owner), renderer(text) {}
+
+        // 把攒下的文字广播给整桌
+        void publish();
+
+        void onHoleCards(int seat, const Player& player) override;
+
+        void onStreetStart(int round) override {
+            ConsoleEventSink::onStreetStart(round);
+            publish();
+        }
+
+        void onHandEnd() override {
+            ConsoleEventSink::onHandEnd();
+            publish();
+        }
+    };
+
+    // 一张牌桌 - 在自己的线程里一局接一局地打，牌局之间处理离开和新加入的玩家
+    class Table {
+        friend class RemoteAgent;
+        friend class BroadcastSink;
+
+    private:
+        int index;                                      // 牌桌编号
+        const Options& options;
+        Outbox& outbox;
+        TexasHoldem game;                               // 只由牌桌线程访问
+        BroadcastSink sink;
+        std::mutex mutex;                               // 保护下面的成员
+        std::condition_variable changed;                // 有玩家加入、离开、输入或服务器关闭
+        std::vector<std::unique_ptr<Member>> members;   // 与 game 的座位一一对应
+        std::vector<std::unique_ptr<Member>> arrivals;  // 等待下一局入座的玩家
+        bool stopping = false;
+        std::thread worker;
+
+        // 在 members 或 arrivals 中按连接编号查找，调用时需持有 mutex
+        Member* find(int connection) {
+            for (auto& member : members) {
+                if (member->connection == connection) return member.get();
+            }
+            for (auto& member : arrivals) {
+                if (member->connection == connection) return member.get();
+            }
+            return nullptr;
+        }
+
+        // 仍连接着的座位的连接编号，调用时需持有 mutex
+        std::vector<int> audience() {
+            std::vector<int> connections;
+            for (auto& member : members) {
+                if (member->connected) connections.push_back(member->connection);
+            }
+            return connections;
+        }
+
+        void run();
+
+    public:
+        Table(int tableIndex, const Options& serverOptions, Outbox& serverOutbox)
+            : index(tableIndex), options(serverOptions), outbox(serverOutbox),
+              game(serverOptions.seed != 0 ? serverOptions.seed + tableIndex : Xoshiro256::randomSeed()),
+              sink(*this) {
+            game.setEventSink(&sink);
+        }
+
+        ~Table() {
+            stop();
+        }
+
+        // 启动牌桌线程
+        void start() {
+            worker = std::thread(&Table::run, this);
         }
-        players.push_back(player);
-        return true;
+
+        // 关闭牌桌：正在等待的行动立即按超时处理，打完当前这一局后线程退出
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+
+        // 牌桌编号
+        int number() const {
+            return index;
+        }
+
+        // 加入牌桌（下一局开始前入座）
+        // 参数:
+        //   connection - 连接编号
+        //   name - 玩家名称
+        // 返回值: 座位已满时返回false
+        bool join(int connection, const std::string& name) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (static_cast<int>(members.size() + arrivals.size()) >= options.seats) return false;
+                arrivals.emplace_back(new Member(*this, connection, name));
+            }
+            changed.notify_all();
+            return true;
+        }
+
+        // 连接已断开：等待中的行动立即按超时处理，座位在本局结束后移除
+        void leave(int connection) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (size_t i = 0; i < arrivals.size(); i++) {
+                    if (arrivals[i]->connection == connection) {
+                        arrivals.erase(arrivals.begin() + i);
+                        return;
+                    }
+                }
+                if (Member* member = find(connection)) member->connected = false;
+            }
+            changed.notify_all();
+        }
+
+        // 收到客户端的一行输入
+        void deliver(int connection, const std::string& line) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Member* member = find(connection);
+                if (!member) return;
+                if (!member->waiting) {
+                    outbox.send(connection, "还没轮到你行动。\n");
+                    return;
+                }
+                member->line = line;
+                member->hasLine = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    inline void BroadcastSink::publish() {
+        renderer.flush();
+        std::string pending = text.str();
+        if (pending.empty()) return;
+        text.str("");
+        std::vector<int> connections;
+        {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            connections = table.audience();
+        }
+        table.outbox.broadcast(connections, pending);
     }
 
-    // 开始一局游戏
-    // 这是游戏的核心方法，协调整个德州扑克游戏的进行
-    // 处理发牌、下注、公共牌展示和最终比牌的完整流程
-    void startGame() {
-        // 检查玩家数量
-        if (players.size() < 2) {
-            std::cout << "玩家数量不足，至少需要2名玩家。" << std::endl;
-            return;
+    inline void BroadcastSink::onHoleCards(int seat, const Player& player) {
+        publish();      // 先发出开局和盲注的文字
+        std::ostringstream hand;
+        player.displayHand(hand);
+        int connection;
+        {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            connection = table.members[seat]->connection;
         }
+        table.outbox.send(connection, hand.str());
+    }
 
-        std::cout << "\n===== 开始新的一局 =====" << std::endl;
-        
-        // 重置游戏状态
-        pot = 0;
-        currentRound = 0;
-        communityCards.clear();
-        deck = Deck();
-        deck.shuffle();
+    inline PlayerAction RemoteAgent::decide(const DecisionContext& context) {
+        table.sink.publish();
+        const Player& player = context.player;
+        std::string prompt = "\n轮到你行动（筹码: " + std::to_string(player.getChips()) +
+                             "，当前下注: " + std::to_string(player.getCurrentBet()) +
+                             "，需要跟注: " + std::to_string(context.toCall) +
+                             "，底池: " + std::to_string(context.pot) + "）\n输入 fold（弃牌）、" +
+                             (context.toCall > 0 ? "call（跟注）" : "check（过牌）") +
+                             "或 raise <金额>（最小 " + std::to_string(context.minRaise) + "），限时 " +
+                             std::to_string(table.options.actionTimeout) + " 秒: ";
+        table.outbox.send(connection, prompt);
 
-        // 重置玩家状态
-        for (auto& player : players) {
-            player.resetForNewGame();
+        std::unique_lock<std::mutex> lock(table.mutex);
+        Member* member = table.find(connection);
+        member->waiting = true;
+        member->hasLine = false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(table.options.actionTimeout);
+        while (true) {
+            if (member->hasLine) {
+                member->hasLine = false;
+                std::istringstream words(member->line);
+                std::string verb;
+                long long amount = 0;
+                words >> verb;
+                for (char& c : verb) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                if (verb == "fold" || verb == "f" || verb == "1") {
+                    member->waiting = false;
+                    return PlayerAction::fold();
+                }
+                if (verb == "call" || verb == "check" || verb == "c" || verb == "2") {
+                    member->waiting = false;
+                    return PlayerAction::call();
+                }
+                if ((verb == "raise" || verb == "r" || verb == "3") && (words >> amount) &&
+                    amount >= context.minRaise && amount <= player.getChips()) {
+                    member->waiting = false;
+                    return PlayerAction::raise(static_cast<int>(amount));
+                }
+                table.outbox.send(connection, "无效的操作，请重新输入: ");
+                continue;
+            }
+            if (!member->connected || table.stopping ||
+                table.changed.wait_until(lock, deadline) == std::cv_status::timeout) {
+                if (member->hasLine) continue;
+                member->waiting = false;
+                if (member->connected) table.outbox.send(connection, "\n行动超时，已自动" + std::string(context.toCall > 0 ? "弃牌" : "过牌") + "。\n");
+                return context.toCall > 0 ? PlayerAction::fold() : PlayerAction::call();
+            }
         }
+    }
 
-        // 设置盲注
-        int smallBlindIndex = (dealerPosition + 1) % players.size();
-        int bigBlindIndex = (dealerPosition + 2) % players.size();
-        
-        players[smallBlindIndex].setIsSmallBlind(true);
-        players[bigBlindIndex].setIsBigBlind(true);
-        
-        // 支付盲注
-        if (players[smallBlindIndex].placeBet(smallBlindAmount)) {
-            pot += smallBlindAmount;
-            std::cout << players[smallBlindIndex].getName() << " 支付小盲注 " << smallBlindAmount << std::endl;
+    inline void Table::run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            // 移除断开的座位（保持其余玩家的顺序）
+            for (size_t i = members.size(); i-- > 0;) {
+                if (!members[i]->connected) {
+                    game.removePlayer(static_cast<int>(i));
+                    members.erase(members.begin() + i);
+                }
+            }
+            // 输光的玩家补充筹码
+            for (size_t i = 0; i < members.size(); i++) {
+                if (game.getPlayers()[i].getChips() == 0) {
+                    game.setChips(static_cast<int>(i), STARTING_CHIPS);
+                    outbox.send(members[i]->connection, "你的筹码已输光，补充到 " + std::to_string(STARTING_CHIPS) + "。\n");
+                }
+            }
+            // 等待的玩家入座
+            while (!arrivals.empty()) {
+                members.push_back(std::move(arrivals.front()));
+                arrivals.erase(arrivals.begin());
+                Member& member = *members.back();
+                game.addPlayer(Player(member.name, STARTING_CHIPS));
+                game.setAgent(static_cast<int>(members.size()) - 1, &member.agent);
+                outbox.send(member.connection, "已在牌桌 " + std::to_string(index) + " 的第 " +
+                                               std::to_string(members.size()) + " 个座位入座。\n");
+            }
+            if (members.size() < 2) {
+                if (members.size() == 1) outbox.send(members[0]->connection, "等待其他玩家加入……\n");
+                changed.wait(lock, [this] { return stopping || !arrivals.empty() || (members.size() == 1 && !members[0]->connected); });
+                continue;
+            }
+            lock.unlock();
+            game.startGame();
+            lock.lock();
         }
-        
-        if (players[bigBlindIndex].placeBet(bigBlindAmount)) {
-            pot += bigBlindAmount;
-            std::cout << players[bigBlindIndex].getName() << " 支付大盲注 " << bigBlindAmount << std::endl;
+    }
+
+    // 服务器 - 监听端口、接受连接，在一个线程里用 poll() 收发所有连接的数据
+    class Server {
+    private:
+        // 一个客户端连接，只由 I/O 线程访问
+        struct Connection {
+            int fd;                         // 套接字
+            std::string input;              // 尚未组成完整一行的输入
+            std::string output;             // 尚未写出的输出
+            Table* table = nullptr;         // 所在的牌桌，输入名称之前为空
+            bool closing = false;           // 写完输出后关闭
+        };
+
+        const Options& options;
+        Outbox outbox;
+        std::vector<std::unique_ptr<Table>> tables;
+        std::map<int, Connection> connections;  // 按连接编号
+        int nextConnection = 1;
+        int listener = -1;
+        int wakePipe[2] = {-1, -1};
+
+        static bool setNonBlocking(int fd) {
+            int flags = ::fcntl(fd, F_GETFL, 0);
+            return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
         }
 
-        // 发底牌（每个玩家两张）
-        for (int i = 0; i < 2; i++) {
-            for (auto& player : players) {
-                if (player.getIsInGame()) {
-                    player.addCard(deck.dealCard());
+        // 关闭一个连接并通知它所在的牌桌
+        void close(std::map<int, Connection>::iterator it) {
+            if (it->second.table) it->second.table->leave(it->first);
+            ::close(it->second.fd);
+            connections.erase(it);
+        }
+
+        // 尽量写出连接的输出，返回false表示连接已出错
+        static bool flush(Connection& connection) {
+            while (!connection.output.empty()) {
+                ssize_t written = ::send(connection.fd, connection.output.data(), connection.output.size(), 0);
+                if (written < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+                connection.output.erase(0, static_cast<size_t>(written));
+            }
+            return true;
+        }
+
+        // 处理一行完整的输入：第一行是玩家名称，之后的每一行交给所在的牌桌
+        void handleLine(int id, Connection& connection, std::string line) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line == "quit") {
+                connection.output += "再见。\n";
+                connection.closing = true;
+                return;
+            }
+            if (connection.table) {
+                connection.table->deliver(id, line);
+                return;
+            }
+            std::string name = line.substr(0, Snapshot::nameLength(line));
+            if (name.empty()) name = "玩家" + std::to_string(id);
+            for (auto& table : tables) {
+                if (table->join(id, name)) {
+                    connection.table = table.get();
+                    connection.output += name + "，欢迎！已加入牌桌 " + std::to_string(table->number()) + "，下一局开始时入座。\n";
+                    return;
                 }
             }
+            connection.output += "所有牌桌都已坐满，请稍后再来。\n";
+            connection.closing = true;
         }
 
-        // 显示玩家手牌
-        for (const auto& player : players) {
-            if (player.getIsInGame()) {
-                player.displayHand();
+        // 读取连接的输入，返回false表示连接已关闭或出错
+        bool receive(int id, Connection& connection) {
+            char chunk[4096];
+            while (true) {
+                ssize_t count = ::recv(connection.fd, chunk, sizeof(chunk), 0);
+                if (count == 0) return false;
+                if (count < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+                connection.input.append(chunk, static_cast<size_t>(count));
+                size_t newline;
+                while (!connection.closing && (newline = connection.input.find('\n')) != std::string::npos) {
+                    std::string line = connection.input.substr(0, newline);
+                    connection.input.erase(0, newline + 1);
+                    handleLine(id, connection, line);
+                }
+                if (connection.input.size() > MAX_LINE) return false;
             }
         }
 
-        // Pre-flop 下注轮
-        std::cout << "\n===== Pre-flop 阶段 =====" << std::endl;
-        int startPlayerIndex = getNextActivePlayerIndex(bigBlindIndex);
-        bettingRound(startPlayerIndex);
+        // 接受全部等待中的连接
+        void acceptAll() {
+            while (true) {
+                int fd = ::accept(listener, nullptr, nullptr);
+                if (fd < 0) return;
+                if (!setNonBlocking(fd)) {
+                    ::close(fd);
+                    continue;
+                }
+                Connection connection;
+                connection.fd = fd;
+                connection.output = "欢迎来到德州扑克服务器！请输入你的名字: ";
+                connections.emplace(nextConnection++, std::move(connection));
+            }
+        }
 
-        // 如果还有多个玩家，继续游戏
-        if (getActivePlayerCount() > 1) {
-            // Flop 阶段
-            dealFlop();
-            std::cout << "\n===== Flop 阶段 =====" << std::endl;
-            bettingRound(bigBlindIndex);
+    public:
+        explicit Server(const Options& serverOptions) : options(serverOptions) {}
 
-            if (getActivePlayerCount() > 1) {
-                // Turn 阶段
-                dealTurn();
-                std::cout << "\n===== Turn 阶段 =====" << std::endl;
-                bettingRound(bigBlindIndex);
+        ~Server() {
+            for (auto& table : tables) table->stop();
+            for (auto& entry : connections) ::close(entry.second.fd);
+            if (listener >= 0) ::close(listener);
+            if (wakePipe[0] >= 0) ::close(wakePipe[0]);
+            if (wakePipe[1] >= 0) ::close(wakePipe[1]);
+        }
 
-                if (getActivePlayerCount() > 1) {
-                    // River 阶段
-                    dealRiver();
-                    std::cout << "\n===== River 阶段 =====" << std::endl;
-                    bettingRound(bigBlindIndex);
+        // 运行服务器，直到收到 SIGINT/SIGTERM
+        // 返回值: 进程退出码
+        int run() {
+            listener = ::socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+            if (listener < 0 || ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                ::listen(listener, 128) != 0 || !setNonBlocking(listener) ||
+                ::pipe(wakePipe) != 0 || !setNonBlocking(wakePipe[0]) || !setNonBlocking(wakePipe[1])) {
+                std::cout << "无法在端口 " << options.port << " 上启动服务器: " << std::strerror(errno) << "\n";
+                return 1;
+            }
+            outbox.setWakeFd(wakePipe[1]);
+            std::signal(SIGPIPE, SIG_IGN);
+            std::signal(SIGINT, [](int) { stopRequested = 1; });
+            std::signal(SIGTERM, [](int) { stopRequested = 1; });
+            for (int t = 0; t < options.tables; t++) {
+                tables.emplace_back(new Table(t, options, outbox));
+                tables.back()->start();
+            }
+            std::cout << "服务器已在端口 " << options.port << " 上启动：" << options.tables << " 张牌桌，每桌 "
+                      << options.seats << " 个座位，每次行动限时 " << options.actionTimeout << " 秒。按 Ctrl+C 关闭。" << std::endl;
+
+            std::vector<pollfd> polled;
+            std::vector<int> ids;
+            std::vector<std::pair<int, std::string>> messages;
+            while (!stopRequested) {
+                polled.assign({{listener, POLLIN, 0}, {wakePipe[0], POLLIN, 0}});
+                ids.clear();
+                for (auto& entry : connections) {
+                    short events = static_cast<short>((entry.second.closing ? 0 : POLLIN) | (entry.second.output.empty() ? 0 : POLLOUT));
+                    polled.push_back({entry.second.fd, events, 0});
+                    ids.push_back(entry.first);
+                }
+                if (::poll(polled.data(), polled.size(), 500) < 0 && errno != EINTR) break;
+
+                if (polled[1].revents & POLLIN) {
+                    char drain[256];
+                    while (::read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+                }
+                outbox.drain(messages);
+                for (auto& message : messages) {
+                    auto it = connections.find(message.first);
+                    if (it != connections.end()) it->second.output += message.second;
                 }
+                messages.clear();
+                for (size_t i = 0; i < ids.size(); i++) {
+                    auto it = connections.find(ids[i]);
+                    if (it == connections.end()) continue;
+                    short revents = polled[i + 2].revents;
+                    bool alive = !(revents & (POLLERR | POLLNVAL));
+                    if (alive && (revents & (POLLIN | POLLHUP))) alive = receive(it->first, it->second);
+                    if (alive) alive = flush(it->second);
+                    if (!alive || (it->second.closing && it->second.output.empty())) close(it);
+                }
+                // 新连接的欢迎文字在下一轮 poll() 时写出
+                if (polled[0].revents & POLLIN) acceptAll();
             }
+            std::cout << "正在关闭服务器……" << std::endl;
+            return 0;
         }
+    };
+#endif
+}
 
-        // 比牌阶段
-        showdown();
+// 命令行回放 - 回放记录文件并报告第一处不一致
+// 参数:
+//   paths - 记录文件路径
+//   threads - 线程数，0表示使用硬件线程数
+// 返回值: 进程退出码（全部一致为0）
+int runReplay(const std::vector<std::string>& paths, int threads) {
+    Replay::Summary summary = Replay::run(paths, threads);
+    if (!summary.opened) {
+        std::cout << "无法读取手牌记录文件。\n";
+        return 1;
+    }
+    std::cout << "回放 " << summary.hands << " 手（跳过 " << summary.skipped << " 手不完整记录），" 
+              << summary.threads << " 个线程，耗时 " << summary.seconds << " 秒（"
+              << static_cast<long long>(summary.hands / std::max(summary.seconds, 1e-9)) << " 手/秒）\n";
+    if (!summary.first.found) {
+        std::cout << "全部一致。" << std::endl;
+        return 0;
+    }
+    std::cout << "第一处不一致: " << paths[summary.first.shard] << " 第 " << summary.first.index 
+              << " 条记录（手牌序号 " << summary.first.handId << "）的" << summary.first.field << std::endl;
+    return 2;
+}
 
-        // 更新庄家位置
-        dealerPosition = (dealerPosition + 1) % players.size();
-        
-        std::cout << "\n===== 本局结束 =====" << std::endl;
+// 统计校验 - 用两手结果已知的三人边池牌局检查统计是否区分了退还的下注和赢得的筹码
+// 两手牌都是座位0（1000筹码）和座位1（300筹码）翻牌前全下，座位1的AA赢得主池：
+//   第一手座位2弃牌，座位0的72o没有人跟到的700筹码原样退还，不算赢得底池，底池只有争夺的610；
+//   第二手座位2跟注，座位0的KK赢得与座位2争夺的1400边池，底池共2300
+// 返回值: 进程退出码（检查通过为0）
+int runStatsCheck() {
+    struct Case {
+        const char* cards;                  // 三个座位的底牌、三张烧牌、五张公共牌
+        HandHistory::ActionKind lastAction; // 座位2面对全下时的操作
+        std::int32_t won[3];                // 每个座位从底池得到的筹码（包括退还）
+        int uncalled;                       // 退还给座位0的筹码
+    };
+    const Case cases[2] = {
+        {"7c2d AsAh 9h8h 4d6s8d Kd Qs 5c 3h Jc", HandHistory::KIND_FOLD, {700, 610, 0}, 700},
+        {"KcKh AsAh 9c8c 4d6s8d 2s 5d Jh 3c Qd", HandHistory::KIND_CALL, {1400, 900, 0}, 0}
+    };
+
+    Replay::Replayer replayer;
+    HandStats::Histogram histogram;
+    bool ok = true;
+    for (int c = 0; c < 2; c++) {
+        HandHistory::HandRecord record;
+        std::memset(&record, 0, sizeof(record));
+        std::vector<Card> cards;
+        parseCards(cases[c].cards, cards);
+        record.seatCount = 3;
+        record.smallBlind = 5;
+        record.bigBlind = 10;
+        const int chips[3] = {1000, 300, 1000};
+        for (int seat = 0; seat < 3; seat++) {
+            record.startChips[seat] = chips[seat];
+            record.hole[seat][0] = static_cast<std::uint8_t>(cards[seat * 2].getIndex());
+            record.hole[seat][1] = static_cast<std::uint8_t>(cards[seat * 2 + 1].getIndex());
+        }
+        for (int i = 0; i < 3; i++) record.burn[i] = static_cast<std::uint8_t>(cards[6 + i].getIndex());
+        record.boardCount = 5;
+        for (int i = 0; i < 5; i++) record.board[i] = static_cast<std::uint8_t>(cards[9 + i].getIndex());
+        const HandHistory::ActionKind kinds[3] = {HandHistory::KIND_ALL_IN, HandHistory::KIND_ALL_IN, cases[c].lastAction};
+        for (int seat = 0; seat < 3; seat++) record.actions[seat] = {static_cast<std::uint8_t>(seat), kinds[seat], 0, 0};
+        record.actionCount = 3;
+
+        replayer.replay(record);
+        const HandHistory::HandRecord& played = replayer.last();
+        bool same = played.uncalled == cases[c].uncalled && (cases[c].uncalled == 0 || played.uncalledSeat == 0);
+        for (int seat = 0; seat < 3; seat++) same = same && played.won[seat] == cases[c].won[seat];
+        std::cout << "第 " << c + 1 << " 手: 分池 " << played.won[0] << "/" << played.won[1] << "/" << played.won[2]
+                  << "，退还 " << played.uncalled << (same ? "" : "（与预期不符）") << "\n";
+        ok = ok && same;
+        histogram.add(played);
     }
 
-    // 发三张公共牌（flop）
-    // 实现德州扑克中的翻牌阶段
-    // 包含烧牌（burn card）操作，这是正规德州扑克的标准流程
-    void dealFlop() {
-        // 弃一张牌（烧牌）
-        // 烧牌是为了防止作弊，增加游戏公平性
-        deck.dealCard();
-        
-        // 发三张翻牌，这是德州扑克中第一个重要的牌局阶段
-        for (int i = 0; i < 3; i++) {
-            communityCards.push_back(deck.dealCard());
+    auto index = [](const char* text) {
+        std::vector<Card> hole;
+        parseCards(text, hole);
+        return Preflop::classIndex(hole[0], hole[1]);
+    };
+    int trash = index("7c2d"), kings = index("KcKh"), aces = index("AsAh"), suited = index("9c8c");
+    bool counts = histogram.potChips == 610 + 2300 && histogram.pots[5] == 1 && histogram.pots[7] == 1 &&
+                  histogram.classWon[aces] == 2 && histogram.classShowdownWins[aces] == 2 &&
+                  histogram.classWon[trash] == 0 && histogram.classShowdowns[trash] == 1 && histogram.classShowdownWins[trash] == 0 &&
+                  histogram.classWon[kings] == 1 && histogram.classShowdownWins[kings] == 1 &&
+                  histogram.classDealt[suited] == 2 && histogram.classWon[suited] == 0 && histogram.classShowdowns[suited] == 1;
+    std::cout << "底池总额: " << histogram.potChips << "，AA 赢得 " << histogram.classWon[aces] 
+              << " 次，72o 赢得 " << histogram.classWon[trash] << " 次，KK 赢得 " << histogram.classWon[kings] << " 次"
+              << (counts ? "" : "（与预期不符）") << "\n";
+    ok = ok && counts;
+    std::cout << (ok ? "校验通过" : "校验失败") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// 命令行求解 - 在抽象博弈树上运行若干次 CFR 迭代，并输出翻牌前前两个决策点的平均策略
+// 参数:
+//   iterations - 本次运行的迭代数
+//   checkpointPath - 检查点文件路径，已存在时从中继续，为空时只使用内存
+//   threads - 线程数，0表示使用硬件线程数
+//   seed - 新建检查点时使用的随机数种子
+// 返回值: 进程退出码
+int runSolve(long long iterations, const std::string& checkpointPath, int threads, std::uint64_t seed) {
+    Solver::GameTree tree;
+    Solver::Arena arena(checkpointPath, tree.slots(), tree.hash(), seed);
+    if (!arena.isOpen()) {
+        std::cout << "无法使用检查点文件 " << checkpointPath << ": " << arena.error() << "\n";
+        return 1;
+    }
+    std::cout << "抽象博弈树: " << tree.size() << " 个节点，" << tree.decisions() << " 个决策节点，"
+              << static_cast<long long>(tree.decisions()) * Solver::BUCKETS << " 个信息集，策略数组 "
+              << tree.slots() << " 格\n";
+    if (arena.resumed()) {
+        std::cout << "从检查点 " << checkpointPath << " 继续（已完成 " << arena.header().iterations << " 次迭代）\n";
+    } else if (!checkpointPath.empty()) {
+        std::cout << "新建检查点 " << checkpointPath << "\n";
+    }
+
+    WorkStealingPool pool(threads);
+    Solver::Trainer trainer(tree, arena);
+    auto start = std::chrono::steady_clock::now();
+    trainer.run(static_cast<std::uint64_t>(std::max(iterations, 0LL)), pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "迭代 " << iterations << " 次，" << pool.size() << " 个线程，耗时 " << seconds << " 秒（"
+              << static_cast<long long>(iterations / std::max(seconds, 1e-9)) << " 次/秒），累计 "
+              << arena.header().iterations << " 次\n";
+
+    // 输出一个决策节点各档位的平均策略
+    auto print = [&](const char* title, int index) {
+        const Solver::Node& node = tree.node(index);
+        std::cout << "\n" << title << "（档位0最弱）\n档位";
+        for (int a = 0; a < node.actionCount; a++) std::cout << "  " << Solver::actionName(node.actions[a]);
+        std::cout << "\n";
+        for (int bucket = 0; bucket < Solver::BUCKETS; bucket++) {
+            double strategy[Solver::MAX_ACTIONS];
+            trainer.averageStrategy(index, bucket, strategy);
+            char line[16];
+            std::snprintf(line, sizeof(line), "%4d", bucket);
+            std::cout << line;
+            for (int a = 0; a < node.actionCount; a++) {
+                std::snprintf(line, sizeof(line), "  %6.1f%%", strategy[a] * 100);
+                std::cout << line;
+            }
+            std::cout << "\n";
         }
-        
-        // 更新当前轮次为翻牌阶段
-        currentRound = 1;
-        // 显示公共牌，让所有玩家看到翻牌结果
-        displayCommunityCards();
+    };
+    print("小盲翻牌前", 0);
+    const Solver::Node& root = tree.node(0);
+    for (int a = 0; a < root.actionCount; a++) {
+        if (root.actions[a] == Solver::RAISE_MIN) print("大盲面对小盲最小加注", root.firstChild + a);
     }
+    std::cout.flush();
+    return 0;
+}
 
-    // 发第四张公共牌（turn）
-    // 实现德州扑克中的转牌阶段
-    void dealTurn() {
-        // 弃一张牌，保持游戏公平性
-        deck.dealCard();
-        
-        // 发转牌，游戏进入倒数第二个阶段
-        communityCards.push_back(deck.dealCard());
-        
-        // 更新当前轮次为转牌阶段
-        currentRound = 2;
-        // 显示公共牌
-        displayCommunityCards();
+// 生成翻牌前牌力表 - 对每个起手牌类别和对手人数运行蒙特卡洛胜率计算，
+// 把结果按 Preflop::detail::EQUITY 的格式输出到标准输出，用于替换源码中的数据
+// 参数: seed - 随机数种子
+// 返回值: 进程退出码
+int runGeneratePreflop(std::uint64_t seed) {
+    Equity::MonteCarloOptions options;
+    options.targetError = 0.0005;
+    options.minSamples = 100000;
+    options.seed = seed;
+    for (int opponents = 1; opponents <= Preflop::MAX_OPPONENTS; opponents++) {
+        std::cout << "            { // " << opponents << "名对手\n";
+        for (int index = 0; index < Preflop::CLASS_COUNT; index++) {
+            // 每个类别取一手代表牌：同花都用红桃，其余用红桃和方块
+            int row = index / 13, column = index % 13;
+            bool suited = row > column;
+            CardSet hole;
+            hole.add(Card(Suit::HEARTS, static_cast<Rank>(row + 2)));
+            hole.add(Card(suited ? Suit::HEARTS : Suit::DIAMONDS, static_cast<Rank>(column + 2)));
+            options.seed = seed + opponents * 1000 + index;
+            Equity::EquityResult result = Equity::monteCarlo(hole, CardSet(), opponents, options);
+            int value = static_cast<int>(std::lround(result.equity * 10000));
+            if (column == 0) std::cout << "               ";
+            std::cout << " " << value << ",";
+            if (column == 12) std::cout << "\n";
+        }
+        std::cout << "            },\n";
+        std::cerr << "已完成 " << opponents << "/" << Preflop::MAX_OPPONENTS << " 名对手\n";
     }
+    std::cout.flush();
+    return 0;
+}
 
-    // 发第五张公共牌（river）
-    // 实现德州扑克中的河牌阶段，这是最后一张公共牌
-    void dealRiver() {
-        // 弃一张牌，保持游戏公平性
-        deck.dealCard();
-        
-        // 发河牌，游戏进入最终阶段
-        communityCards.push_back(deck.dealCard());
-        
-        // 更新当前轮次为河牌阶段
-        currentRound = 3;
-        // 显示公共牌
-        displayCommunityCards();
+// 命令行胜率查询 - 输出给定手牌和公共牌面对若干随机对手的胜率
+// 指定 exact 时改为精确枚举：对手为 villainTexts 给出的已知手牌，没有给出时为一个未知对手
+// 参数:
+//   holeText - 手牌文本，例如 "AhKh"
+//   boardText - 公共牌文本，可以为空
+//   opponents - 对手人数（仅蒙特卡洛模式）
+//   villainTexts - 已知的对手手牌文本（仅精确模式）
+//   exact - 是否精确枚举
+//   seed - 随机数种子，0表示使用真随机数
+// 返回值: 进程退出码
+int runEquity(const std::string& holeText, const std::string& boardText, int opponents,
+              const std::vector<std::string>& villainTexts, bool exact, std::uint64_t seed) {
+    std::vector<Card> hole, board;
+    std::vector<std::vector<Card>> villains(villainTexts.size());
+    bool parsed = parseCards(holeText, hole) && parseCards(boardText, board);
+    for (size_t i = 0; i < villainTexts.size(); i++) {
+        parsed = parsed && parseCards(villainTexts[i], villains[i]);
+    }
+    if (!parsed) {
+        std::cout << "无法识别的牌，请使用如 AhKd 的格式。\n";
+        return 1;
     }
+    auto start = std::chrono::steady_clock::now();
+    Equity::EquityResult result;
+    if (exact) {
+        result = Equity::exact(hole, board, villains, villains.empty());
+    } else {
+        Equity::MonteCarloOptions options;
+        options.seed = seed;
+        result = Equity::monteCarlo(hole, board, opponents, options);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (result.samples == 0) {
+        std::cout << "输入无效：需要2张手牌、不超过5张公共牌、不重复的牌和1-21名对手。\n";
+        return 1;
+    }
+    std::cout << "胜: " << result.win * 100 << "%  平: " << result.tie * 100 
+              << "%  负: " << result.loss * 100 << "%\n"
+              << "期望: " << result.equity * 100 << "% ± " << result.stdError * 100 << "%\n"
+              << "样本: " << result.samples << "，耗时 " << seconds << " 秒" << std::endl;
+    if (!exact && board.empty()) {
+        std::cout << "翻牌前查表（" << Preflop::className(Preflop::classIndex(hole[0], hole[1])) << "）: " 
+                  << Preflop::equity(hole[0], hole[1], opponents) * 100 << "%" << std::endl;
+    }
+    return 0;
+}
 
-    // 显示公共牌
-    // 格式化输出当前的所有公共牌，方便玩家查看当前可用的公共牌
-    void displayCommunityCards() const {
-        std::cout << "公共牌: ";
-        for (const auto& card : communityCards) {
-            std::cout << card.toString() << " ";
+// 命令行范围胜率 - 输出己方范围对对方范围的总胜率和每个起手牌类别的胜率，可选导出完整的组合胜率矩阵
+// 参数:
+//   heroText - 己方范围文本（见 RangeEquity::parseRange）
+//   villainText - 对方范围文本
+//   boardText - 公共牌文本，可以为空
+//   options - 计算参数
+//   matrixPath - 矩阵的 CSV 输出文件，"-" 表示标准输出，为空时不导出
+// 返回值: 进程退出码
+int runRangeEquity(const std::string& heroText, const std::string& villainText, const std::string& boardText,
+                   const RangeEquity::Options& options, const std::string& matrixPath) {
+    std::vector<CardSet> hero, villain;
+    std::vector<Card> board;
+    if (!RangeEquity::parseRange(heroText, hero) || !RangeEquity::parseRange(villainText, villain) ||
+        !parseCards(boardText, board)) {
+        std::cout << "无法识别的范围或公共牌，范围请使用如 QQ+,AKs,AhKd 的格式。\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    RangeEquity::Matrix matrix = RangeEquity::compute(hero, villain, CardSet(board), options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (matrix.runouts == 0 || CardSet(board).size() != static_cast<int>(board.size())) {
+        std::cout << "输入无效：范围不能为空，公共牌不超过5张且不能重复。\n";
+        return 1;
+    }
+    std::cout << "己方 " << hero.size() << " 个组合，对方 " << villain.size() << " 个组合，"
+              << (matrix.exhaustive ? "枚举 " : "抽样 ") << matrix.runouts << " 个牌面，耗时 " << seconds << " 秒\n";
+    double total = matrix.totalEquity();
+    if (total < 0) {
+        std::cout << "双方范围没有不冲突的组合。\n";
+        return 1;
+    }
+    std::cout << "己方胜率: " << total * 100 << "%\n";
+
+    // 按起手牌类别汇总（按范围中出现的顺序）
+    std::vector<std::vector<size_t>> rows(Preflop::CLASS_COUNT);
+    std::vector<int> order;
+    for (size_t h = 0; h < hero.size(); h++) {
+        std::vector<Card> cards = hero[h].toCards();
+        int index = Preflop::classIndex(cards[0], cards[1]);
+        if (rows[index].empty()) order.push_back(index);
+        rows[index].push_back(h);
+    }
+    for (int index : order) {
+        double equity = matrix.rowsEquity(rows[index]);
+        char line[64];
+        if (equity < 0) {
+            std::snprintf(line, sizeof(line), "  %-4s        -  (%zu 个组合)\n", Preflop::className(index).c_str(), rows[index].size());
+        } else {
+            std::snprintf(line, sizeof(line), "  %-4s  %6.2f%%  (%zu 个组合)\n", Preflop::className(index).c_str(), equity * 100, rows[index].size());
         }
-        std::cout << std::endl;
+        std::cout << line;
     }
+    std::cout.flush();
+    if (matrixPath.empty()) return 0;
 
-    // 获取游戏状态摘要
-    // 输出当前游戏的核心信息，包括底池大小、玩家数量和各玩家状态
-    void displayGameStatus() const {
-        std::cout << "\n===== 游戏状态 =====" << std::endl;
-        std::cout << "底池: " << pot << std::endl;
-        std::cout << "玩家数量: " << players.size() << std::endl;
-        std::cout << "活跃玩家: " << getActivePlayerCount() << std::endl;
-        
-        std::cout << "\n玩家状态:" << std::endl;
-        for (const auto& player : players) {
-            std::cout << player.getName() << " - 筹码: " << player.getChips();
-            if (player.getIsSmallBlind()) std::cout << " [小盲注]";
-            if (player.getIsBigBlind()) std::cout << " [大盲注]";
-            if (player.getHasFolded()) std::cout << " [已弃牌]";
-            std::cout << std::endl;
+    // 组合胜率矩阵：第一行为对方的组合，之后每行为己方一个组合对每个对方组合的胜率，冲突的组合对留空
+    std::string csv = "hero";
+    for (CardSet combo : villain) csv += "," + RangeEquity::comboText(combo);
+    csv += "\n";
+    for (size_t h = 0; h < hero.size(); h++) {
+        csv += RangeEquity::comboText(hero[h]);
+        for (size_t v = 0; v < villain.size(); v++) {
+            csv += ',';
+            double equity = matrix.equity(h, v);
+            if (equity < 0) continue;
+            char cell[16];
+            std::snprintf(cell, sizeof(cell), "%.4f", equity);
+            csv += cell;
         }
+        csv += "\n";
     }
-};
+    if (matrixPath == "-") {
+        std::cout << csv;
+        std::cout.flush();
+        return 0;
+    }
+    FILE* file = std::fopen(matrixPath.c_str(), "wb");
+    if (!file) {
+        std::cout << "无法写入矩阵文件: " << matrixPath << "\n";
+        return 1;
+    }
+    std::fwrite(csv.data(), 1, csv.size(), file);
+    std::fclose(file);
+    return 0;
+}
 
-// 主函数 - 程序入口点
-// 负责初始化游戏环境、获取用户输入、创建游戏实例并启动游戏
-int main() {
-    // 搜了下，这玩意支持中文输出。
-    // 但是为什么我不直接设计UI？
-    #ifdef _WIN32
-    SetConsoleOutputCP(65001); // 设置控制台输出为UTF-8编码
-    SetConsoleCP(65001);       // 设置控制台输入为UTF-8编码
-    #endif
+// 导出性能计数快照（JSON）
+// 参数:
+//   path - 输出文件，"-" 表示标准输出
+//   exitCode - 原本的进程退出码
+// 返回值: 导出成功时返回 exitCode，无法写入文件时返回1
+int writeMetrics(const std::string& path, int exitCode) {
+    std::string json = Instrumentation::snapshot().toJson();
+    if (path == "-") {
+        std::cout << json;
+        std::cout.flush();
+        return exitCode;
+    }
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "无法写入性能计数文件: " << path << "\n";
+        return 1;
+    }
+    std::fwrite(json.data(), 1, json.size(), file);
+    std::fclose(file);
+    return exitCode;
+}
+
+// 交互式牌局 - 显示规则、读入玩家数量，然后一局接一局地进行，直到玩家选择不再继续或输入结束
+// 所有提示和牌局文字都写入同一个控制台渲染器，只在等待输入前写出
+// 参数:
+//   in - 输入流（标准输入或内存中的脚本）
+//   out - 控制台渲染器
+//   seed - 洗牌的随机数种子
+// 返回值: 进程退出码
+int runInteractive(std::istream& in, ConsoleRenderer& out, std::uint64_t seed) {
+    out << "========================================" << '\n';
+    out << "        欢迎来到德州扑克（赌博）游戏！          " << '\n';
+    out << "========================================" << '\n';
+    out << "规则说明：" << '\n';
+    out << "1. 游戏支持2-10名玩家参与" << '\n';
+    out << "2. 每个玩家初始筹码为20000" << '\n';
+    out << "3. 小盲注50，大盲注100" << '\n';
+    out << "4. 游戏分为Pre-flop、Flop、Turn、River四个阶段" << '\n';
+    out << "========================================\n" << '\n';
 
-    std::cout << "========================================" << std::endl;
-    std::cout << "        欢迎来到德州扑克（赌博）游戏！          " << std::endl;
-    std::cout << "========================================" << std::endl;
-    std::cout << "规则说明：" << std::endl;
-    std::cout << "1. 游戏支持2-10名玩家参与" << std::endl;
-    std::cout << "2. 每个玩家初始筹码为20000" << std::endl;
-    std::cout << "3. 小盲注50，大盲注100" << std::endl;
-    std::cout << "4. 游戏分为Pre-flop、Flop、Turn、River四个阶段" << std::endl;
-    std::cout << "========================================\n" << std::endl;
-
-    // 创建德州扑克游戏实例
-    TexasHoldem game;
+    // 创建德州扑克游戏实例，操作从 in 读入，文字写到 out
+    TexasHoldem game(seed);
+    ConsoleAgent agent(in, out);
+    ConsoleEventSink sink(out);
+    game.setDefaultAgent(&agent);
+    game.setEventSink(&sink);
     int playerCount;
-    
+
     // 获取并验证玩家数量
     // 使用无限循环确保获取有效的玩家数量输入
     while (true) {
-        std::cout << "请输入玩家数量（2-22）: ";
-        std::cin >> playerCount;
-        
+        out << "请输入玩家数量（2-22）: ";
+        out.flush();
+        in >> playerCount;
+
         // 输入验证：检查是否为有效数字且在范围内
-        if (std::cin.fail() || playerCount < 2 || playerCount > 22) {
-            std::cin.clear();  // 清除错误状态
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // 清空输入缓冲区
-            std::cout << "无效的玩家数量，请输入2-22之间的数字。\n" << std::endl;
+        if (in.fail() || playerCount < 2 || playerCount > 22) {
+            if (in.eof()) {
+                out.flush();
+                return 0;  // 输入已结束，没有可以开始的牌局
+            }
+            in.clear();  // 清除错误状态
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // 清空输入缓冲区
+            out << "无效的玩家数量，请输入2-22之间的数字。\n" << '\n';
         } else {
-            std::cin.ignore(); // 清除输入缓冲区的换行符，避免影响后续的getline操作
+            in.ignore(); // 清除输入缓冲区的换行符，避免影响后续的getline操作
             break;  // 获取到有效输入，退出循环
         }
     }
-    
+
     // 简单添加玩家到游戏中，不使用循环和名称输入
     for (int i = 1; i <= playerCount; i++) {
         // 直接创建玩家对象并添加到游戏中，使用默认名称
         game.addPlayer(Player("玩家" + std::to_string(i)));
     }
-    
+
     // 提示玩家添加完成，准备开始游戏
-    std::cout << "\n欢乐时光要开始了...\n" << std::endl;
-    
+    out << "\n欢乐时光要开始了...\n" << '\n';
+
     // 游戏主循环：允许玩家进行多局游戏
     char continuePlaying = 'y';
     while (continuePlaying == 'y' || continuePlaying == 'Y') {
         // 启动一局完整的德州扑克游戏
         game.startGame();
-        
-        // 询问玩家是否继续下一局游戏
-        std::cout << "\n开始下一局游戏？(y/n): ";
-        std::cin >> continuePlaying;
-        std::cin.ignore(); // 清除输入缓冲区的换行符
+
+        // 询问玩家是否继续下一局游戏，输入结束时不再开始新的一局
+        out << "\n开始下一局游戏？(y/n): ";
+        out.flush();
+        if (!(in >> continuePlaying)) break;
+        in.ignore(); // 清除输入缓冲区的换行符
     }
-    
-    std::cout << "        结束咯            " << std::endl;
 
+    out << "        结束咯            " << '\n';
+    out.flush();
     return 0;
+}
+
+// 批量脚本 - 对目录中的每个输入脚本（*.txt）各开一局新的交互式牌局，输入来自内存中的脚本，输出写入内存，
+// 再与同名的标准输出文件（*.golden）比较。每个脚本使用同一个种子，脚本之间互不依赖，交给线程池并行运行
+// 参数:
+//   directory - 脚本目录
+//   seed - 随机数种子（标准输出文件也按这个种子生成）
+//   threads - 线程数，0表示使用硬件线程数
+//   update - 为true时不比较，改为把输出写成标准输出文件
+// 返回值: 进程退出码（全部一致为0，有不一致或缺少标准输出文件为2，无法读取目录或写入文件为1）
+int runScripts(const std::string& directory, std::uint64_t seed, int threads, bool update) {
+    // 整个文件读入字符串，失败时返回false
+    auto readFile = [](const std::filesystem::path& path, std::string& text) {
+        FILE* file = std::fopen(path.string().c_str(), "rb");
+        if (!file) return false;
+        char chunk[1 << 14];
+        size_t count;
+        text.clear();
+        while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) text.append(chunk, count);
+        std::fclose(file);
+        return true;
+    };
+
+    struct Scenario {
+        std::filesystem::path script;   // 脚本路径
+        std::filesystem::path golden;   // 标准输出文件路径
+        std::string input;              // 脚本内容
+        std::string expected;           // 标准输出文件内容
+        bool hasGolden = false;         // 标准输出文件是否存在
+        std::string output;             // 本次运行的输出
+    };
+    std::vector<Scenario> scenarios;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (!it->is_regular_file() || it->path().extension() != ".txt") continue;
+        Scenario scenario;
+        scenario.script = it->path();
+        scenario.golden = it->path();
+        scenario.golden.replace_extension(".golden");
+        if (!readFile(scenario.script, scenario.input)) continue;
+        scenario.hasGolden = !update && readFile(scenario.golden, scenario.expected);
+        scenarios.push_back(std::move(scenario));
+    }
+    if (error) {
+        std::cout << "无法读取脚本目录: " << directory << "\n";
+        return 1;
+    }
+    std::sort(scenarios.begin(), scenarios.end(), [](const Scenario& a, const Scenario& b) { return a.script < b.script; });
+
+    auto start = std::chrono::steady_clock::now();
+    WorkStealingPool pool(threads);
+    pool.run(scenarios.size(), [&](size_t index) {
+        Scenario& scenario = scenarios[index];
+        std::istringstream in(scenario.input);
+        std::ostringstream captured;
+        {
+            ConsoleRenderer renderer(captured);
+            runInteractive(in, renderer, seed);
+        }
+        scenario.output = captured.str();
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int passed = 0, failed = 0;
+    for (const Scenario& scenario : scenarios) {
+        std::string name = scenario.script.filename().string();
+        if (update) {
+            FILE* file = std::fopen(scenario.golden.string().c_str(), "wb");
+            if (!file) {
+                std::cout << "无法写入标准输出文件: " << scenario.golden.string() << "\n";
+                return 1;
+            }
+            std::fwrite(scenario.output.data(), 1, scenario.output.size(), file);
+            std::fclose(file);
+            std::cout << "  " << name << "  已更新\n";
+            continue;
+        }
+        if (!scenario.hasGolden) {
+            std::cout << "  " << name << "  缺少标准输出文件 " << scenario.golden.filename().string() << "\n";
+            failed++;
+        } else if (scenario.output != scenario.expected) {
+            // 第一处不同所在的行号
+            size_t at = std::mismatch(scenario.output.begin(), scenario.output.end(),
+                                      scenario.expected.begin(), scenario.expected.end()).first - scenario.output.begin();
+            long long line = 1 + std::count(scenario.output.begin(), scenario.output.begin() + at, '\n');
+            std::cout << "  " << name << "  不一致（从第 " << line << " 行开始）\n";
+            failed++;
+        } else {
+            passed++;
+        }
+    }
+    std::cout << "脚本 " << scenarios.size() << " 个，" << pool.size() << " 个线程，耗时 " << seconds << " 秒";
+    if (update) {
+        std::cout << "，已写出标准输出文件。" << std::endl;
+        return 0;
+    }
+    std::cout << "，一致 " << passed << " 个，失败 " << failed << " 个。" << std::endl;
+    return failed == 0 ? 0 : 2;
+}
+
+// 牌桌服务器 - 监听端口并运行全部牌桌，直到收到 Ctrl+C（SIGINT）或 SIGTERM
+// 参数: options - 服务器参数
+// 返回值: 进程退出码
+int runServe(const TableServer::Options& options) {
+#ifdef _WIN32
+    (void)options;
+    std::cout << "服务器模式目前只支持 POSIX 平台。\n";
+    return 1;
+#else
+    TableServer::Server server(options);
+    return server.run();
+#endif
+}
+
+// 主函数 - 程序入口点
+// 解析命令行参数，运行对应的模式；没有给出模式时开始交互式牌局
+int main(int argc, char* argv[]) {
+    // 搜了下，这玩意支持中文输出。
+    // 但是为什么我不直接设计UI？
+    #ifdef _WIN32
+    SetConsoleOutputCP(65001); // 设置控制台输出为UTF-8编码
+    SetConsoleCP(65001);       // 设置控制台输入为UTF-8编码
+    #endif
+
+    // 命令行参数：
+    //   --certify          对查表评估器做全量校验
+    //   --certify-deck [n] 校验懒洗牌与完整洗牌发出的牌一致（默认1000个种子）
+    //   --certify-stats    用结果已知的边池牌局校验手牌统计（退还的下注不算赢得底池）
+    //   --seed <n>         以固定种子洗牌，便于复现牌局
+    //   --selfplay <n>     无输出地自我对局n手并统计速度
+    //   --players <n>      自我对局的玩家数量（默认6）
+    //   --log <文件>       自我对局时把每手牌写入二进制手牌记录
+    //   --scan <文件>      扫描手牌记录文件并输出统计
+    //   --replay <文件>    回放手牌记录并检查结果，可多次给出多个分片
+    //   --equity <手牌>    计算胜率，例如 --equity AhKh --board Qh7d2c --opponents 2
+    //   --exact            精确枚举胜率，可用 --vs <手牌> 多次给出已知的对手手牌
+    //   --range <范围>     计算范围对范围的胜率，例如 --range QQ+,AKs --against all --board Qh7d2c，
+    //                      可用 --samples n 指定翻牌前的抽样牌面数（最多 2^30），--matrix <文件> 导出组合胜率矩阵（CSV，"-" 表示标准输出）
+    //   --gen-preflop      重新生成翻牌前牌力表（输出源码到标准输出）
+    //   --bench [--reps n] 运行性能测试套件，每项重复测量n次（默认15）
+    //   --tournament       运行多桌锦标赛，可用 --tables n、--seats n 调整
+    //   --threads <n>      锦标赛、回放、范围胜率和求解使用的线程数（默认使用硬件线程数）
+    //   --alloc-check [n]  检查n局牌（默认10000）是否发生堆内存分配，可用 --players 指定人数
+    //                      （需要以 -DHOLDEM_ALLOC_CHECK=1 编译）
+    //   --metrics <文件>   结束时把性能计数快照以 JSON 写入文件（"-" 表示标准输出）
+    //   --scripts <目录>   在进程内并行运行目录中的每个输入脚本（*.txt），输出与同名的 *.golden 比较，
+    //                      加 --update-golden 时改为写出 *.golden（种子默认为1，可用 --seed 指定）
+    //   --bots <阵容>      自我对局和锦标赛使用的机器人：tight、loose、random、equity 或 mix（默认随机代理）
+    //   --serve <端口>     运行牌桌服务器，远程玩家用 TCP 连接（例如 nc localhost 7777），
+    //                      可用 --tables n、--seats n、--action-timeout <秒> 调整
+    //   --solve <n>        在抽象博弈树上运行n次 CFR 迭代，可用 --checkpoint <文件> 保存并继续求解
+    //   --stats <文件>     自我对局和锦标赛时统计每一手牌（起手牌胜率、比牌频率、底池分布、牌型分布），
+    //                      输出摘要并写出列式统计文件
+    //   --aggregate <文件> 统计手牌记录文件，可多次给出多个分片，加 --stats 时同时写出列式统计文件
+    bool seeded = false;
+    std::uint64_t seed = 0;
+    long long selfPlayHands = 0;
+    int selfPlayPlayers = 6;
+    std::string logPath, scanPath, statsPath;
+    std::vector<std::string> replayPaths, aggregatePaths;
+    int threads = 0;
+    std::string equityHole, equityBoard;
+    int opponents = 1;
+    std::vector<std::string> villains;
+    bool exact = false;
+    bool bench = false;
+    bool generatePreflop = false;
+    int repetitions = 15;
+    bool tournament = false;
+    Tournament::Options tournamentOptions;
+    long long allocationCheckHands = 0;
+    std::string metricsPath;
+    std::string lineup;
+    std::string heroRange, villainRange = "all", matrixPath;
+    RangeEquity::Options rangeOptions;
+    std::string scriptDirectory;
+    bool updateGolden = false;
+    TableServer::Options serverOptions;
+    bool serve = false;
+    long long solveIterations = 0;
+    std::string checkpointPath;
+    // 整数参数无法解析时输出提示，返回进程退出码
+    auto invalidArgument = [](const std::string& option, const char* value) {
+        std::cout << "无效的参数: " << option << " " << value << "\n";
+        return 1;
+    };
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--certify") {
+            return HandEvaluator::certify();
+        } else if (arg == "--certify-stats") {
+            return runStatsCheck();
+        } else if (arg == "--certify-deck") {
+            int seeds = 1000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                if (!parseNumber(argv[++i], seeds)) return invalidArgument(arg, argv[i]);
+            }
+            return Deck::certifyLazyShuffle(seeds);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], seed)) return invalidArgument(arg, argv[i]);
+            seeded = true;
+        } else if (arg == "--selfplay" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], selfPlayHands)) return invalidArgument(arg, argv[i]);
+        } else if (arg == "--players" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], selfPlayPlayers)) return invalidArgument(arg, argv[i]);
+            selfPlayPlayers = std::min(std::max(selfPlayPlayers, 2), 22);
+        } else if (arg == "--equity" && i + 1 < argc) {
+            equityHole = argv[++i];
+        } else if (arg == "--board" && i + 1 < argc) {
+            equityBoard = argv[++i];
+        } else if (arg == "--opponents" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], opponents)) return invalidArgument(arg, argv[i]);
+        } else if (arg == "--vs" && i + 1 < argc) {
+            villains.push_back(argv[++i]);
+        } else if (arg == "--range" && i + 1 < argc) {
+            heroRange = argv[++i];
+        } else if (arg == "--against" && i + 1 < argc) {
+            villainRange = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], rangeOptions.samples)) return invalidArgument(arg, argv[i]);
+            rangeOptions.samples = std::min(std::max(rangeOptions.samples, 1LL), RangeEquity::MAX_SAMPLES);
+        } else if (arg == "--matrix" && i + 1 < argc) {
+            matrixPath = argv[++i];
+        } else if (arg == "--exact") {
+            exact = true;
+        } else if (arg == "--gen-preflop") {
+            generatePreflop = true;
+        } else if (arg == "--bench") {
+            bench = true;
+        } else if (arg == "--reps" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], repetitions)) return invalidArgument(arg, argv[i]);
+            repetitions = std::max(repetitions, 1);
+        } else if (arg == "--log" && i + 1 < argc) {
+            logPath = argv[++i];
+        } else if (arg == "--scan" && i + 1 < argc) {
+            scanPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPaths.push_back(argv[++i]);
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsPath = argv[++i];
+        } else if (arg == "--aggregate" && i + 1 < argc) {
+            aggregatePaths.push_back(argv[++i]);
+        } else if (arg == "--tournament") {
+            tournament = true;
+        } else if (arg == "--tables" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], serverOptions.tables)) return invalidArgument(arg, argv[i]);
+            tournamentOptions.tables = serverOptions.tables;
+        } else if (arg == "--seats" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], serverOptions.seats)) return invalidArgument(arg, argv[i]);
+            tournamentOptions.seatsPerTable = serverOptions.seats;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve = true;
+            if (!parseNumber(argv[++i], serverOptions.port)) return invalidArgument(arg, argv[i]);
+        } else if (arg == "--action-timeout" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], serverOptions.actionTimeout)) return invalidArgument(arg, argv[i]);
+            serverOptions.actionTimeout = std::max(serverOptions.actionTimeout, 1);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], threads)) return invalidArgument(arg, argv[i]);
+            threads = std::max(threads, 0);
+        } else if (arg == "--bots" && i + 1 < argc) {
+            lineup = argv[++i];
+            if (!Bots::isValidLineup(lineup)) {
+                std::cout << "未知的机器人阵容: " << lineup << "（可用 tight、loose、random、equity、mix）\n";
+                return 1;
+            }
+        } else if (arg == "--scripts" && i + 1 < argc) {
+            scriptDirectory = argv[++i];
+        } else if (arg == "--update-golden") {
+            updateGolden = true;
+        } else if (arg == "--solve" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], solveIterations)) return invalidArgument(arg, argv[i]);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "--alloc-check") {
+            allocationCheckHands = 10000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                if (!parseNumber(argv[++i], allocationCheckHands)) return invalidArgument(arg, argv[i]);
+            }
+        }
+    }
+    auto finish = [&metricsPath](int exitCode) {
+        return metricsPath.empty() ? exitCode : writeMetrics(metricsPath, exitCode);
+    };
+    if (allocationCheckHands > 0) {
+        return finish(runAllocationCheck(allocationCheckHands, selfPlayPlayers, seeded ? seed : 1));
+    }
+    if (!scanPath.empty()) {
+        return finish(runScan(scanPath));
+    }
+    if (!replayPaths.empty()) {
+        return finish(runReplay(replayPaths, threads));
+    }
+    if (!aggregatePaths.empty()) {
+        return finish(runAggregate(aggregatePaths, statsPath, threads));
+    }
+    if (generatePreflop) {
+        return finish(runGeneratePreflop(seeded ? seed : 20240601));
+    }
+    if (serve) {
+        serverOptions.tables = std::max(serverOptions.tables, 1);
+        serverOptions.seats = std::min(std::max(serverOptions.seats, 2), 22);
+        serverOptions.seed = seeded ? seed : 0;
+        return finish(runServe(serverOptions));
+    }
+    if (!scriptDirectory.empty()) {
+        return finish(runScripts(scriptDirectory, seeded ? seed : 1, threads, updateGolden));
+    }
+    if (solveIterations > 0) {
+        return finish(runSolve(solveIterations, checkpointPath, threads, seeded ? seed : 1));
+    }
+    if (bench) {
+        return finish(BenchmarkSuite::run(repetitions));
+    }
+    if (tournament) {
+        tournamentOptions.seed = seeded ? seed : 0;
+        tournamentOptions.threads = threads;
+        tournamentOptions.bots = lineup;
+        tournamentOptions.stats = !statsPath.empty();
+        return finish(runTournament(tournamentOptions, statsPath));
+    }
+    if (!heroRange.empty()) {
+        rangeOptions.threads = threads;
+        rangeOptions.seed = seeded ? seed : 0;
+        return finish(runRangeEquity(heroRange, villainRange, equityBoard, rangeOptions, matrixPath));
+    }
+    if (!equityHole.empty()) {
+        return finish(runEquity(equityHole, equityBoard, opponents, villains, exact, seeded ? seed : 0));
+    }
+    if (selfPlayHands > 0) {
+        return finish(runSelfPlay(selfPlayHands, selfPlayPlayers, seeded ? seed : Xoshiro256::randomSeed(), logPath, lineup, statsPath));
+    }
+
+    return finish(runInteractive(std::cin, ConsoleRenderer::standard(), seeded ? seed : Xoshiro256::randomSeed()));
 }
\ No newline at end of file